@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "boost/asio/ip/udp.hpp"
@@ -58,6 +59,13 @@ typedef std::function<void(const std::string& /*message*/, bool /*cache_lookup*/
 typedef std::function<void(asymm::PublicKey /*public_key*/)> GivePublicKeyFunctor;
 typedef std::function<void(NodeId /*node Id*/, GivePublicKeyFunctor)> RequestPublicKeyFunctor;
 
+// Batch variant of the above.  Nodes for which no key is available should be omitted from the
+// vector passed to GivePublicKeysFunctor.
+typedef std::function<void(std::vector<std::pair<NodeId, asymm::PublicKey>> /*public_keys*/)>
+    GivePublicKeysFunctor;
+typedef std::function<void(std::vector<NodeId> /*node Ids*/, GivePublicKeysFunctor)>
+    RequestPublicKeysFunctor;
+
 typedef std::function<bool(std::string& /*data*/)> HaveCacheDataFunctor;
 typedef std::function<void(const std::string& /*data*/)> StoreCacheDataFunctor;
 
@@ -120,6 +128,7 @@ struct Functors {
         matrix_changed(),
         set_public_key(),
         request_public_key(),
+        request_public_keys(),
         new_bootstrap_endpoint() {}
 
   MessageAndCachingFunctors message_and_caching;
@@ -129,6 +138,8 @@ struct Functors {
   MatrixChangedFunctor matrix_changed;
   GivePublicKeyFunctor set_public_key;
   RequestPublicKeyFunctor request_public_key;
+  // Optional.  If provided, used to resolve keys of several peers at once while joining.
+  RequestPublicKeysFunctor request_public_keys;
   NewBootstrapEndpointFunctor new_bootstrap_endpoint;
 };
 
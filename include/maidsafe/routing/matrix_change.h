@@ -39,6 +39,7 @@ namespace test {
 class MatrixChangeTest_BEH_CheckHolders_Test;
 class SingleMatrixChangeTest_BEH_ChoosePmidNode_Test;
 class GroupMatrixTest_BEH_EmptyMatrix_Test;
+class GroupMatrixBenchmark;
 }
 
 enum class GroupRangeStatus {
@@ -72,6 +73,7 @@ class MatrixChange {
   friend class test::MatrixChangeTest_BEH_CheckHolders_Test;
   friend class test::SingleMatrixChangeTest_BEH_ChoosePmidNode_Test;
   friend class test::GroupMatrixTest_BEH_EmptyMatrix_Test;
+  friend class test::GroupMatrixBenchmark;
 
  private:
   MatrixChange(NodeId this_node_id, const std::vector<NodeId>& old_matrix,
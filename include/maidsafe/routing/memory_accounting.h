@@ -0,0 +1,129 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_MEMORY_ACCOUNTING_H_
+#define MAIDSAFE_ROUTING_MEMORY_ACCOUNTING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+enum class MemorySubsystem : int {
+  kRoutingTable = 0,
+  kGroupMatrix,
+  kClientRoutingTable,
+  kTimerTasks,
+  kQueuedHandlers,
+  kUnvalidatedMatrixUpdates,
+  kCount
+};
+
+namespace detail {
+
+class MemoryAccount {
+ public:
+  MemoryAccount() : current_(0), peak_(0) {}
+  void Add(size_t bytes) {
+    uint64_t current(current_ += bytes), peak(peak_);
+    while (current > peak && !peak_.compare_exchange_weak(peak, current)) {
+    }
+  }
+  void Subtract(size_t bytes) { current_ -= bytes; }
+  uint64_t current() const { return current_; }
+  uint64_t peak() const { return peak_; }
+
+ private:
+  MemoryAccount(const MemoryAccount&);
+  MemoryAccount(const MemoryAccount&&);
+  MemoryAccount& operator=(const MemoryAccount&);
+
+  std::atomic<uint64_t> current_, peak_;
+};
+
+MemoryAccount& GetMemoryAccount(MemorySubsystem subsystem);
+
+}  // namespace detail
+
+// Allocator which charges the memory it allocates to 'Subsystem'.
+template <typename T, MemorySubsystem Subsystem>
+class CountingAllocator : public std::allocator<T> {
+ public:
+  template <typename U>
+  struct rebind {
+    typedef CountingAllocator<U, Subsystem> other;
+  };
+
+  CountingAllocator() : std::allocator<T>() {}
+  CountingAllocator(const CountingAllocator& other) : std::allocator<T>(other) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U, Subsystem>& other)  // NOLINT (implicit)
+      : std::allocator<T>(other) {}
+
+  T* allocate(size_t count, const void* /*hint*/ = nullptr) {
+    T* memory(std::allocator<T>::allocate(count));
+    detail::GetMemoryAccount(Subsystem).Add(count * sizeof(T));
+    return memory;
+  }
+
+  void deallocate(T* memory, size_t count) {
+    detail::GetMemoryAccount(Subsystem).Subtract(count * sizeof(T));
+    std::allocator<T>::deallocate(memory, count);
+  }
+};
+
+// Charges an estimate of a container's footprint to a subsystem, for containers whose elements own
+// further heap memory which an allocator wouldn't see.  Each Update replaces the previous estimate
+// and the destructor releases it.  Callers must serialise calls to Update.
+class MemoryCharge {
+ public:
+  explicit MemoryCharge(MemorySubsystem subsystem);
+  ~MemoryCharge();
+  void Update(size_t bytes);
+
+ private:
+  MemoryCharge(const MemoryCharge&);
+  MemoryCharge(const MemoryCharge&&);
+  MemoryCharge& operator=(const MemoryCharge&);
+
+  detail::MemoryAccount& account_;
+  size_t bytes_;
+};
+
+// Estimated bytes held by 'nodes', including unused capacity and the elements' dimension lists.
+// The public keys' internal buffers are not included.
+size_t MemoryUsage(const std::vector<NodeInfo>& nodes);
+
+// Returns the current and peak bytes of each subsystem, keyed by name.  The counts are for the
+// whole process, so with several nodes in one process they are totals across all of them.
+std::map<std::string, MemoryStatistics> GetMemoryStatistics();
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MEMORY_ACCOUNTING_H_
@@ -22,6 +22,7 @@
 #include <chrono>
 #include <cstdint>
 #include "boost/date_time/posix_time/posix_time_duration.hpp"
+#include "boost/filesystem/path.hpp"
 
 namespace maidsafe {
 
@@ -54,11 +55,45 @@ struct Parameters {
   static uint16_t split_avoidance;
   static uint16_t routing_table_ready_to_response;
   static uint16_t accepted_distance_tolerance;
+  // Approximate number of peer-reported group radii the network average distance is taken over.
+  static uint16_t network_distance_sample_window;
   static boost::posix_time::time_duration connect_rpc_prune_timeout;
   static bool append_maidsafe_endpoints;
   static bool append_maidsafe_local_endpoints;
   static bool append_local_live_port_endpoint;
+  // Read when each vault is constructed: those constructed while it's false never cache.
   static bool caching;
+  // Size in bytes of each vault's in-memory cache of responses to cacheable GETs it passed on.
+  // Zero disables the in-memory cache.
+  static uint64_t response_cache_size;
+  // Maximum number of cacheable GETs held back behind an identical request already in flight, and
+  // how long they are held before being passed on themselves.  The latter is kept well below
+  // default_response_timeout so that requesters still get their responses in time.
+  static uint16_t max_parked_cache_requests;
+  static std::chrono::steady_clock::duration parked_cache_request_timeout;
+  // Maximum number of cacheable responses queued for storing before further ones are dropped.
+  static uint16_t max_pending_cache_stores;
+  // Directory in which each vault keeps a memory-mapped cache file which survives restarts, and the
+  // size in bytes of that file.  An empty path disables the file-backed cache.
+  static boost::filesystem::path persistent_cache_directory;
+  static uint64_t persistent_cache_size;
+  // Number of validated peer public keys held, and how long each is trusted for before the upper
+  // layer must be asked for it again.
+  static uint16_t public_key_cache_size;
+  static std::chrono::seconds public_key_cache_lifetime;
+  // Peers whose smoothed send failure rate exceeds this percentage are passed over in favour of
+  // near-equally close peers when forwarding.
+  static uint16_t flaky_link_failure_percentage;
+  // Time over which a peer's failure rate halves while nothing is sent to it, so that peers passed
+  // over as flaky are eventually tried again.
+  static std::chrono::seconds link_failure_half_life;
+  // One in this many messages has its handling traced (see tracing.h).  Zero disables tracing.
+  static uint32_t message_trace_sample_rate;
+  // Directory in which each node writes a file of every message it receives, for replaying offline
+  // (see message_capture.h), and the most bytes written to each file.  An empty path disables
+  // capture.
+  static boost::filesystem::path message_capture_directory;
+  static uint64_t message_capture_size;
 
  private:
   Parameters();
@@ -0,0 +1,46 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PROBES_H_
+#define MAIDSAFE_ROUTING_PROBES_H_
+
+#include <string>
+
+namespace maidsafe {
+
+namespace routing {
+
+// When built with the CMake option ROUTING_SCOPED_PROBES, routing's heavy functions are timed and
+// the times aggregated per thread by call stack.  Otherwise the probes compile to nothing and the
+// functions below return empty results.
+
+enum class ProbeTime { kExclusive, kInclusive };
+
+// Returns one "thread-N;outer;inner <microseconds>" line per probed call stack, in the folded-stack
+// format read by flamegraph.pl and similar tools.  Flame graphs expect kExclusive times, which
+// exclude time spent in nested probes.
+std::string FoldedProbeStacks(ProbeTime probe_time = ProbeTime::kExclusive);
+
+// Zeroes all times recorded so far.
+void ResetProbes();
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PROBES_H_
@@ -0,0 +1,97 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PROFILED_MUTEX_H_
+#define MAIDSAFE_ROUTING_PROFILED_MUTEX_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace detail {
+class LockProfile;
+}
+
+#define ROUTING_LOCK_SITE_STRINGIZE_DETAIL(line) #line
+#define ROUTING_LOCK_SITE_STRINGIZE(line) ROUTING_LOCK_SITE_STRINGIZE_DETAIL(line)
+// "file:line" of the lock site.
+#define ROUTING_LOCK_SITE __FILE__ ":" ROUTING_LOCK_SITE_STRINGIZE(__LINE__)
+
+// Wraps a ProfiledMutex being locked so the hold is attributed to this call site, e.g.
+//   std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
+// Without ROUTING_LOCK_PROFILING it is just the mutex.
+#ifdef ROUTING_LOCK_PROFILING
+#define ROUTING_LOCK(mutex) (mutex).At(ROUTING_LOCK_SITE)
+#else
+#define ROUTING_LOCK(mutex) (mutex)
+#endif
+
+// Replacement for std::mutex on routing's hot paths.  When built with the CMake option
+// ROUTING_LOCK_PROFILING, the time spent waiting for and holding the lock is recorded against its
+// name; otherwise it simply forwards to std::mutex.
+class ProfiledMutex {
+ public:
+#ifdef ROUTING_LOCK_PROFILING
+  explicit ProfiledMutex(const char* name);
+  // Attributes the next lock() or try_lock() by this thread to 'call_site', which must be a string
+  // literal such as ROUTING_LOCK_SITE.  Normally used via ROUTING_LOCK.  Holds whose lock was not
+  // preceded by At(), e.g. the re-lock at the end of a condition variable wait, are reported
+  // against "unknown".
+  ProfiledMutex& At(const char* call_site);
+  void lock();
+  bool try_lock();
+  void unlock();
+#else
+  explicit ProfiledMutex(const char* /*name*/) : mutex_() {}
+  ProfiledMutex& At(const char* /*call_site*/) { return *this; }
+  void lock() { mutex_.lock(); }
+  bool try_lock() { return mutex_.try_lock(); }
+  void unlock() { mutex_.unlock(); }
+#endif
+
+ private:
+  ProfiledMutex(const ProfiledMutex&);
+  ProfiledMutex(const ProfiledMutex&&);
+  ProfiledMutex& operator=(const ProfiledMutex&);
+
+  std::mutex mutex_;
+#ifdef ROUTING_LOCK_PROFILING
+  detail::LockProfile& profile_;
+  // Only accessed by the thread holding mutex_.
+  std::chrono::steady_clock::time_point acquired_at_;
+  const char* call_site_;
+#endif
+};
+
+// Returns the statistics of every ProfiledMutex in this process, keyed by name.  Locks sharing a
+// name, e.g. the routing tables of several nodes in one process, are reported together.  Empty
+// unless built with ROUTING_LOCK_PROFILING.
+std::map<std::string, LockStatistics> GetLockStatistics();
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PROFILED_MUTEX_H_
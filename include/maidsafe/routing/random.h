@@ -0,0 +1,41 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_RANDOM_H_
+#define MAIDSAFE_ROUTING_RANDOM_H_
+
+#include <cstdint>
+
+namespace maidsafe {
+
+namespace routing {
+
+// Routing's source of the random numbers it puts in messages or chooses peers by: message and task
+// IDs, and random connected nodes.  Drawn from one process-wide engine, seeded from
+// maidsafe::RandomUint32 unless SeedRandom is called, so that a simulation may repeat exactly.
+
+uint32_t SeededRandomUint32();
+
+// Reseeds the engine.  Routing itself never calls this.
+void SeedRandom(uint32_t seed);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_RANDOM_H_
@@ -45,6 +45,7 @@
 #include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/statistics.h"
 
 namespace maidsafe {
 
@@ -54,6 +55,7 @@ struct NodeInfo;
 
 namespace test {
 class GenericNode;
+class SimulatedNetwork;
 }
 
 namespace detail {
@@ -166,7 +168,12 @@ class Routing {
   // Checks if client routing table contains given node id
   bool IsConnectedClient(const NodeId& node_id);
 
+  // Returns counts of messages handled, bytes transferred and response latencies since this object
+  // was created.
+  Statistics GetStatistics() const;
+
   friend class test::GenericNode;
+  friend class test::SimulatedNetwork;
 
  private:
   Routing(const Routing&);
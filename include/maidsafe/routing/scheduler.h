@@ -0,0 +1,100 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_SCHEDULER_H_
+#define MAIDSAFE_ROUTING_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "boost/asio/steady_timer.hpp"
+#include "boost/system/error_code.hpp"
+
+#include "maidsafe/common/asio_service.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Where routing runs its handlers and timers, and what it takes the time from and sleeps on.
+// AsioScheduler runs them on an AsioService in real time; tests may substitute a scheduler which
+// runs many nodes in one thread and in virtual time.
+class Scheduler {
+ public:
+  typedef std::function<void(const boost::system::error_code&)> WaitHandler;
+
+  // One-shot timer with the semantics of boost::asio::steady_timer: setting the expiry or
+  // cancelling invokes any pending handler with boost::asio::error::operation_aborted, and handlers
+  // are never invoked from within the call which set or cancelled them.  Destroying the alarm
+  // cancels it.
+  class Alarm {
+   public:
+    virtual ~Alarm() {}
+    virtual void ExpiresFromNow(const std::chrono::steady_clock::duration& duration) = 0;
+    virtual void AsyncWait(const WaitHandler& handler) = 0;
+    virtual void Cancel() = 0;
+  };
+
+  virtual ~Scheduler() {}
+  virtual std::chrono::steady_clock::time_point Now() const = 0;
+  // Runs 'functor' later, never from within this call.
+  virtual void Post(const std::function<void()>& functor) = 0;
+  // Runs 'functor' from within this call if that is allowed, otherwise as Post.
+  virtual void Dispatch(const std::function<void()>& functor) = 0;
+  virtual std::unique_ptr<Alarm> MakeAlarm() = 0;
+  // Blocks the calling thread while 'duration' passes, where the scheduler's time can pass while
+  // blocked, otherwise returns at once.
+  virtual void Sleep(const std::chrono::steady_clock::duration& duration) = 0;
+};
+
+// Source of the current time, e.g. a Scheduler's Now.
+typedef std::function<std::chrono::steady_clock::time_point()> NowFunctor;
+
+// Returns a NowFunctor reading std::chrono::steady_clock, for use outside of any Scheduler.
+NowFunctor SteadyClockNow();
+
+class AsioScheduler : public Scheduler {
+ public:
+  // Runs on an AsioService of its own with 'thread_count' threads.
+  explicit AsioScheduler(uint32_t thread_count);
+  // Runs on 'asio_service', which must outlive this.
+  explicit AsioScheduler(AsioService& asio_service);
+  virtual ~AsioScheduler();
+  virtual std::chrono::steady_clock::time_point Now() const;
+  virtual void Post(const std::function<void()>& functor);
+  virtual void Dispatch(const std::function<void()>& functor);
+  virtual std::unique_ptr<Alarm> MakeAlarm();
+  virtual void Sleep(const std::chrono::steady_clock::duration& duration);
+  AsioService& asio_service() { return asio_service_; }
+
+ private:
+  AsioScheduler(const AsioScheduler&);
+  AsioScheduler(const AsioScheduler&&);
+  AsioScheduler& operator=(const AsioScheduler&);
+
+  std::unique_ptr<AsioService> own_asio_service_;
+  AsioService& asio_service_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_SCHEDULER_H_
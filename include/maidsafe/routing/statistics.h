@@ -0,0 +1,144 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_STATISTICS_H_
+#define MAIDSAFE_ROUTING_STATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+// (bucket upper bound, sample count) pairs, in ascending order of bucket.
+typedef std::vector<std::pair<std::chrono::microseconds, uint64_t>> LatencyBuckets;
+// Number of messages delivered after each number of hops, indexed by hop count.
+typedef std::vector<uint64_t> HopCounts;
+
+// Contention on one named lock.  Only collected when built with ROUTING_LOCK_PROFILING.
+struct LockStatistics {
+  LockStatistics();
+  uint64_t acquisitions;
+  // Time spent waiting to acquire the lock, and holding it.
+  LatencyBuckets wait_time, hold_time;
+  // The longest holds, longest first, each with the "file:line" at which the lock was acquired
+  // through ROUTING_LOCK, or "unknown" if it wasn't.
+  std::vector<std::pair<std::chrono::microseconds, std::string>> longest_holds;
+};
+
+// How sends to one connected peer have fared.
+struct LinkStatistics {
+  LinkStatistics();
+  uint64_t send_successes, send_failures, bytes_sent;
+  // Smoothed time from handing a message to rudp until its delivery is acknowledged.
+  std::chrono::microseconds round_trip_time;
+  // Time since the last successful send, or -1ms if there has been none.
+  std::chrono::milliseconds since_last_success;
+  // Smoothed fraction of sends failing, from 0.0 to 1.0.
+  double failure_rate;
+};
+
+// Bytes held by one of routing's containers.
+struct MemoryStatistics {
+  MemoryStatistics();
+  uint64_t current_bytes, peak_bytes;
+};
+
+// Snapshot of a node's routing activity since it was created.
+struct Statistics {
+  Statistics();
+  // Messages received, keyed by message type (e.g. "Ping", "NodeLevel").
+  std::map<std::string, uint64_t> messages_by_type;
+  // Messages received, keyed by how they were handled (e.g. "FarNode", "Dropped").
+  std::map<std::string, uint64_t> messages_by_handling;
+  uint64_t bytes_received, bytes_sent;
+  // Time from sending a request to receiving each of its responses.  Only non-empty buckets are
+  // included.
+  LatencyBuckets response_latency;
+  // Number of requests for which one or more expected responses never arrived.
+  uint64_t timed_out_requests;
+  // Received messages waiting to be handled, and requests awaiting responses.
+  uint64_t receive_queue_depth, pending_requests;
+  // Keyed by hex-encoded peer ID.
+  std::map<std::string, LinkStatistics> links;
+  // Hops taken by messages delivered to this node, keyed by destination type: "Direct",
+  // "GroupLeader" for group messages this node replicated to the group, and "GroupMember" for the
+  // replicated copies.
+  std::map<std::string, HopCounts> hops_by_destination;
+  // log2 of the estimated network size, i.e. the hop count of an ideal route, or zero while the
+  // network size is unknown.
+  double ideal_hops;
+  // Mean hop count divided by ideal_hops, keyed as hops_by_destination.  Empty while ideal_hops is
+  // zero.
+  std::map<std::string, double> route_stretch;
+  // Contention on routing's hot-path locks, keyed by lock name, across all nodes in this process.
+  // Empty unless built with ROUTING_LOCK_PROFILING.
+  std::map<std::string, LockStatistics> locks;
+  // Time from the start of the most recent join to the first occurrence of each phase it has
+  // reached: "Bootstrapped", "FirstFindNodesResponse", "FirstRoutingTableAdd",
+  // "ClosestNodesReached", "ThresholdReached" and "GroupMatrixComplete".
+  std::map<std::string, std::chrono::milliseconds> join_phases;
+  // Time from sending a Connect request to adding the peer to the routing table.
+  LatencyBuckets connect_handshake;
+  // Memory held by routing's main containers, keyed by subsystem (e.g. "RoutingTable",
+  // "TimerTasks"), across all nodes in this process.
+  std::map<std::string, MemoryStatistics> memory;
+};
+
+// Returns the upper bound of the bucket holding the given percentile (0 to 100) of the samples, or
+// zero if there are none.
+std::chrono::microseconds LatencyPercentile(const LatencyBuckets& buckets, double percentile);
+
+// Returns the mean hop count, or zero if there are no samples.
+double MeanHops(const HopCounts& hop_counts);
+
+// Lock-free histogram of durations in microseconds.  As in HdrHistogram, each power of two is split
+// into 16 equal sub-buckets, giving a relative error below 1/16 over the whole range.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+  void Record(const std::chrono::steady_clock::duration& duration);
+  LatencyBuckets Buckets() const;
+
+ private:
+  static const size_t kSubBucketBits = 4;
+  static const size_t kSubBucketCount = 1 << kSubBucketBits;
+  static const size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+  LatencyHistogram(const LatencyHistogram&);
+  LatencyHistogram(const LatencyHistogram&&);
+  LatencyHistogram& operator=(const LatencyHistogram&);
+
+  static size_t BucketIndex(uint64_t microseconds);
+  static uint64_t BucketUpperBound(size_t index);
+
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_STATISTICS_H_
@@ -20,6 +20,7 @@
 #define MAIDSAFE_ROUTING_TESTS_ROUTING_NETWORK_H_
 
 #include <chrono>
+#include <functional>
 #include <future>
 #include <map>
 #include <string>
@@ -136,8 +137,15 @@ class GenericNode {
   std::string SerializeRoutingTable();
 
   static size_t next_node_id_;
+  // Nodes constructed while this is true use the typed message API rather than the string one, so
+  // only Routing::Send may be used with them, and they don't reply.
+  static bool typed_message_api_;
   size_t MessagesSize() const;
   void ClearMessages();
+  // While set, the observer is called with each message received by this node instead of the
+  // message being stored.
+  void SetMessageReceivedObserver(
+      std::function<void(const std::string&)> message_received_observer);
   asymm::PublicKey public_key();
   int Health();
   void SetHealth(int health);
@@ -155,6 +163,7 @@ class GenericNode {
   bool has_symmetric_nat_;
   boost::asio::ip::udp::endpoint endpoint_;
   std::vector<std::string> messages_;
+  std::function<void(const std::string&)> message_received_observer_;
   std::shared_ptr<Routing> routing_;
 
  private:
@@ -162,6 +171,7 @@ class GenericNode {
   int health_;
   void InitialiseFunctors();
   void InjectNodeInfoAndPrivateKey();
+  void StoreMessage(const std::string& message);
 };
 
 class GenericNetwork {
@@ -19,6 +19,7 @@
 #ifndef MAIDSAFE_ROUTING_TIMER_H_
 #define MAIDSAFE_ROUTING_TIMER_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <chrono>
 #include <cstdint>
@@ -28,7 +29,6 @@
 #include <memory>
 #include <mutex>
 
-#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/error.hpp"
 
 #include "maidsafe/common/asio_service.h"
@@ -36,6 +36,12 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/memory_accounting.h"
+#include "maidsafe/routing/profiled_mutex.h"
+#include "maidsafe/routing/random.h"
+#include "maidsafe/routing/scheduler.h"
+#include "maidsafe/routing/statistics.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -51,6 +57,8 @@ class Timer {
  public:
   typedef std::function<void(Response)> ResponseFunctor;
   explicit Timer(AsioService& asio_service);
+  // Runs the tasks' timeouts and functors on 'scheduler', which must outlive this.
+  explicit Timer(Scheduler& scheduler);
   // Cancels all tasks and blocks until all functors have been executed and all tasks removed.
   ~Timer();
   // Adds a task with a deadline, and returns a unique ID for the task.  'response_functor' will be
@@ -64,16 +72,28 @@ class Timer {
   // Removes the task and invokes its functor once per "missing" expected Response, with a
   // default-constructed Response each time.  Throws if the indicated task doesn't exist.
   void CancelTask(TaskId task_id);
+  // Cancels every task, as CancelTask does each.
+  void CancelAllTasks();
   // Invokes the response functor for the indicated task.  Throws if the indicated task doesn't
   // exist.
   void AddResponse(TaskId task_id, const Response& response);
 
   TaskId NewTaskId();
+  Scheduler& scheduler() { return scheduler_; }
+  // Time from each task being added to each of its responses arriving.
+  const LatencyHistogram& latency_histogram() const { return latency_histogram_; }
+  // Number of tasks which timed out before all expected responses arrived.
+  uint64_t timed_out_count() const { return timed_out_count_; }
+  // Number of tasks still awaiting responses.
+  size_t task_count() const {
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
+    return tasks_.size();
+  }
 
   friend class test::TimerTest;
 
   void PrintTaskIds() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     LOG(kVerbose) << "This timer containing following tasks : ";
     for (auto& task : tasks_) {
       LOG(kVerbose) << "      task id   ---   " << task.first;
@@ -82,14 +102,15 @@ class Timer {
 
  private:
   struct Task {
-    Task(boost::asio::io_service& io_service, const std::chrono::steady_clock::duration& timeout,
+    Task(Scheduler& scheduler, const std::chrono::steady_clock::duration& timeout,
          ResponseFunctor functor_in, int expected_response_count);
     Task(Task&& other);
     Task& operator=(Task&& other);
 
-    std::unique_ptr<boost::asio::steady_timer> timer;
+    std::unique_ptr<Scheduler::Alarm> timer;
     ResponseFunctor functor;
     int outstanding_response_count;
+    std::chrono::steady_clock::time_point start_time;
 
    private:
     Task() MAIDSAFE_DELETE;
@@ -103,45 +124,72 @@ class Timer {
 
   void FinishTask(TaskId task_id, const boost::system::error_code& error);
 
-  AsioService& asio_service_;
+  std::unique_ptr<Scheduler> own_scheduler_;
+  Scheduler& scheduler_;
   TaskId new_task_id_;
-  std::mutex mutex_;
-  std::condition_variable cond_var_;
-  std::map<TaskId, Task> tasks_;
+  mutable ProfiledMutex mutex_;
+  std::condition_variable_any cond_var_;
+  std::map<TaskId, Task, std::less<TaskId>,
+           CountingAllocator<std::pair<const TaskId, Task>, MemorySubsystem::kTimerTasks>> tasks_;
+  LatencyHistogram latency_histogram_;
+  std::atomic<uint64_t> timed_out_count_;
 };
 
 // ==================== Implementation =============================================================
 template <typename Response>
-Timer<Response>::Task::Task(boost::asio::io_service& io_service,
+Timer<Response>::Task::Task(Scheduler& scheduler,
                             const std::chrono::steady_clock::duration& timeout,
                             ResponseFunctor functor_in, int expected_response_count)
-    : timer(new boost::asio::steady_timer(io_service, timeout)),
+    : timer(scheduler.MakeAlarm()),
       functor(std::move(functor_in)),
-      outstanding_response_count(expected_response_count) {}
+      outstanding_response_count(expected_response_count),
+      start_time(scheduler.Now()) {
+  timer->ExpiresFromNow(timeout);
+}
 
 template <typename Response>
 Timer<Response>::Task::Task(Task&& other)
     : timer(std::move(other.timer)),
       functor(std::move(other.functor)),
-      outstanding_response_count(std::move(other.outstanding_response_count)) {}
+      outstanding_response_count(std::move(other.outstanding_response_count)),
+      start_time(std::move(other.start_time)) {}
 
 template <typename Response>
 typename Timer<Response>::Task& Timer<Response>::Task::operator=(Task&& other) {
   timer = std::move(other.timer);
   functor = std::move(other.functor);
   outstanding_response_count = std::move(other.outstanding_response_count);
+  start_time = std::move(other.start_time);
   return *this;
 }
 
 template <typename Response>
 Timer<Response>::Timer(AsioService& asio_service)
-    : asio_service_(asio_service), new_task_id_(RandomInt32()), mutex_(), cond_var_(), tasks_() {}
+    : own_scheduler_(new AsioScheduler(asio_service)),
+      scheduler_(*own_scheduler_),
+      new_task_id_(static_cast<TaskId>(SeededRandomUint32())),
+      mutex_("Timer"),
+      cond_var_(),
+      tasks_(),
+      latency_histogram_(),
+      timed_out_count_(0) {}
+
+template <typename Response>
+Timer<Response>::Timer(Scheduler& scheduler)
+    : own_scheduler_(),
+      scheduler_(scheduler),
+      new_task_id_(static_cast<TaskId>(SeededRandomUint32())),
+      mutex_("Timer"),
+      cond_var_(),
+      tasks_(),
+      latency_histogram_(),
+      timed_out_count_(0) {}
 
 template <typename Response>
 Timer<Response>::~Timer() {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   for (const auto& task : tasks_)
-    task.second.timer->cancel();
+    task.second.timer->Cancel();
   cond_var_.wait(lock, [&] { return tasks_.empty(); });
 }
 
@@ -156,12 +204,12 @@ void Timer<Response>::AddTask(const std::chrono::steady_clock::duration& timeout
                 << " incorrect expected_response_count";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   auto result(tasks_.insert(std::move(
-      std::make_pair(task_id, std::move(Task(asio_service_.service(), timeout, response_functor,
+      std::make_pair(task_id, std::move(Task(scheduler_, timeout, response_functor,
                                              expected_response_count))))));
   assert(result.second);
-  result.first->second.timer->async_wait([this, task_id](const boost::system::error_code & error) {
+  result.first->second.timer->AsyncWait([this, task_id](const boost::system::error_code & error) {
     this->FinishTask(task_id, error);
   });
 }
@@ -172,7 +220,7 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
   ResponseFunctor functor;
   LOG(kVerbose) << "Timer<Response>::FinishTask finish task " << task_id;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     auto itr(tasks_.find(task_id));
     if (itr == std::end(tasks_)) {
       LOG(kError) << "Timer<Response>::FinishTask Task " << task_id << " not held by Timer.";
@@ -191,6 +239,8 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
     switch (error.value()) {
       case boost::system::errc::success:  // Task's timer has expired
         LOG(kWarning) << "Timed out waiting for task " << task_id;
+        if (outstanding_response_count != 0)
+          ++timed_out_count_;
         break;
       case boost::asio::error::operation_aborted:  // Cancelled via CancelTask
         LOG(kInfo) << "Cancelled task " << task_id;
@@ -200,7 +250,7 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
     }
 
     for (int i(0); i != outstanding_response_count; ++i)
-      asio_service_.service().dispatch([=] { functor(Response()); });
+      scheduler_.Dispatch([=] { functor(Response()); });
   }
 
   cond_var_.notify_one();
@@ -209,13 +259,21 @@ void Timer<Response>::FinishTask(TaskId task_id, const boost::system::error_code
 template <typename Response>
 void Timer<Response>::CancelTask(TaskId task_id) {
   LOG(kVerbose) << "Timer<Response>::CancelTask task " << task_id << " is to be canceled";
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   auto itr(tasks_.find(task_id));
   if (itr == std::end(tasks_)) {
     LOG(kError) << "Task " << task_id << " not held by Timer.";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
   }
-  itr->second.timer->cancel();
+  itr->second.timer->Cancel();
+}
+
+template <typename Response>
+void Timer<Response>::CancelAllTasks() {
+  LOG(kVerbose) << "Timer<Response>::CancelAllTasks";
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
+  for (const auto& task : tasks_)
+    task.second.timer->Cancel();
 }
 
 template <typename Response>
@@ -223,7 +281,7 @@ void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
   ResponseFunctor functor;
   LOG(kVerbose) << "Timer<Response>::AddResponse add response to task " << task_id;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     auto itr(tasks_.find(task_id));
     if (itr == std::end(tasks_)) {
       LOG(kError) << "Task " << task_id << " not held by Timer.";
@@ -231,18 +289,19 @@ void Timer<Response>::AddResponse(TaskId task_id, const Response& response) {
     }
     assert(itr->second.outstanding_response_count > 0);
     --(itr->second.outstanding_response_count);
+    latency_histogram_.Record(scheduler_.Now() - itr->second.start_time);
     LOG(kVerbose) << "Task " << task_id << " now having " << itr->second.outstanding_response_count
                   << " outstanding_response_count.";
     functor = itr->second.functor;
     if (itr->second.outstanding_response_count == 0)
-      itr->second.timer->cancel();  // Invokes 'FinishTask'
+      itr->second.timer->Cancel();  // Invokes 'FinishTask'
   }
-  asio_service_.service().dispatch([=] { functor(response); });
+  scheduler_.Dispatch([=] { functor(response); });
 }
 
 template <typename Response>
 TaskId Timer<Response>::NewTaskId() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return new_task_id_++;
 }
 
@@ -0,0 +1,44 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TRACING_H_
+#define MAIDSAFE_ROUTING_TRACING_H_
+
+#include <string>
+
+namespace maidsafe {
+
+namespace routing {
+
+// One in every Parameters::message_trace_sample_rate messages has the stages of its handling
+// (queueing, parsing, routing, sending and upper-layer functors) recorded as timed spans.  Messages
+// are sampled by ID and source, so every node in a process traces the same messages.  Each thread
+// keeps its most recent spans in a fixed-size ring buffer.
+
+// Returns the spans currently held by all threads in Chrome trace-event JSON format, suitable for
+// loading in chrome://tracing.
+std::string ChromeTraceJson();
+
+// Excludes all spans recorded so far from subsequent calls to ChromeTraceJson.
+void ClearTrace();
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TRACING_H_
@@ -0,0 +1,75 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/benchmarks/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// Plain data, so needing no dynamic initialisation which could itself allocate.
+thread_local uint64_t allocation_count(0);
+
+void* CountedAllocateNoThrow(std::size_t size) {
+  ++allocation_count;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* CountedAllocate(std::size_t size) {
+  void* memory(CountedAllocateNoThrow(size));
+  if (!memory)
+    throw std::bad_alloc();
+  return memory;
+}
+
+}  // unnamed namespace
+
+uint64_t ThreadAllocationCount() { return allocation_count; }
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+void* operator new(std::size_t size) { return maidsafe::routing::test::CountedAllocate(size); }
+
+void* operator new[](std::size_t size) { return maidsafe::routing::test::CountedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) {
+  return maidsafe::routing::test::CountedAllocateNoThrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) {
+  return maidsafe::routing::test::CountedAllocateNoThrow(size);
+}
+
+void operator delete(void* memory) { std::free(memory); }
+
+void operator delete[](void* memory) { std::free(memory); }
+
+void operator delete(void* memory, const std::nothrow_t&) { std::free(memory); }
+
+void operator delete[](void* memory, const std::nothrow_t&) { std::free(memory); }
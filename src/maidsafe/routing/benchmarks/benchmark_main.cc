@@ -0,0 +1,42 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+// Runs the benchmarks selected by the usual Google Benchmark flags.  Results are written as JSON
+// unless --benchmark_format says otherwise, so that runs can be compared across commits.
+int main(int argc, char** argv) {
+  std::vector<char*> args(argv, argv + argc);
+  std::string json_format("--benchmark_format=json");
+  if (std::none_of(std::begin(args), std::end(args), [](const char* arg) {
+        return std::strncmp(arg, "--benchmark_format", 18) == 0;
+      })) {
+    args.push_back(&json_format[0]);
+  }
+  int arg_count(static_cast<int>(args.size()));
+  ::benchmark::Initialize(&arg_count, args.data());
+  if (::benchmark::ReportUnrecognizedArguments(arg_count, args.data()))
+    return 1;
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/routing_table.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kClusteredPrefixBytes(2);
+
+}  // unnamed namespace
+
+NodeId MakeBenchmarkId(const NodeId& own_id, KeyDistribution distribution) {
+  if (distribution == KeyDistribution::kUniform)
+    return NodeId(NodeId::kRandomId);
+  std::string distance(RandomString(NodeId::kSize));
+  std::fill(std::begin(distance), std::begin(distance) + kClusteredPrefixBytes, '\0');
+  return own_id ^ NodeId(distance);
+}
+
+std::vector<NodeInfo> MakeBenchmarkNodes(size_t count, const NodeId& own_id,
+                                         KeyDistribution distribution) {
+  std::vector<NodeInfo> nodes;
+  nodes.reserve(count);
+  while (nodes.size() != count) {
+    NodeInfo node;
+    node.node_id = MakeBenchmarkId(own_id, distribution);
+    node.connection_id = node.node_id;
+    node.public_key = BenchmarkKeys(nodes.size()).public_key;
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+const asymm::Keys& BenchmarkKeys(size_t index) {
+  // A deque, so that references remain valid as it grows.
+  static std::deque<asymm::Keys> keys;
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  while (keys.size() <= index)
+    keys.push_back(asymm::GenerateKeyPair());
+  return keys[index];
+}
+
+void InitialiseNoOpFunctors(RoutingTable& routing_table) {
+  routing_table.InitialiseFunctors([](int) {}, [](const NodeInfo&, bool) {}, []() {},
+                                   [](std::vector<NodeInfo>, std::vector<NodeInfo>) {},
+                                   [](std::shared_ptr<MatrixChange>) {});
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,81 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
+#define MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+class RoutingTable;
+
+namespace test {
+
+// How the IDs of generated nodes are spread relative to the benchmarked node's own ID.
+enum class KeyDistribution : int {
+  kUniform = 0,  // anywhere in the address space
+  kClustered     // sharing at least the first 16 bits, so crowding the closest buckets
+};
+
+NodeId MakeBenchmarkId(const NodeId& own_id, KeyDistribution distribution);
+
+// Returns 'count' nodes with distinct public keys and IDs spread per 'distribution'.  Key pairs are
+// generated once per process and shared between benchmarks, as generating them dominates setup.
+std::vector<NodeInfo> MakeBenchmarkNodes(size_t count, const NodeId& own_id,
+                                         KeyDistribution distribution);
+
+const asymm::Keys& BenchmarkKeys(size_t index);
+
+// Gives the routing table functors which do nothing, as it expects them to be set before any nodes
+// are added.
+void InitialiseNoOpFunctors(RoutingTable& routing_table);
+
+// Sets a Parameters member for the lifetime of this object.
+template <typename T>
+class ScopedParameter {
+ public:
+  ScopedParameter(T& parameter, T value) : parameter_(parameter), kOriginalValue_(parameter) {
+    parameter_ = value;
+  }
+  ~ScopedParameter() { parameter_ = kOriginalValue_; }
+
+ private:
+  ScopedParameter(const ScopedParameter&);
+  ScopedParameter(const ScopedParameter&&);
+  ScopedParameter& operator=(const ScopedParameter&);
+
+  T& parameter_;
+  const T kOriginalValue_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_BENCHMARKS_BENCHMARK_UTILS_H_
@@ -0,0 +1,124 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/simulated_network.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+double Milliseconds(const std::chrono::microseconds& duration) {
+  return static_cast<double>(duration.count()) / 1000.0;
+}
+
+uint64_t Total(const LatencyBuckets& buckets) {
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  return total;
+}
+
+// Reports the count and bytes of a message type's requests and responses sent while churning.
+void SetTrafficCounters(::benchmark::State& state, const SimulationResults& results,
+                        const std::string& type, const std::string& counter_prefix) {
+  auto request(results.measured_traffic.find(type));
+  auto response(results.measured_traffic.find(type + "Response"));
+  double messages(0.0), bytes(0.0);
+  if (request != std::end(results.measured_traffic)) {
+    messages += static_cast<double>(request->second.messages);
+    bytes += static_cast<double>(request->second.bytes);
+  }
+  if (response != std::end(results.measured_traffic)) {
+    messages += static_cast<double>(response->second.messages);
+    bytes += static_cast<double>(response->second.bytes);
+  }
+  state.counters[counter_prefix + "_msgs"] = messages;
+  state.counters[counter_prefix + "_bytes"] = bytes;
+}
+
+// Arguments are {nodes, joins_per_minute, leaves_per_minute}.  Equal rates model a rolling upgrade
+// replacing nodes; leaves alone model the network shrinking.
+void ChurnRates(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"nodes", "joins_per_min", "leaves_per_min"});
+  for (int64_t nodes : {64, 128}) {
+    benchmark->Args({nodes, 6, 6});
+    benchmark->Args({nodes, 30, 30});
+    benchmark->Args({nodes, 0, 30});
+  }
+  benchmark->Iterations(1)->Unit(::benchmark::kMillisecond)->UseRealTime();
+}
+
+}  // unnamed namespace
+
+// Joins range(0) real Routing::Impl nodes on a simulated transport and in virtual time, lets them
+// settle, then churns them at the given rates for a minute while sending test messages.  Wall time
+// is that of the whole simulation, including the real-time sleeps of the two ZeroStateJoins; the
+// counters cover the minute of churn and the settling after it:
+//   - reconvergence: time from each join or leave until the close groups around it were correct
+//     again, with 'unconverged' counting those which never were
+//   - the count and bytes of ClosestNodesUpdate, FindNodes, Connect and ConnectSuccess messages,
+//     responses included.  Message IDs are random, so bytes vary slightly from run to run.
+//   - test messages lost of those sent.  Link loss only delays messages, so none were dropped by
+//     the links themselves.
+void BM_Churn(::benchmark::State& state) {
+  SimulationParameters parameters;
+  parameters.node_count = static_cast<size_t>(state.range(0));
+  parameters.join_rate = static_cast<double>(state.range(1)) / 60.0;
+  parameters.leave_rate = static_cast<double>(state.range(2)) / 60.0;
+  parameters.measure_time = std::chrono::seconds(60);
+  SimulationResults results;
+  while (state.KeepRunning())
+    results = SimulatedNetwork(parameters).Run();
+
+  state.counters["churn_events"] =
+      static_cast<double>(Total(results.reconvergence) + results.unconverged);
+  state.counters["unconverged"] = static_cast<double>(results.unconverged);
+  if (!results.reconvergence.empty()) {
+    state.counters["reconvergence_p50_ms"] =
+        Milliseconds(LatencyPercentile(results.reconvergence, 50));
+    state.counters["reconvergence_p90_ms"] =
+        Milliseconds(LatencyPercentile(results.reconvergence, 90));
+    state.counters["reconvergence_p99_ms"] =
+        Milliseconds(LatencyPercentile(results.reconvergence, 99));
+  }
+  SetTrafficCounters(state, results, "ClosestNodesUpdate", "closest_nodes_update");
+  SetTrafficCounters(state, results, "FindNodes", "find_nodes");
+  SetTrafficCounters(state, results, "Connect", "connect");
+  SetTrafficCounters(state, results, "ConnectSuccess", "connect_success");
+  state.counters["messages_sent"] = static_cast<double>(results.messages_sent);
+  state.counters["messages_lost"] =
+      static_cast<double>(results.messages_sent - results.messages_delivered);
+}
+BENCHMARK(BM_Churn)->Apply(ChurnRates);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
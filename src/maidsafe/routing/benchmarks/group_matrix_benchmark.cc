@@ -0,0 +1,275 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/group_matrix.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Gives the benchmarks access to MatrixChange's private constructor.
+class GroupMatrixBenchmark {
+ public:
+  static MatrixChange MakeMatrixChange(const NodeId& this_node_id,
+                                       const std::vector<NodeId>& old_matrix,
+                                       const std::vector<NodeId>& new_matrix) {
+    return MatrixChange(this_node_id, old_matrix, new_matrix);
+  }
+};
+
+namespace {
+
+// The simulated network holds this many nodes per matrix entry, so that rows overlap as they
+// would in a real network rather than every row being disjoint.
+const size_t kNetworkSizeFactor(4);
+
+// Query targets are generated once and shared, as generating 10^6 IDs dominates setup.  Each
+// benchmark uses the first range(0) of them.
+const std::vector<NodeId>& Targets(size_t count) {
+  static std::vector<NodeId> targets;
+  targets.reserve(count);
+  while (targets.size() < count)
+    targets.push_back(NodeId(NodeId::kRandomId));
+  return targets;
+}
+
+std::vector<NodeInfo> ClosestTo(const NodeId& target, size_t count, std::vector<NodeInfo> nodes) {
+  count = std::min(count, nodes.size());
+  std::partial_sort(std::begin(nodes), std::begin(nodes) + count, std::end(nodes),
+                    [&target](const NodeInfo& lhs, const NodeInfo& rhs) {
+                      return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, target);
+                    });
+  nodes.resize(count);
+  return nodes;
+}
+
+// A group matrix as held by a vault with a full routing table: closest_nodes_size connected peers,
+// each row holding that peer's closest_nodes_size nodes from a simulated network.  One further
+// peer, the next closest, is kept spare.  closest_nodes_size and group_size are set from the
+// benchmark arguments at closest_nodes_size_arg and the one after it.
+class PopulatedGroupMatrix {
+ public:
+  PopulatedGroupMatrix(const ::benchmark::State& state, int closest_nodes_size_arg)
+      : closest_nodes_size_(Parameters::closest_nodes_size,
+                            static_cast<uint16_t>(state.range(closest_nodes_size_arg))),
+        group_size_(Parameters::group_size,
+                    static_cast<uint16_t>(state.range(closest_nodes_size_arg + 1))),
+        own_id_(NodeId::kRandomId),
+        group_matrix_(own_id_, false),
+        network_(),
+        peers_(),
+        spare_peer_(),
+        spare_row_() {
+    NodeInfo own_info;
+    own_info.node_id = own_id_;
+    network_.push_back(own_info);
+    size_t network_size(kNetworkSizeFactor * Parameters::closest_nodes_size *
+                        Parameters::closest_nodes_size);
+    while (network_.size() != network_size) {
+      NodeInfo node;
+      node.node_id = NodeId(NodeId::kRandomId);
+      node.connection_id = node.node_id;
+      network_.push_back(node);
+    }
+
+    std::vector<NodeInfo> closest(
+        ClosestTo(own_id_, Parameters::closest_nodes_size + 2U, network_));
+    for (size_t i(1); i != closest.size(); ++i) {
+      const NodeInfo& peer(closest[i]);
+      std::vector<NodeInfo> row(ClosestTo(peer.node_id, Parameters::closest_nodes_size + 1U,
+                                          network_));
+      row.erase(std::begin(row));  // the peer itself
+      if (i + 1 == closest.size()) {
+        spare_peer_ = peer;
+        spare_row_ = row;
+      } else {
+        group_matrix_.AddConnectedPeer(peer);
+        group_matrix_.UpdateFromConnectedPeer(peer.node_id, row, group_matrix_.GetUniqueNodeIds());
+        peers_.push_back(std::make_pair(peer, row));
+      }
+    }
+  }
+
+  GroupMatrix& group_matrix() { return group_matrix_; }
+  const NodeId& own_id() const { return own_id_; }
+  const std::vector<std::pair<NodeInfo, std::vector<NodeInfo>>>& peers() const { return peers_; }
+  const NodeInfo& spare_peer() const { return spare_peer_; }
+  const std::vector<NodeInfo>& spare_row() const { return spare_row_; }
+
+  // The matrix's unique IDs after losing its furthest peer's row and gaining the spare peer's.
+  std::vector<NodeId> ChangedUniqueNodeIds() {
+    group_matrix_.RemoveConnectedPeer(peers_.back().first);
+    group_matrix_.AddConnectedPeer(spare_peer_, spare_row_);
+    std::vector<NodeId> changed(group_matrix_.GetUniqueNodeIds());
+    group_matrix_.RemoveConnectedPeer(spare_peer_);
+    group_matrix_.AddConnectedPeer(peers_.back().first, peers_.back().second);
+    return changed;
+  }
+
+ private:
+  PopulatedGroupMatrix(const PopulatedGroupMatrix&);
+  PopulatedGroupMatrix(const PopulatedGroupMatrix&&);
+  PopulatedGroupMatrix& operator=(const PopulatedGroupMatrix&);
+
+  ScopedParameter<uint16_t> closest_nodes_size_;
+  ScopedParameter<uint16_t> group_size_;
+  const NodeId own_id_;  // must outlive group_matrix_, which holds a reference to it
+  GroupMatrix group_matrix_;
+  std::vector<NodeInfo> network_;
+  std::vector<std::pair<NodeInfo, std::vector<NodeInfo>>> peers_;
+  NodeInfo spare_peer_;
+  std::vector<NodeInfo> spare_row_;
+};
+
+const int64_t kMatrixSizes[][2] = {{8, 4}, {16, 4}, {16, 8}, {32, 8}};
+
+// Arguments are {closest_nodes_size, group_size}.
+void MatrixSizes(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"closest_nodes_size", "group_size"});
+  for (const auto& sizes : kMatrixSizes)
+    benchmark->Args({sizes[0], sizes[1]});
+}
+
+// Arguments are {targets, closest_nodes_size, group_size}, with 10^3 to 10^6 targets.
+void TargetsAndMatrixSizes(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"targets", "closest_nodes_size", "group_size"});
+  for (int64_t targets(1000); targets <= 1000000; targets *= 10) {
+    for (const auto& sizes : kMatrixSizes)
+      benchmark->Args({targets, sizes[0], sizes[1]});
+  }
+}
+
+}  // unnamed namespace
+
+void BM_GroupMatrixAddConnectedPeer(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 0);
+  while (state.KeepRunning()) {
+    ::benchmark::DoNotOptimize(
+        matrix.group_matrix().AddConnectedPeer(matrix.spare_peer(), matrix.spare_row()));
+    state.PauseTiming();
+    matrix.group_matrix().RemoveConnectedPeer(matrix.spare_peer());
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_GroupMatrixAddConnectedPeer)->Apply(MatrixSizes);
+
+// Alternates each peer's row between its real contents and a copy missing its furthest entry, so
+// that every update changes the matrix.
+void BM_GroupMatrixUpdateFromConnectedPeer(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 0);
+  std::vector<std::vector<NodeInfo>> rows[2];
+  std::vector<std::vector<NodeId>> unique_ids[2];
+  for (const auto& peer : matrix.peers()) {
+    rows[0].push_back(peer.second);
+    rows[1].push_back(peer.second);
+    rows[1].back().pop_back();
+  }
+  for (size_t version(0); version != 2; ++version) {
+    for (size_t i(0); i != matrix.peers().size(); ++i) {
+      unique_ids[version].push_back(matrix.group_matrix().GetUniqueNodeIds());
+      matrix.group_matrix().UpdateFromConnectedPeer(matrix.peers()[i].first.node_id,
+                                                    rows[1 - version][i],
+                                                    unique_ids[version].back());
+    }
+  }
+  // Each peer's row is now rows[0] again; unique_ids[v][i] is the matrix state when peer i is
+  // next updated to rows[1 - v].
+  size_t index(0);
+  while (state.KeepRunning()) {
+    size_t peer(index % matrix.peers().size());
+    size_t version((index / matrix.peers().size()) % 2);
+    ::benchmark::DoNotOptimize(matrix.group_matrix().UpdateFromConnectedPeer(
+        matrix.peers()[peer].first.node_id, rows[1 - version][peer], unique_ids[version][peer]));
+    ++index;
+  }
+}
+BENCHMARK(BM_GroupMatrixUpdateFromConnectedPeer)->Apply(MatrixSizes);
+
+void BM_GroupMatrixGetBetterNodeForSendingMessage(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 1);
+  const std::vector<NodeId>& targets(Targets(static_cast<size_t>(state.range(0))));
+  const size_t kTargetCount(static_cast<size_t>(state.range(0)));
+  const std::vector<std::string> kExclude;
+  NodeInfo closest_peer;
+  size_t index(0);
+  while (state.KeepRunning()) {
+    closest_peer = matrix.peers().back().first;
+    matrix.group_matrix().GetBetterNodeForSendingMessage(targets[index++ % kTargetCount], kExclude,
+                                                         false, closest_peer);
+    ::benchmark::DoNotOptimize(closest_peer);
+  }
+}
+BENCHMARK(BM_GroupMatrixGetBetterNodeForSendingMessage)->Apply(TargetsAndMatrixSizes);
+
+void BM_GroupMatrixIsNodeIdInGroupRange(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 1);
+  const std::vector<NodeId>& targets(Targets(static_cast<size_t>(state.range(0))));
+  const size_t kTargetCount(static_cast<size_t>(state.range(0)));
+  size_t index(0);
+  while (state.KeepRunning()) {
+    ::benchmark::DoNotOptimize(matrix.group_matrix().IsNodeIdInGroupRange(
+        targets[index++ % kTargetCount], matrix.own_id()));
+  }
+}
+BENCHMARK(BM_GroupMatrixIsNodeIdInGroupRange)->Apply(TargetsAndMatrixSizes);
+
+void BM_MatrixChangeConstruction(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 0);
+  const std::vector<NodeId> kOldIds(matrix.group_matrix().GetUniqueNodeIds());
+  const std::vector<NodeId> kNewIds(matrix.ChangedUniqueNodeIds());
+  while (state.KeepRunning()) {
+    ::benchmark::DoNotOptimize(
+        GroupMatrixBenchmark::MakeMatrixChange(matrix.own_id(), kOldIds, kNewIds));
+  }
+}
+BENCHMARK(BM_MatrixChangeConstruction)->Apply(MatrixSizes);
+
+void BM_MatrixChangeCheckHolders(::benchmark::State& state) {
+  PopulatedGroupMatrix matrix(state, 1);
+  const std::vector<NodeId>& targets(Targets(static_cast<size_t>(state.range(0))));
+  const size_t kTargetCount(static_cast<size_t>(state.range(0)));
+  const MatrixChange kMatrixChange(GroupMatrixBenchmark::MakeMatrixChange(
+      matrix.own_id(), matrix.group_matrix().GetUniqueNodeIds(), matrix.ChangedUniqueNodeIds()));
+  size_t index(0);
+  while (state.KeepRunning())
+    ::benchmark::DoNotOptimize(kMatrixChange.CheckHolders(targets[index++ % kTargetCount]));
+}
+BENCHMARK(BM_MatrixChangeCheckHolders)->Apply(TargetsAndMatrixSizes);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
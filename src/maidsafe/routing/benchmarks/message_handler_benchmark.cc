@@ -0,0 +1,271 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/benchmarks/allocation_counter.h"
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/group_change_handler.h"
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/remove_furthest_node.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/timer.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kTableSize(64);
+// Number of distinct messages in each class's stream.
+const size_t kStreamSize(256);
+// Number of distinct cacheable requests, all of which are cached before timing starts.
+const size_t kCachedKeyCount(16);
+
+enum class MessageClass {
+  kTransit,      // direct node-level request for a far node, passed on
+  kForThisNode,  // direct node-level request to this node, passed to the upper layer
+  kGroup,        // group request for which this node is the group leader, so replicated
+  kRelay,        // direct request from a relayed client, passed on with this node as source
+  kCacheable     // cacheable Get answered from the response cache
+};
+
+// Discards outgoing messages, so that only routing's own handling is measured.  The gmock-based
+// MockNetworkUtils isn't used, as its per-call bookkeeping allocates and would swamp the
+// allocation counts being reported.
+class NoOpNetworkUtils : public NetworkUtils {
+ public:
+  NoOpNetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table)
+      : NetworkUtils(routing_table, client_routing_table), sent_count_(0) {}
+  virtual ~NoOpNetworkUtils() {}
+
+  virtual void SendToDirect(const protobuf::Message& /*message*/, const NodeId& /*peer_node_id*/,
+                            const NodeId& /*peer_connection_id*/) {
+    ++sent_count_;
+  }
+  virtual void SendToClosestNode(const protobuf::Message& /*message*/) { ++sent_count_; }
+  uint64_t sent_count() const { return sent_count_; }
+
+ private:
+  NoOpNetworkUtils(const NoOpNetworkUtils&);
+  NoOpNetworkUtils(const NoOpNetworkUtils&&);
+  NoOpNetworkUtils& operator=(const NoOpNetworkUtils&);
+
+  uint64_t sent_count_;
+};
+
+NodeId NearbyId(const NodeId& node_id, size_t index) {
+  std::string distance(NodeId::kSize, '\0');
+  distance[NodeId::kSize - 1] = static_cast<char>(1 + index % 255);
+  return node_id ^ NodeId(distance);
+}
+
+// A vault's MessageHandler with a full routing table and group matrix.  The upper layer answers
+// cache lookups and ignores all other messages.
+class HandlerUnderTest {
+ public:
+  HandlerUnderTest()
+      : max_size_(Parameters::max_routing_table_size, static_cast<uint16_t>(kTableSize + 1)),
+        caching_(Parameters::caching, true),
+        asio_service_(2),
+        timer_(asio_service_),
+        own_id_(NodeId::kRandomId),
+        network_statistics_(own_id_),
+        routing_table_(false, own_id_, asymm::GenerateKeyPair(), network_statistics_),
+        client_routing_table_(own_id_),
+        network_(routing_table_, client_routing_table_),
+        remove_furthest_node_(routing_table_, network_),
+        group_change_handler_(routing_table_, client_routing_table_, network_),
+        message_handler_(routing_table_, client_routing_table_, network_, timer_,
+                         remove_furthest_node_, group_change_handler_, network_statistics_),
+        nodes_(MakeBenchmarkNodes(kTableSize, own_id_, KeyDistribution::kUniform)) {
+    InitialiseNoOpFunctors(routing_table_);
+    for (const auto& node : nodes_)
+      routing_table_.AddNode(node);
+    for (const auto& peer : routing_table_.GetClosestNodes(own_id_, Parameters::closest_nodes_size))
+      routing_table_.GroupUpdateFromConnectedPeer(peer, PeerRow(peer));
+
+    MessageAndCachingFunctors functors;
+    functors.message_received = [](const std::string& /*message*/, bool cache_lookup,
+                                   ReplyFunctor reply_functor) {
+      if (cache_lookup)
+        reply_functor("cached response");
+    };
+    functors.have_cache_data = [](std::string&) { return false; };
+    functors.store_cache_data = [](const std::string&) {};
+    message_handler_.set_message_and_caching_functor(functors);
+  }
+
+  ~HandlerUnderTest() { asio_service_.Stop(); }
+
+  // As Routing::Impl::DoOnMessageReceived, parses the serialised message and handles it.
+  void OnMessageReceived(const std::string& serialised_message) {
+    protobuf::Message message;
+    if (message.ParseFromString(serialised_message))
+      message_handler_.HandleMessage(message);
+  }
+
+  std::vector<std::string> MakeStream(MessageClass message_class) {
+    std::vector<std::string> stream;
+    for (size_t i(0); i != kStreamSize; ++i)
+      stream.push_back(MakeMessage(message_class, i).SerializeAsString());
+    return stream;
+  }
+
+  uint64_t sent_count() const { return network_.sent_count(); }
+
+ private:
+  HandlerUnderTest(const HandlerUnderTest&);
+  HandlerUnderTest(const HandlerUnderTest&&);
+  HandlerUnderTest& operator=(const HandlerUnderTest&);
+
+  std::vector<NodeInfo> PeerRow(const NodeId& peer) {
+    std::vector<NodeInfo> row;
+    auto closest(routing_table_.GetClosestNodes(peer, Parameters::closest_nodes_size + 1));
+    for (const auto& node_id : closest) {
+      if (node_id == peer)
+        continue;
+      NodeInfo node_info;
+      node_info.node_id = node_id;
+      row.push_back(node_info);
+    }
+    return row;
+  }
+
+  // Returns a random ID outwith this node's closest nodes' range.
+  NodeId FarId() {
+    NodeId far_id(NodeId::kRandomId);
+    while (routing_table_.IsThisNodeInRange(far_id, Parameters::closest_nodes_size))
+      far_id = NodeId(NodeId::kRandomId);
+    return far_id;
+  }
+
+  protobuf::Message MakeMessage(MessageClass message_class, size_t index) {
+    protobuf::Message message;
+    message.set_routing_message(false);
+    message.set_direct(true);
+    message.set_request(true);
+    message.set_client_node(false);
+    message.set_hops_to_live(Parameters::hops_to_live);
+    message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+    message.set_id(static_cast<int32_t>(index));
+    message.set_source_id(nodes_[index % nodes_.size()].node_id.string());
+    message.set_last_id(message.source_id());
+    message.add_data(RandomString(256));
+    message.set_replication(1);
+    switch (message_class) {
+      case MessageClass::kTransit:
+        message.set_destination_id(FarId().string());
+        break;
+      case MessageClass::kForThisNode:
+        message.set_destination_id(own_id_.string());
+        break;
+      case MessageClass::kGroup:
+        message.set_direct(false);
+        message.set_replication(Parameters::group_size);
+        message.set_visited(false);
+        message.set_destination_id(NearbyId(own_id_, index).string());
+        break;
+      case MessageClass::kRelay:
+        message.clear_source_id();
+        message.set_client_node(true);
+        message.set_relay_id(NodeId(NodeId::kRandomId).string());
+        message.set_relay_connection_id(NodeId(NodeId::kRandomId).string());
+        message.set_destination_id(FarId().string());
+        break;
+      case MessageClass::kCacheable:
+        message.set_cacheable(static_cast<int32_t>(Cacheable::kGet));
+        message.set_destination_id(FarId().string());
+        message.set_data(0, "cacheable request " + std::to_string(index % kCachedKeyCount));
+        break;
+    }
+    return message;
+  }
+
+  ScopedParameter<uint16_t> max_size_;
+  ScopedParameter<bool> caching_;
+  AsioService asio_service_;
+  Timer<std::string> timer_;
+  const NodeId own_id_;
+  NetworkStatistics network_statistics_;
+  RoutingTable routing_table_;
+  ClientRoutingTable client_routing_table_;
+  NoOpNetworkUtils network_;
+  RemoveFurthestNode remove_furthest_node_;
+  GroupChangeHandler group_change_handler_;
+  MessageHandler message_handler_;
+  const std::vector<NodeInfo> nodes_;
+};
+
+}  // unnamed namespace
+
+// Reports messages handled per second as items_per_second, and per message the number of heap
+// allocations made on the handling thread and the number of messages sent on.
+void BM_MessageHandler(::benchmark::State& state, MessageClass message_class) {
+  HandlerUnderTest handler;
+  const std::vector<std::string> kStream(handler.MakeStream(message_class));
+  // Fills the response cache, and any other state built up by the first sight of a message.
+  for (const auto& message : kStream)
+    handler.OnMessageReceived(message);
+
+  uint64_t bytes(0), first_allocation_count(ThreadAllocationCount()),
+      first_sent_count(handler.sent_count());
+  size_t index(0);
+  while (state.KeepRunning()) {
+    const std::string& message(kStream[index++ % kStream.size()]);
+    handler.OnMessageReceived(message);
+    bytes += message.size();
+  }
+  double iterations(static_cast<double>(state.iterations()));
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.counters["allocations_per_message"] =
+      static_cast<double>(ThreadAllocationCount() - first_allocation_count) / iterations;
+  state.counters["sends_per_message"] =
+      static_cast<double>(handler.sent_count() - first_sent_count) / iterations;
+}
+BENCHMARK_CAPTURE(BM_MessageHandler, Transit, MessageClass::kTransit);
+BENCHMARK_CAPTURE(BM_MessageHandler, ForThisNode, MessageClass::kForThisNode);
+BENCHMARK_CAPTURE(BM_MessageHandler, Group, MessageClass::kGroup);
+BENCHMARK_CAPTURE(BM_MessageHandler, Relay, MessageClass::kRelay);
+BENCHMARK_CAPTURE(BM_MessageHandler, Cacheable, MessageClass::kCacheable);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
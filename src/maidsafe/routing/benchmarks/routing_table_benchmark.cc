@@ -0,0 +1,246 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kTargetCount(1024);
+const size_t kExcludedCount(4);
+
+std::vector<NodeId> MakeTargets(const NodeId& own_id, KeyDistribution distribution) {
+  std::vector<NodeId> targets;
+  for (size_t i(0); i != kTargetCount; ++i)
+    targets.push_back(MakeBenchmarkId(own_id, distribution));
+  return targets;
+}
+
+// A routing table holding range(0) nodes spread per range(1), plus one spare node which isn't in
+// the table.  The maximum table size is raised to fit.
+class PopulatedRoutingTable {
+ public:
+  explicit PopulatedRoutingTable(const ::benchmark::State& state)
+      : kDistribution_(static_cast<KeyDistribution>(state.range(1))),
+        max_size_(Parameters::max_routing_table_size, static_cast<uint16_t>(state.range(0) + 1)),
+        own_id_(NodeId::kRandomId),
+        network_statistics_(own_id_),
+        routing_table_(false, own_id_, asymm::GenerateKeyPair(), network_statistics_),
+        nodes_(MakeBenchmarkNodes(static_cast<size_t>(state.range(0) + 1), own_id_,
+                                  kDistribution_)),
+        targets_(MakeTargets(own_id_, kDistribution_)) {
+    InitialiseNoOpFunctors(routing_table_);
+    for (size_t i(0); i + 1 < nodes_.size(); ++i)
+      routing_table_.AddNode(nodes_[i]);
+  }
+
+  RoutingTable& routing_table() { return routing_table_; }
+  const NodeInfo& spare_node() const { return nodes_.back(); }
+  const NodeId& target(size_t index) const { return targets_[index % targets_.size()]; }
+
+  // The IDs of the table's kExcludedCount closest nodes to each target.
+  std::vector<std::vector<std::string>> Exclusions() const {
+    std::vector<std::vector<std::string>> exclusions;
+    std::vector<NodeInfo> nodes(std::begin(nodes_), std::end(nodes_) - 1);
+    size_t excluded_count(std::min(kExcludedCount, nodes.size()));
+    for (const auto& target : targets_) {
+      std::partial_sort(std::begin(nodes), std::begin(nodes) + excluded_count, std::end(nodes),
+                        [&target](const NodeInfo& lhs, const NodeInfo& rhs) {
+                          return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, target);
+                        });
+      std::vector<std::string> excluded;
+      for (size_t i(0); i != excluded_count; ++i)
+        excluded.push_back(nodes[i].node_id.string());
+      exclusions.push_back(excluded);
+    }
+    return exclusions;
+  }
+
+ private:
+  PopulatedRoutingTable(const PopulatedRoutingTable&);
+  PopulatedRoutingTable(const PopulatedRoutingTable&&);
+  PopulatedRoutingTable& operator=(const PopulatedRoutingTable&);
+
+  const KeyDistribution kDistribution_;
+  ScopedParameter<uint16_t> max_size_;
+  const NodeId own_id_;
+  NetworkStatistics network_statistics_;
+  RoutingTable routing_table_;
+  const std::vector<NodeInfo> nodes_;
+  const std::vector<NodeId> targets_;
+};
+
+// As PopulatedRoutingTable, for a ClientRoutingTable.  All clients share one key pair, as the
+// client routing table doesn't require keys to be unique.
+class PopulatedClientRoutingTable {
+ public:
+  explicit PopulatedClientRoutingTable(const ::benchmark::State& state)
+      : max_size_(Parameters::max_client_routing_table_size,
+                  static_cast<uint16_t>(state.range(0) + 1)),
+        own_id_(NodeId::kRandomId),
+        furthest_close_node_id_(own_id_ ^ NodeId(NodeId::kMaxId)),
+        client_routing_table_(own_id_),
+        nodes_() {
+    KeyDistribution distribution(static_cast<KeyDistribution>(state.range(1)));
+    for (int64_t i(0); i <= state.range(0); ++i) {
+      NodeInfo node;
+      node.node_id = MakeBenchmarkId(own_id_, distribution);
+      node.connection_id = NodeId(NodeId::kRandomId);
+      node.public_key = BenchmarkKeys(0).public_key;
+      nodes_.push_back(node);
+    }
+    for (size_t i(0); i + 1 < nodes_.size(); ++i)
+      client_routing_table_.AddNode(nodes_[i], furthest_close_node_id_);
+  }
+
+  ClientRoutingTable& client_routing_table() { return client_routing_table_; }
+  const NodeId& furthest_close_node_id() const { return furthest_close_node_id_; }
+  NodeInfo& spare_node() { return nodes_.back(); }
+  const NodeId& node_id(size_t index) const { return nodes_[index % (nodes_.size() - 1)].node_id; }
+
+ private:
+  PopulatedClientRoutingTable(const PopulatedClientRoutingTable&);
+  PopulatedClientRoutingTable(const PopulatedClientRoutingTable&&);
+  PopulatedClientRoutingTable& operator=(const PopulatedClientRoutingTable&);
+
+  ScopedParameter<uint16_t> max_size_;
+  const NodeId own_id_, furthest_close_node_id_;
+  ClientRoutingTable client_routing_table_;
+  std::vector<NodeInfo> nodes_;
+};
+
+void TableArguments(::benchmark::internal::Benchmark* benchmark, int64_t min_size) {
+  benchmark->ArgNames({"size", "clustered"});
+  for (int64_t size(min_size); size <= 4096; size *= 8) {
+    benchmark->Args({size, static_cast<int64_t>(KeyDistribution::kUniform)});
+    benchmark->Args({size, static_cast<int64_t>(KeyDistribution::kClustered)});
+  }
+}
+
+void AllSizes(::benchmark::internal::Benchmark* benchmark) { TableArguments(benchmark, 8); }
+
+// GetRemovableNode assumes a table holding more than closest_nodes_size + group_size nodes.
+void LargeSizes(::benchmark::internal::Benchmark* benchmark) { TableArguments(benchmark, 64); }
+
+}  // unnamed namespace
+
+void BM_RoutingTableAddNode(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  while (state.KeepRunning()) {
+    if (!table.routing_table().AddNode(table.spare_node()))
+      state.SkipWithError("AddNode failed");
+    state.PauseTiming();
+    table.routing_table().DropNode(table.spare_node().node_id, true);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_RoutingTableAddNode)->Apply(AllSizes);
+
+void BM_RoutingTableDropNode(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    table.routing_table().AddNode(table.spare_node());
+    state.ResumeTiming();
+    if (table.routing_table().DropNode(table.spare_node().node_id, true).node_id.IsZero())
+      state.SkipWithError("DropNode failed");
+  }
+}
+BENCHMARK(BM_RoutingTableDropNode)->Apply(AllSizes);
+
+void BM_RoutingTableGetClosestNode(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  size_t index(0);
+  while (state.KeepRunning())
+    ::benchmark::DoNotOptimize(table.routing_table().GetClosestNode(table.target(index++)));
+}
+BENCHMARK(BM_RoutingTableGetClosestNode)->Apply(AllSizes);
+
+void BM_RoutingTableGetNodeForSendingMessage(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  const std::vector<std::vector<std::string>> kExclusions(table.Exclusions());
+  size_t index(0);
+  while (state.KeepRunning()) {
+    ::benchmark::DoNotOptimize(table.routing_table().GetNodeForSendingMessage(
+        table.target(index), kExclusions[index % kExclusions.size()]));
+    ++index;
+  }
+}
+BENCHMARK(BM_RoutingTableGetNodeForSendingMessage)->Apply(AllSizes);
+
+void BM_RoutingTableIsThisNodeInRange(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  size_t index(0);
+  while (state.KeepRunning()) {
+    ::benchmark::DoNotOptimize(table.routing_table().IsThisNodeInRange(
+        table.target(index++), Parameters::closest_nodes_size));
+  }
+}
+BENCHMARK(BM_RoutingTableIsThisNodeInRange)->Apply(AllSizes);
+
+void BM_RoutingTableGetRemovableNode(::benchmark::State& state) {
+  PopulatedRoutingTable table(state);
+  while (state.KeepRunning())
+    ::benchmark::DoNotOptimize(table.routing_table().GetRemovableNode());
+}
+BENCHMARK(BM_RoutingTableGetRemovableNode)->Apply(LargeSizes);
+
+void BM_ClientRoutingTableAddNode(::benchmark::State& state) {
+  PopulatedClientRoutingTable table(state);
+  while (state.KeepRunning()) {
+    if (!table.client_routing_table().AddNode(table.spare_node(), table.furthest_close_node_id()))
+      state.SkipWithError("AddNode failed");
+    state.PauseTiming();
+    table.client_routing_table().DropConnection(table.spare_node().connection_id);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_ClientRoutingTableAddNode)->Apply(AllSizes);
+
+void BM_ClientRoutingTableGetNodesInfo(::benchmark::State& state) {
+  PopulatedClientRoutingTable table(state);
+  size_t index(0);
+  while (state.KeepRunning())
+    ::benchmark::DoNotOptimize(table.client_routing_table().GetNodesInfo(table.node_id(index++)));
+}
+BENCHMARK(BM_ClientRoutingTableGetNodesInfo)->Apply(AllSizes);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
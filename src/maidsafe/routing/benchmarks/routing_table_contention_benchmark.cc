@@ -0,0 +1,326 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/benchmarks/benchmark_utils.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const size_t kTableSize(64);
+const size_t kTargetCount(1024);
+// Nodes which each writer repeatedly adds to and drops from the table.
+const size_t kChurnNodesPerWriter(4);
+const size_t kMaxWriterCount(4);
+
+// (bucket upper bound in nanoseconds, sample count) pairs, in ascending order of bucket.
+typedef std::map<uint64_t, uint64_t> NanosecondBuckets;
+
+// A read takes well under the microsecond resolution of LatencyHistogram, so each reader records
+// into one of these instead: the same log-linear buckets, but of nanoseconds.  Only written by its
+// own reader thread, and only read once all readers have stopped.
+class NanosecondHistogram {
+ public:
+  NanosecondHistogram() : counts_() {}
+
+  void Record(const std::chrono::steady_clock::duration& duration) {
+    auto nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    ++counts_[BucketIndex(nanoseconds < 0 ? 0 : static_cast<uint64_t>(nanoseconds))];
+  }
+
+  void AddTo(NanosecondBuckets& buckets) const {
+    for (size_t i(0); i != kBucketCount; ++i) {
+      if (counts_[i] != 0)
+        buckets[BucketUpperBound(i)] += counts_[i];
+    }
+  }
+
+ private:
+  static const size_t kSubBucketBits = 4;
+  static const size_t kSubBucketCount = 1 << kSubBucketBits;
+  static const size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+  NanosecondHistogram(const NanosecondHistogram&);
+  NanosecondHistogram(const NanosecondHistogram&&);
+  NanosecondHistogram& operator=(const NanosecondHistogram&);
+
+  static size_t BucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < kSubBucketCount)
+      return static_cast<size_t>(nanoseconds);
+    size_t most_significant_bit(kSubBucketBits);
+    while (nanoseconds >> (most_significant_bit + 1))
+      ++most_significant_bit;
+    size_t shift(most_significant_bit - kSubBucketBits);
+    return (shift + 1) * kSubBucketCount +
+           static_cast<size_t>((nanoseconds >> shift) - kSubBucketCount);
+  }
+
+  static uint64_t BucketUpperBound(size_t index) {
+    if (index < kSubBucketCount)
+      return index;
+    size_t shift(index / kSubBucketCount - 1);
+    uint64_t lower_bound(static_cast<uint64_t>(kSubBucketCount + index % kSubBucketCount) << shift);
+    return lower_bound + ((static_cast<uint64_t>(1) << shift) - 1);
+  }
+
+  std::array<uint64_t, kBucketCount> counts_;
+};
+
+double NanosecondPercentile(const NanosecondBuckets& buckets, double percentile) {
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  if (total == 0)
+    return 0.0;
+  uint64_t rank(static_cast<uint64_t>(std::ceil(total * percentile / 100.0)));
+  uint64_t seen(0);
+  for (const auto& bucket : buckets) {
+    seen += bucket.second;
+    if (seen >= rank)
+      return static_cast<double>(bucket.first);
+  }
+  return static_cast<double>(buckets.rbegin()->first);
+}
+
+double Microseconds(const std::chrono::microseconds& duration) {
+  return static_cast<double>(duration.count());
+}
+
+// A routing table holding kTableSize nodes, shared by all reader threads of one benchmark run.
+// Each of 'writer_count' writer threads cycles through adding one of its churn nodes, updating the
+// group matrix row of one of the closest peers, dropping the churn node and updating the row again,
+// at 'writes_per_second' (or as fast as possible if zero).  Writers run until StopWriters.
+class ContendedRoutingTable {
+ public:
+  ContendedRoutingTable(size_t reader_count, size_t writer_count, int64_t writes_per_second)
+      : max_size_(Parameters::max_routing_table_size,
+                  static_cast<uint16_t>(kTableSize + kMaxWriterCount * kChurnNodesPerWriter)),
+        own_id_(NodeId::kRandomId),
+        network_statistics_(own_id_),
+        routing_table_(false, own_id_, asymm::GenerateKeyPair(), network_statistics_),
+        nodes_(MakeBenchmarkNodes(kTableSize + writer_count * kChurnNodesPerWriter, own_id_,
+                                  KeyDistribution::kUniform)),
+        targets_(),
+        kNoExclusions_(),
+        reader_latencies_(),
+        writer_latency_(),
+        writes_(0),
+        stop_(false),
+        writers_() {
+    InitialiseNoOpFunctors(routing_table_);
+    for (size_t i(0); i != kTableSize; ++i)
+      routing_table_.AddNode(nodes_[i]);
+    for (size_t i(0); i != kTargetCount; ++i)
+      targets_.push_back(NodeId(NodeId::kRandomId));
+    for (size_t i(0); i != reader_count; ++i)
+      reader_latencies_.push_back(std::unique_ptr<NanosecondHistogram>(new NanosecondHistogram));
+    for (size_t i(0); i != writer_count; ++i)
+      writers_.push_back(std::thread([this, i, writes_per_second] {
+        Churn(i, writes_per_second);
+      }));
+  }
+
+  ~ContendedRoutingTable() { StopWriters(); }
+
+  void StopWriters() {
+    stop_ = true;
+    for (auto& writer : writers_) {
+      if (writer.joinable())
+        writer.join();
+    }
+  }
+
+  // Issues one of the three reads, chosen by 'index', and records its latency against 'reader'.
+  void Read(size_t reader, size_t index) {
+    const NodeId& target(targets_[index % kTargetCount]);
+    auto start(std::chrono::steady_clock::now());
+    switch (index % 3) {
+      case 0:
+        ::benchmark::DoNotOptimize(routing_table_.GetNodeForSendingMessage(target, kNoExclusions_));
+        break;
+      case 1:
+        ::benchmark::DoNotOptimize(
+            routing_table_.IsThisNodeInRange(target, Parameters::closest_nodes_size));
+        break;
+      default:
+        ::benchmark::DoNotOptimize(routing_table_.IsNodeIdInGroupRange(target));
+        break;
+    }
+    reader_latencies_[reader]->Record(std::chrono::steady_clock::now() - start);
+  }
+
+  NanosecondBuckets ReaderLatency() const {
+    NanosecondBuckets buckets;
+    for (const auto& latency : reader_latencies_)
+      latency->AddTo(buckets);
+    return buckets;
+  }
+
+  LatencyBuckets WriterLatency() const { return writer_latency_.Buckets(); }
+  uint64_t writes() const { return writes_; }
+
+ private:
+  ContendedRoutingTable(const ContendedRoutingTable&);
+  ContendedRoutingTable(const ContendedRoutingTable&&);
+  ContendedRoutingTable& operator=(const ContendedRoutingTable&);
+
+  void Churn(size_t writer, int64_t writes_per_second) {
+    const NodeInfo& peer(nodes_[ClosestPeerIndex(writer)]);
+    std::vector<NodeInfo> rows[2] = { PeerRow(peer), PeerRow(peer) };
+    rows[1].pop_back();
+    std::chrono::steady_clock::duration interval(std::chrono::steady_clock::duration::zero());
+    if (writes_per_second > 0)
+      interval = std::chrono::steady_clock::duration(std::chrono::seconds(1)) / writes_per_second;
+    auto next_write(std::chrono::steady_clock::now());
+    for (size_t index(0); !stop_; ++index) {
+      const NodeInfo& churn_node(
+          nodes_[kTableSize + writer * kChurnNodesPerWriter + (index / 4) % kChurnNodesPerWriter]);
+      auto start(std::chrono::steady_clock::now());
+      switch (index % 4) {
+        case 0:
+          routing_table_.AddNode(churn_node);
+          break;
+        case 2:
+          routing_table_.DropNode(churn_node.node_id, true);
+          break;
+        default:
+          routing_table_.GroupUpdateFromConnectedPeer(peer.node_id, rows[(index / 2) % 2]);
+          break;
+      }
+      writer_latency_.Record(std::chrono::steady_clock::now() - start);
+      ++writes_;
+      if (interval != std::chrono::steady_clock::duration::zero()) {
+        next_write += interval;
+        std::this_thread::sleep_until(next_write);
+      }
+    }
+  }
+
+  // Writers update the rows of different peers from among this node's closest.
+  size_t ClosestPeerIndex(size_t writer) const {
+    std::vector<size_t> indices;
+    for (size_t i(0); i != kTableSize; ++i)
+      indices.push_back(i);
+    std::sort(std::begin(indices), std::end(indices), [this](size_t lhs, size_t rhs) {
+      return NodeId::CloserToTarget(nodes_[lhs].node_id, nodes_[rhs].node_id, own_id_);
+    });
+    return indices[writer % Parameters::closest_nodes_size];
+  }
+
+  // The peer's closest_nodes_size closest nodes from the table, as it would report them.
+  std::vector<NodeInfo> PeerRow(const NodeInfo& peer) const {
+    std::vector<NodeInfo> row;
+    std::copy_if(std::begin(nodes_), std::begin(nodes_) + kTableSize, std::back_inserter(row),
+                 [&peer](const NodeInfo& node) { return node.node_id != peer.node_id; });
+    std::sort(std::begin(row), std::end(row), [&peer](const NodeInfo& lhs, const NodeInfo& rhs) {
+      return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, peer.node_id);
+    });
+    row.resize(Parameters::closest_nodes_size);
+    return row;
+  }
+
+  ScopedParameter<uint16_t> max_size_;
+  const NodeId own_id_;
+  NetworkStatistics network_statistics_;
+  RoutingTable routing_table_;
+  const std::vector<NodeInfo> nodes_;
+  std::vector<NodeId> targets_;
+  const std::vector<std::string> kNoExclusions_;
+  std::vector<std::unique_ptr<NanosecondHistogram>> reader_latencies_;
+  LatencyHistogram writer_latency_;
+  std::atomic<uint64_t> writes_;
+  std::atomic<bool> stop_;
+  std::vector<std::thread> writers_;
+};
+
+// Created by the first reader thread before timing starts, and destroyed by it once all readers
+// have stopped.
+std::unique_ptr<ContendedRoutingTable> contended_table;
+
+// Arguments are {writers, writes_per_second}, the rate being per writer and zero meaning
+// unthrottled.  Reader threads scale from 1 to 16.
+void ContentionArguments(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"writers", "writes_per_second"});
+  for (int64_t writers(1); writers <= static_cast<int64_t>(kMaxWriterCount); writers *= 2) {
+    for (int64_t rate : {100, 1000, 0})
+      benchmark->Args({writers, rate});
+  }
+  benchmark->ThreadRange(1, 16)->UseRealTime();
+}
+
+}  // unnamed namespace
+
+// Reports reader throughput as items_per_second, reader latency percentiles in nanoseconds and
+// writer latency percentiles in microseconds.  Each read's latency includes two steady_clock reads.
+void BM_RoutingTableContention(::benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    contended_table.reset(new ContendedRoutingTable(static_cast<size_t>(state.threads()),
+                                                    static_cast<size_t>(state.range(0)),
+                                                    state.range(1)));
+  }
+  const size_t kReader(static_cast<size_t>(state.thread_index()));
+  size_t index(kReader * kTargetCount / static_cast<size_t>(state.threads()));
+  while (state.KeepRunning())
+    contended_table->Read(kReader, index++);
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    contended_table->StopWriters();
+    NanosecondBuckets reader_latency(contended_table->ReaderLatency());
+    LatencyBuckets writer_latency(contended_table->WriterLatency());
+    state.counters["reader_p50_ns"] = NanosecondPercentile(reader_latency, 50);
+    state.counters["reader_p99_ns"] = NanosecondPercentile(reader_latency, 99);
+    state.counters["writer_p50_us"] = Microseconds(LatencyPercentile(writer_latency, 50));
+    state.counters["writer_p99_us"] = Microseconds(LatencyPercentile(writer_latency, 99));
+    state.counters["writes"] = static_cast<double>(contended_table->writes());
+    contended_table.reset();
+  }
+}
+BENCHMARK(BM_RoutingTableContention)->Apply(ContentionArguments);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,319 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/address.hpp"
+#include "boost/asio/ip/udp.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/rpcs.h"
+#include "maidsafe/routing/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+// rpcs::ProxyConnect is declared but has no definition, so isn't covered.
+enum class Rpc {
+  kPing,
+  kConnect,
+  kRemove,
+  kFindNodes,
+  kConnectSuccess,
+  kConnectSuccessAcknowledgement,
+  kClosestNodesUpdate,
+  kGetGroup
+};
+
+// The IDs and endpoints a vault would use when sending an RPC to a peer.
+struct RpcFixture {
+  RpcFixture()
+      : peer_id(NodeId::kRandomId),
+        this_node_id(NodeId::kRandomId),
+        endpoint_pair(),
+        close_ids(),
+        closest_nodes(),
+        attempted_nodes(),
+        route_history(),
+        last_id(NodeId(NodeId::kRandomId).string()) {
+    endpoint_pair.local = boost::asio::ip::udp::endpoint(
+        boost::asio::ip::address::from_string("192.168.1.10"), 5483);
+    endpoint_pair.external = boost::asio::ip::udp::endpoint(
+        boost::asio::ip::address::from_string("203.0.113.10"), 5483);
+    for (uint16_t i(0); i != Parameters::closest_nodes_size; ++i) {
+      close_ids.push_back(NodeId(NodeId::kRandomId));
+      NodeInfo node_info;
+      node_info.node_id = close_ids.back();
+      node_info.rank = static_cast<int32_t>(i);
+      closest_nodes.push_back(node_info);
+    }
+    for (uint16_t i(0); i != Parameters::max_route_history; ++i) {
+      attempted_nodes.push_back(NodeId(NodeId::kRandomId).string());
+      route_history.push_back(NodeId(NodeId::kRandomId).string());
+    }
+  }
+
+  protobuf::Message Build(Rpc rpc) const {
+    switch (rpc) {
+      case Rpc::kPing:
+        return rpcs::Ping(peer_id, this_node_id.string());
+      case Rpc::kConnect:
+        return rpcs::Connect(peer_id, endpoint_pair, this_node_id, this_node_id);
+      case Rpc::kRemove:
+        return rpcs::Remove(peer_id, this_node_id, this_node_id, attempted_nodes);
+      case Rpc::kFindNodes:
+        return rpcs::FindNodes(peer_id, this_node_id, Parameters::closest_nodes_size);
+      case Rpc::kConnectSuccess:
+        return rpcs::ConnectSuccess(peer_id, this_node_id, this_node_id, true, false);
+      case Rpc::kConnectSuccessAcknowledgement:
+        return rpcs::ConnectSuccessAcknowledgement(peer_id, this_node_id, this_node_id, true,
+                                                   close_ids, false);
+      case Rpc::kClosestNodesUpdate:
+        return rpcs::ClosestNodesUpdate(peer_id, this_node_id, closest_nodes);
+      case Rpc::kGetGroup:
+        return rpcs::GetGroup(peer_id, this_node_id);
+    }
+    return protobuf::Message();
+  }
+
+  // Tops the route history up to 'length' entries, as NetworkUtils::AdjustRouteHistory leaves it
+  // after that many forwarding nodes.  FindNodes starts with its sender already in the history.
+  void AddRouteHistory(size_t length, protobuf::Message& message) const {
+    for (size_t i(message.route_history_size()); i < length; ++i)
+      message.add_route_history(route_history[i % route_history.size()]);
+    message.set_last_id(last_id);
+  }
+
+  const NodeId peer_id, this_node_id;
+  rudp::EndpointPair endpoint_pair;
+  std::vector<NodeId> close_ids;
+  std::vector<NodeInfo> closest_nodes;
+  std::vector<std::string> attempted_nodes, route_history;
+  const std::string last_id;
+
+ private:
+  RpcFixture(const RpcFixture&);
+  RpcFixture(const RpcFixture&&);
+  RpcFixture& operator=(const RpcFixture&);
+};
+
+// As Routing::Impl::CreateNodeLevelPartialMessage builds for a direct SendDirect, once sent.
+protobuf::Message MakeNodeLevelMessage(const RpcFixture& fixture, const std::string& data) {
+  protobuf::Message message;
+  message.set_destination_id(fixture.peer_id.string());
+  message.set_source_id(fixture.this_node_id.string());
+  message.set_routing_message(false);
+  message.add_data(data);
+  message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+  message.set_direct(true);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_replication(1);
+  message.set_id(RandomUint32() % 10000);
+  return message;
+}
+
+template <typename Payload>
+bool ParsePayload(const protobuf::Message& message) {
+  Payload payload;
+  return message.data_size() == 1 && payload.ParseFromString(message.data(0));
+}
+
+// Parses the message and then its RPC-specific payload, as Service or ResponseHandler would.
+bool Parse(Rpc rpc, const std::string& serialised_message, protobuf::Message& message) {
+  if (!message.ParseFromString(serialised_message))
+    return false;
+  switch (rpc) {
+    case Rpc::kPing:
+      return ParsePayload<protobuf::PingRequest>(message);
+    case Rpc::kConnect:
+      return ParsePayload<protobuf::ConnectRequest>(message);
+    case Rpc::kRemove:
+      return ParsePayload<protobuf::RemoveRequest>(message);
+    case Rpc::kFindNodes:
+      return ParsePayload<protobuf::FindNodesRequest>(message);
+    case Rpc::kConnectSuccess:
+      return ParsePayload<protobuf::ConnectSuccess>(message);
+    case Rpc::kConnectSuccessAcknowledgement:
+      return ParsePayload<protobuf::ConnectSuccessAcknowledgement>(message);
+    case Rpc::kClosestNodesUpdate:
+      return ParsePayload<protobuf::ClosestNodesUpdate>(message);
+    case Rpc::kGetGroup:
+      return ParsePayload<protobuf::GetGroup>(message);
+  }
+  return false;
+}
+
+// Route history lengths: none, one entry, and as many as NetworkUtils keeps.
+void RouteHistoryLengths(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("route_history");
+  benchmark->Arg(0)->Arg(1)->Arg(Parameters::max_route_history);
+}
+
+void RouteHistoryAndPayloadSizes(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"route_history", "payload"});
+  for (int payload_size : {256, 4096, 65536}) {
+    for (int length : {0, 1, static_cast<int>(Parameters::max_route_history)})
+      benchmark->Args({length, payload_size});
+  }
+}
+
+// Reports the serialised size of 'message', and how much of that its route history accounts for.
+void ReportWireBytes(::benchmark::State& state, const protobuf::Message& message) {
+  protobuf::Message without_history(message);
+  without_history.clear_route_history();
+  state.counters["wire_bytes"] = static_cast<double>(message.ByteSize());
+  state.counters["route_history_bytes"] =
+      static_cast<double>(message.ByteSize() - without_history.ByteSize());
+}
+
+}  // unnamed namespace
+
+// Reports RPCs built per second as items_per_second.
+void BM_RpcBuild(::benchmark::State& state, Rpc rpc) {
+  RpcFixture fixture;
+  while (state.KeepRunning())
+    ::benchmark::DoNotOptimize(fixture.Build(rpc));
+  state.SetItemsProcessed(state.iterations());
+  ReportWireBytes(state, fixture.Build(rpc));
+}
+
+// Reports RPCs serialised per second as items_per_second, and the size on the wire.
+void BM_RpcSerialise(::benchmark::State& state, Rpc rpc) {
+  RpcFixture fixture;
+  protobuf::Message message(fixture.Build(rpc));
+  fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+  std::string serialised_message;
+  while (state.KeepRunning()) {
+    message.SerializeToString(&serialised_message);
+    ::benchmark::DoNotOptimize(serialised_message.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * message.ByteSize());
+  ReportWireBytes(state, message);
+}
+
+// Reports RPCs parsed per second as items_per_second, including their RPC-specific payload.
+void BM_RpcParse(::benchmark::State& state, Rpc rpc) {
+  RpcFixture fixture;
+  protobuf::Message message(fixture.Build(rpc));
+  fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+  const std::string kSerialisedMessage(message.SerializeAsString());
+  protobuf::Message parsed_message;
+  while (state.KeepRunning()) {
+    if (!Parse(rpc, kSerialisedMessage, parsed_message)) {
+      state.SkipWithError("Failed to parse message");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kSerialisedMessage.size()));
+  ReportWireBytes(state, message);
+}
+
+#define MAIDSAFE_ROUTING_RPC_BENCHMARKS(name)                                          \
+  BENCHMARK_CAPTURE(BM_RpcBuild, name, Rpc::k##name);                                  \
+  BENCHMARK_CAPTURE(BM_RpcSerialise, name, Rpc::k##name)->Apply(RouteHistoryLengths); \
+  BENCHMARK_CAPTURE(BM_RpcParse, name, Rpc::k##name)->Apply(RouteHistoryLengths)
+
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(Ping);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(Connect);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(Remove);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(FindNodes);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(ConnectSuccess);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(ConnectSuccessAcknowledgement);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(ClosestNodesUpdate);
+MAIDSAFE_ROUTING_RPC_BENCHMARKS(GetGroup);
+
+#undef MAIDSAFE_ROUTING_RPC_BENCHMARKS
+
+// The node-level Message wrapper around upper-layer data, as sent by SendDirect.  Building covers
+// copying the payload in.
+void BM_MessageWrapperBuild(::benchmark::State& state) {
+  RpcFixture fixture;
+  const std::string kData(RandomString(static_cast<size_t>(state.range(1))));
+  while (state.KeepRunning()) {
+    protobuf::Message message(MakeNodeLevelMessage(fixture, kData));
+    fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+    ::benchmark::DoNotOptimize(message);
+  }
+  state.SetItemsProcessed(state.iterations());
+  protobuf::Message message(MakeNodeLevelMessage(fixture, kData));
+  fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+  ReportWireBytes(state, message);
+}
+BENCHMARK(BM_MessageWrapperBuild)->Apply(RouteHistoryAndPayloadSizes);
+
+void BM_MessageWrapperSerialise(::benchmark::State& state) {
+  RpcFixture fixture;
+  protobuf::Message message(
+      MakeNodeLevelMessage(fixture, RandomString(static_cast<size_t>(state.range(1)))));
+  fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+  std::string serialised_message;
+  while (state.KeepRunning()) {
+    message.SerializeToString(&serialised_message);
+    ::benchmark::DoNotOptimize(serialised_message.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * message.ByteSize());
+  ReportWireBytes(state, message);
+}
+BENCHMARK(BM_MessageWrapperSerialise)->Apply(RouteHistoryAndPayloadSizes);
+
+void BM_MessageWrapperParse(::benchmark::State& state) {
+  RpcFixture fixture;
+  protobuf::Message message(
+      MakeNodeLevelMessage(fixture, RandomString(static_cast<size_t>(state.range(1)))));
+  fixture.AddRouteHistory(static_cast<size_t>(state.range(0)), message);
+  const std::string kSerialisedMessage(message.SerializeAsString());
+  protobuf::Message parsed_message;
+  while (state.KeepRunning()) {
+    if (!parsed_message.ParseFromString(kSerialisedMessage)) {
+      state.SkipWithError("Failed to parse message");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kSerialisedMessage.size()));
+  ReportWireBytes(state, message);
+}
+BENCHMARK(BM_MessageWrapperParse)->Apply(RouteHistoryAndPayloadSizes);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,217 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/asio_service.h"
+
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/timer.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+typedef Timer<std::string> StringTimer;
+
+const uint32_t kAsioThreadCount(4);
+// Long enough that background tasks never time out during a run.
+const std::chrono::hours kBackgroundTimeout(1);
+const std::chrono::milliseconds kShortTimeout(5);
+
+double Microseconds(const std::chrono::microseconds& duration) {
+  return static_cast<double>(duration.count());
+}
+
+double Seconds(const std::chrono::steady_clock::duration& duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+}
+
+// A Timer holding 'outstanding' background tasks, none of which time out during the run.  The
+// Timer is destroyed before the AsioService, as its destructor waits for all tasks to finish.
+class LoadedTimer {
+ public:
+  LoadedTimer(int64_t outstanding, uint32_t asio_thread_count)
+      : asio_service_(asio_thread_count),
+        timer_(new StringTimer(asio_service_)),
+        kFunctor_([](std::string) {}),
+        task_ids_() {
+    for (int64_t i(0); i != outstanding; ++i)
+      task_ids_.push_back(AddTask());
+  }
+
+  ~LoadedTimer() {
+    timer_.reset();
+    asio_service_.Stop();
+  }
+
+  // Adds a task expecting one response.
+  TaskId AddTask() {
+    TaskId task_id(timer_->NewTaskId());
+    timer_->AddTask(kBackgroundTimeout, kFunctor_, 1, task_id);
+    return task_id;
+  }
+
+  StringTimer& timer() { return *timer_; }
+  // The IDs of the background tasks, each of which a benchmark may replace.
+  std::vector<TaskId>& task_ids() { return task_ids_; }
+
+ private:
+  LoadedTimer(const LoadedTimer&);
+  LoadedTimer(const LoadedTimer&&);
+  LoadedTimer& operator=(const LoadedTimer&);
+
+  AsioService asio_service_;
+  std::unique_ptr<StringTimer> timer_;
+  const StringTimer::ResponseFunctor kFunctor_;
+  std::vector<TaskId> task_ids_;
+};
+
+// Arguments are {outstanding}, from 10^2 to 10^6 tasks.
+void OutstandingTasks(::benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"outstanding"});
+  for (int64_t outstanding(100); outstanding <= 1000000; outstanding *= 10)
+    benchmark->Args({outstanding});
+  benchmark->UseManualTime();
+}
+
+// Applies 'timed' then 'untimed' to each background task in turn, where between them they replace
+// the task, so that the number outstanding stays at range(0).  Manual timing avoids PauseTiming's
+// overhead, which would exceed the cost of the operations themselves.
+template <typename Timed, typename Untimed>
+void TimeEachTask(::benchmark::State& state, Timed timed, Untimed untimed) {
+  LoadedTimer timer(state.range(0), kAsioThreadCount);
+  size_t index(0);
+  while (state.KeepRunning()) {
+    TaskId& task_id(timer.task_ids()[index++ % timer.task_ids().size()]);
+    auto start(std::chrono::steady_clock::now());
+    TaskId new_task_id(timed(timer, task_id));
+    state.SetIterationTime(Seconds(std::chrono::steady_clock::now() - start));
+    task_id = untimed(timer, task_id, new_task_id);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Created by the first producer thread before timing starts, and destroyed by it once all
+// producers have stopped.
+std::unique_ptr<LoadedTimer> shared_timer;
+
+}  // unnamed namespace
+
+void BM_TimerAddTask(::benchmark::State& state) {
+  TimeEachTask(state,
+               [](LoadedTimer& timer, TaskId) { return timer.AddTask(); },
+               [](LoadedTimer& timer, TaskId task_id, TaskId new_task_id) {
+                 timer.timer().CancelTask(task_id);
+                 return new_task_id;
+               });
+}
+BENCHMARK(BM_TimerAddTask)->Apply(OutstandingTasks);
+
+void BM_TimerAddResponse(::benchmark::State& state) {
+  TimeEachTask(state,
+               [](LoadedTimer& timer, TaskId task_id) {
+                 timer.timer().AddResponse(task_id, "response");
+                 return task_id;
+               },
+               [](LoadedTimer& timer, TaskId, TaskId) { return timer.AddTask(); });
+}
+BENCHMARK(BM_TimerAddResponse)->Apply(OutstandingTasks);
+
+void BM_TimerCancelTask(::benchmark::State& state) {
+  TimeEachTask(state,
+               [](LoadedTimer& timer, TaskId task_id) {
+                 timer.timer().CancelTask(task_id);
+                 return task_id;
+               },
+               [](LoadedTimer& timer, TaskId, TaskId) { return timer.AddTask(); });
+}
+BENCHMARK(BM_TimerCancelTask)->Apply(OutstandingTasks);
+
+// Each iteration adds a task with a short timeout and waits for its functor to be invoked on
+// timing out.  Reports how late the functor ran, past the task's deadline, as percentiles in
+// microseconds.
+void BM_TimerTimeoutAccuracy(::benchmark::State& state) {
+  LoadedTimer timer(state.range(0), kAsioThreadCount);
+  LatencyHistogram lateness;
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  bool fired(false);
+  std::chrono::steady_clock::time_point fired_time;
+  while (state.KeepRunning()) {
+    TaskId task_id(timer.timer().NewTaskId());
+    auto deadline(std::chrono::steady_clock::now() + kShortTimeout);
+    timer.timer().AddTask(kShortTimeout, [&](std::string) {
+      std::lock_guard<std::mutex> lock(mutex);
+      fired_time = std::chrono::steady_clock::now();
+      fired = true;
+      cond_var.notify_one();
+    }, 1, task_id);
+    std::unique_lock<std::mutex> lock(mutex);
+    cond_var.wait(lock, [&fired] { return fired; });
+    fired = false;
+    lateness.Record(fired_time - deadline);
+  }
+  LatencyBuckets buckets(lateness.Buckets());
+  state.counters["lateness_p50_us"] = Microseconds(LatencyPercentile(buckets, 50));
+  state.counters["lateness_p99_us"] = Microseconds(LatencyPercentile(buckets, 99));
+  state.counters["lateness_max_us"] = Microseconds(LatencyPercentile(buckets, 100));
+}
+BENCHMARK(BM_TimerTimeoutAccuracy)
+    ->ArgName("outstanding")
+    ->RangeMultiplier(100)
+    ->Range(100, 1000000)
+    ->UseRealTime();
+
+// Producer threads, scaling from 1 to 16, each repeatedly add a task to one shared Timer and
+// respond to it.  Arguments are {asio_threads}, the number of threads running the shared
+// AsioService, which completes the tasks and runs their functors.
+void BM_TimerProducers(::benchmark::State& state) {
+  if (state.thread_index() == 0)
+    shared_timer.reset(new LoadedTimer(0, static_cast<uint32_t>(state.range(0))));
+  while (state.KeepRunning())
+    shared_timer->timer().AddResponse(shared_timer->AddTask(), "response");
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0)
+    shared_timer.reset();
+}
+BENCHMARK(BM_TimerProducers)
+    ->ArgName("asio_threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -18,6 +18,11 @@
 
 #include "maidsafe/routing/cache_manager.h"
 
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+#include "maidsafe/routing/message.h"
 #include "maidsafe/routing/network_utils.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -27,11 +32,48 @@ namespace maidsafe {
 
 namespace routing {
 
-CacheManager::CacheManager(NodeId node_id, NetworkUtils& network)
+CacheManager::CacheManager(NodeId node_id, NetworkUtils& network, Scheduler& scheduler)
+    : CacheManager(std::move(node_id), network, scheduler, Parameters::response_cache_size) {}
+
+CacheManager::CacheManager(NodeId node_id, NetworkUtils& network, Scheduler& scheduler,
+                           uint64_t max_cache_bytes)
     : kNodeId_(std::move(node_id)),
       network_(network),
+      scheduler_(scheduler),
       message_received_functor_(),
-      store_cache_data_() {}
+      store_cache_data_(),
+      response_cache_(max_cache_bytes),
+      persistent_cache_store_(),
+      lookups_mutex_(),
+      in_flight_lookups_(),
+      pending_lookups_(),
+      expiry_alarm_(scheduler_.MakeAlarm()),
+      expiry_alarm_set_(false),
+      pending_stores_(0),
+      stopped_(false),
+      store_service_(1) {
+  if (!Parameters::persistent_cache_directory.empty()) {
+    persistent_cache_store_.reset(new PersistentCacheStore(
+        Parameters::persistent_cache_directory /
+            ("routing_cache_" + kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex)),
+        Parameters::persistent_cache_size));
+    // Indexing a large file takes a while, so it's done on the store worker rather than delaying
+    // startup.  Stores queued meanwhile run once it has finished.
+    PersistentCacheStore* persistent_cache_store(persistent_cache_store_.get());
+    store_service_.service().post([=] {
+      if (!stopped_)
+        persistent_cache_store->Load();
+    });
+  }
+}
+
+CacheManager::~CacheManager() { Stop(); }
+
+void CacheManager::Stop() {
+  stopped_ = true;
+  std::lock_guard<std::mutex> lock(lookups_mutex_);
+  expiry_alarm_.reset();
+}
 
 void CacheManager::InitialiseFunctors(MessageReceivedFunctor message_received_functor,
                                       StoreCacheDataFunctor store_cache_data) {
@@ -43,59 +85,236 @@ void CacheManager::InitialiseFunctors(MessageReceivedFunctor message_received_fu
 
 void CacheManager::AddToCache(const protobuf::Message& message) {
   assert(!message.request());
-  if (store_cache_data_)
-    store_cache_data_(message.data(0));
+  std::string key;
+  if (message.has_id()) {
+    {
+      std::lock_guard<std::mutex> lock(lookups_mutex_);
+      auto itr(pending_lookups_.find(RequestId(message.destination_id(), message.id())));
+      if (itr != std::end(pending_lookups_))
+        key = itr->second;
+    }
+    if (!key.empty() && (message.data_size() == 0 || message.data(0).empty())) {
+      // Nothing to answer the parked requests with, or to cache.
+      return FailLookup(key);
+    }
+    if (!key.empty())
+      CompleteLookup(key, message.data(0));
+  }
+
+  if (pending_stores_.fetch_add(1) >= Parameters::max_pending_cache_stores) {
+    --pending_stores_;
+    LOG(kWarning) << "Cache store queue full, dropping response with id " << message.id();
+    return;
+  }
+  // Only responses to lookups this node passed on are cached ('key' is empty for others), so a peer
+  // can't seed the caches with responses to requests nobody made.
+  std::string response(message.data(0));
+  store_service_.service().post([=] {
+    if (stopped_)
+      return;
+    try {
+      StoreResponse(key, response);
+    }
+    catch (const std::exception& ex) {
+      LOG(kError) << "Failed to store cacheable response: " << ex.what();
+    }
+    --pending_stores_;
+  });
 }
-// FIXME(Prakash)
+
 void CacheManager::HandleGetFromCache(protobuf::Message& message) {
   assert(IsRequest(message));
   assert(IsCacheableGet(message));
   assert(kNodeId_.string() != message.source_id());
   assert(kNodeId_.string() != message.destination_id());
-  if (message_received_functor_) {
-    if (IsRequest(message)) {
-      LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(message)
-                    << " from " << HexSubstr(message.source_id()) << "   (id: " << message.id()
-                    << ")  --NodeLevel-- caching";
-      ReplyFunctor response_functor = [=](const std::string & reply_message) {
-        if (reply_message.empty()) {
-          LOG(kVerbose) << "No cache available, passing on the original request";
-          return network_.SendToClosestNode(message);
-        }
-
-        //  Responding with cached response
-        protobuf::Message message_out;
-        message_out.set_request(false);
-        message_out.set_hops_to_live(Parameters::hops_to_live);
-        message_out.set_destination_id(message.source_id());
-        message_out.set_type(message.type());
-        message_out.set_direct(true);
-        message_out.clear_data();
-        message_out.set_client_node(message.client_node());
-        message_out.set_routing_message(message.routing_message());
-        message_out.add_data(reply_message);
-        message_out.set_last_id(kNodeId_.string());
-        message_out.set_source_id(kNodeId_.string());
-        if (message.has_cacheable())
-          message_out.set_cacheable(message.cacheable());
-        if (message.has_id())
-          message_out.set_id(message.id());
-        else
-          LOG(kInfo) << "Message to be sent back had no ID.";
-
-        if (message.has_relay_id())
-          message_out.set_relay_id(message.relay_id());
-
-        if (message.has_relay_connection_id()) {
-          message_out.set_relay_connection_id(message.relay_connection_id());
-        }
-        network_.SendToClosestNode(message_out);
-      };
-
-      if (message_received_functor_)
-        message_received_functor_(message.data(0), true, response_functor);
+  std::string key(ResponseCache::Key(message.type(), message.destination_id(), message.data(0)));
+  std::string cached_response;
+  if (response_cache_.Get(key, cached_response)) {
+    LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(message)
+                  << " from " << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                  << ")  --NodeLevel-- answered from response cache";
+    return SendCachedResponse(message, cached_response);
+  }
+  protobuf::Message message_out;
+  if (persistent_cache_store_ &&
+      persistent_cache_store_->Get(key, [&](const char* response, size_t size) {
+        message_out = MakeCachedResponse(message, response, size);
+      })) {
+    LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(message)
+                  << " from " << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                  << ")  --NodeLevel-- answered from persistent cache";
+    return network_.SendToClosestNode(message_out);
+  }
+
+  if (ParkOrAddLookup(message, key)) {
+    LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(message)
+                  << " from " << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                  << ")  --NodeLevel-- parked behind identical request in flight";
+    return;
+  }
+  if (!message_received_functor_)
+    return network_.SendToClosestNode(message);
+
+  LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(message)
+                << " from " << HexSubstr(message.source_id()) << "   (id: " << message.id()
+                << ")  --NodeLevel-- caching";
+  ReplyFunctor response_functor = [=](const std::string & reply_message) {
+    if (reply_message.empty()) {
+      LOG(kVerbose) << "No cache available, passing on the original request";
+      return network_.SendToClosestNode(message);
+    }
+    SendCachedResponse(message, reply_message);
+    response_cache_.Add(key, reply_message);
+    CompleteLookup(key, reply_message);
+  };
+  message_received_functor_(message.data(0), true, response_functor);
+}
+
+void CacheManager::SendCachedResponse(const protobuf::Message& message,
+                                      const std::string& response) {
+  network_.SendToClosestNode(MakeCachedResponse(message, response.data(), response.size()));
+}
+
+protobuf::Message CacheManager::MakeCachedResponse(const protobuf::Message& message,
+                                                   const char* response, size_t size) {
+  protobuf::Message message_out;
+  message_out.set_request(false);
+  message_out.set_hops_to_live(Parameters::hops_to_live);
+  message_out.set_destination_id(message.source_id());
+  message_out.set_type(message.type());
+  message_out.set_direct(true);
+  message_out.clear_data();
+  message_out.set_client_node(message.client_node());
+  message_out.set_routing_message(message.routing_message());
+  message_out.add_data(response, size);
+  message_out.set_last_id(kNodeId_.string());
+  message_out.set_source_id(kNodeId_.string());
+  // Marked so that nodes on the way back to the requester can cache a copy too
+  message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
+  if (message.has_id())
+    message_out.set_id(message.id());
+  else
+    LOG(kInfo) << "Message to be sent back had no ID.";
+
+  if (message.has_relay_id())
+    message_out.set_relay_id(message.relay_id());
+
+  if (message.has_relay_connection_id()) {
+    message_out.set_relay_connection_id(message.relay_connection_id());
+  }
+  return message_out;
+}
+
+bool CacheManager::ParkOrAddLookup(const protobuf::Message& message, const std::string& key) {
+  if (!message.has_id())
+    return false;
+  std::lock_guard<std::mutex> lock(lookups_mutex_);
+  if (!expiry_alarm_)
+    return false;
+  auto itr(in_flight_lookups_.find(key));
+  if (itr != std::end(in_flight_lookups_)) {
+    if (itr->second.parked_requests.size() >= Parameters::max_parked_cache_requests)
+      return false;
+    itr->second.parked_requests.push_back(message);
+    return true;
+  }
+  if (in_flight_lookups_.size() >= Parameters::num_chunks_to_cache)
+    return false;
+  RequestId request_id(message.source_id(), message.id());
+  in_flight_lookups_.insert(std::make_pair(
+      key, InFlightLookup(request_id,
+                          scheduler_.Now() + Parameters::parked_cache_request_timeout)));
+  pending_lookups_[request_id] = key;
+  if (!expiry_alarm_set_)
+    SetExpiryAlarm();
+  return false;
+}
+
+void CacheManager::CompleteLookup(const std::string& key, const std::string& response) {
+  std::vector<protobuf::Message> parked_requests;
+  {
+    std::lock_guard<std::mutex> lock(lookups_mutex_);
+    auto itr(in_flight_lookups_.find(key));
+    if (itr == std::end(in_flight_lookups_))
+      return;
+    parked_requests.swap(itr->second.parked_requests);
+    pending_lookups_.erase(itr->second.request_id);
+    in_flight_lookups_.erase(itr);
+  }
+  if (!parked_requests.empty()) {
+    LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] answering " << parked_requests.size()
+                  << " parked requests from a single response";
+  }
+  for (const auto& parked_request : parked_requests)
+    SendCachedResponse(parked_request, response);
+}
+
+void CacheManager::FailLookup(const std::string& key) {
+  std::vector<protobuf::Message> parked_requests;
+  {
+    std::lock_guard<std::mutex> lock(lookups_mutex_);
+    auto itr(in_flight_lookups_.find(key));
+    if (itr == std::end(in_flight_lookups_))
+      return;
+    parked_requests.swap(itr->second.parked_requests);
+    pending_lookups_.erase(itr->second.request_id);
+    in_flight_lookups_.erase(itr);
+  }
+  if (!parked_requests.empty()) {
+    LOG(kVerbose) << " [" << DebugId(kNodeId_) << "] passing on " << parked_requests.size()
+                  << " requests parked behind a failed lookup";
+  }
+  for (const auto& parked_request : parked_requests)
+    network_.SendToClosestNode(parked_request);
+}
+
+void CacheManager::StoreResponse(const std::string& key, const std::string& response) {
+  if (!key.empty()) {
+    response_cache_.Add(key, response);
+    if (persistent_cache_store_)
+      persistent_cache_store_->Add(key, response);
+  }
+  if (store_cache_data_)
+    store_cache_data_(response);
+}
+
+void CacheManager::ReleaseExpiredLookups() {
+  std::vector<protobuf::Message> released_requests;
+  {
+    std::lock_guard<std::mutex> lock(lookups_mutex_);
+    expiry_alarm_set_ = false;
+    auto now(scheduler_.Now());
+    for (auto itr(std::begin(in_flight_lookups_)); itr != std::end(in_flight_lookups_);) {
+      if (itr->second.expiry_time <= now) {
+        std::move(std::begin(itr->second.parked_requests), std::end(itr->second.parked_requests),
+                  std::back_inserter(released_requests));
+        pending_lookups_.erase(itr->second.request_id);
+        itr = in_flight_lookups_.erase(itr);
+      } else {
+        ++itr;
+      }
     }
+    if (expiry_alarm_ && !in_flight_lookups_.empty())
+      SetExpiryAlarm();
   }
+  for (auto& released_request : released_requests)
+    network_.SendToClosestNode(released_request);
+}
+
+void CacheManager::SetExpiryAlarm() {
+  auto next_expiry(std::min_element(
+      std::begin(in_flight_lookups_), std::end(in_flight_lookups_),
+      [](const std::pair<const std::string, InFlightLookup>& lhs,
+         const std::pair<const std::string, InFlightLookup>& rhs) {
+        return lhs.second.expiry_time < rhs.second.expiry_time;
+      }));
+  assert(next_expiry != std::end(in_flight_lookups_));
+  expiry_alarm_->ExpiresFromNow(next_expiry->second.expiry_time - scheduler_.Now());
+  expiry_alarm_->AsyncWait([this](const boost::system::error_code& error_code) {
+    if (error_code != boost::asio::error::operation_aborted)
+      ReleaseExpiredLookups();
+  });
+  expiry_alarm_set_ = true;
 }
 
 }  // namespace routing
@@ -19,38 +19,125 @@
 #ifndef MAIDSAFE_ROUTING_CACHE_MANAGER_H_
 #define MAIDSAFE_ROUTING_CACHE_MANAGER_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/persistent_cache_store.h"
+#include "maidsafe/routing/response_cache.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/scheduler.h"
 
 namespace maidsafe {
 
 namespace routing {
 
-namespace protobuf {
-class Message;
-}
-
 class NetworkUtils;
 
+namespace test {
+class CacheManagerTest_BEH_CoalesceIdenticalGets_Test;
+class CacheManagerTest_BEH_DropStoresWhenFull_Test;
+class CacheManagerTest_BEH_FailedStoreFreesQueueSlot_Test;
+class CacheManagerTest_BEH_IgnoreUnrequestedResponses_Test;
+class CacheManagerTest_BEH_ReleaseParkedOnExpiry_Test;
+class CacheManagerTest_BEH_ReleaseParkedOnFailure_Test;
+}
+
 class CacheManager {
  public:
-  CacheManager(NodeId node_id, NetworkUtils& network);
+  // The response cache budget defaults to Parameters::response_cache_size.
+  // If Parameters::persistent_cache_directory is set, responses are also held in a file there.
+  // Parked requests are released by an alarm on 'scheduler'.  If 'scheduler' is destroyed first,
+  // Stop must be called before then.
+  CacheManager(NodeId node_id, NetworkUtils& network, Scheduler& scheduler);
+  CacheManager(NodeId node_id, NetworkUtils& network, Scheduler& scheduler,
+               uint64_t max_cache_bytes);
+  // Waits for any store in progress to finish; stores still queued are abandoned.
+  ~CacheManager();
+  // Abandons queued stores and drops the expiry alarm.  Requests are no longer parked after this.
+  void Stop();
 
   void InitialiseFunctors(MessageReceivedFunctor message_received_functor,
                           StoreCacheDataFunctor store_cache_data);
+  // Answers any requests parked behind this response, then queues the response to be stored by a
+  // separate worker so that slow upper-layer stores don't hold up the routing threads.  Only
+  // responses to requests this node passed on are added to the response caches, but all are
+  // offered to the upper layer.  If Parameters::max_pending_cache_stores are already queued, the
+  // response is dropped.  An empty response fails its lookup: the requests parked behind it are
+  // passed on at once and nothing is stored.
   void AddToCache(const protobuf::Message& message);
+  // Answers directly from the response caches if possible.  Otherwise, if an identical request is
+  // already in flight from this node, parks this one to be answered from that request's response,
+  // or passed on after Parameters::parked_cache_request_timeout if none comes.  Failing both, asks
+  // the upper layer before passing the request on.
   void HandleGetFromCache(protobuf::Message& message);
 
+  friend class test::CacheManagerTest_BEH_CoalesceIdenticalGets_Test;
+  friend class test::CacheManagerTest_BEH_DropStoresWhenFull_Test;
+  friend class test::CacheManagerTest_BEH_FailedStoreFreesQueueSlot_Test;
+  friend class test::CacheManagerTest_BEH_IgnoreUnrequestedResponses_Test;
+  friend class test::CacheManagerTest_BEH_ReleaseParkedOnExpiry_Test;
+  friend class test::CacheManagerTest_BEH_ReleaseParkedOnFailure_Test;
+
  private:
+  typedef std::pair<std::string, int32_t> RequestId;  // source ID and message ID
+
+  struct InFlightLookup {
+    InFlightLookup(RequestId request_id_in, std::chrono::steady_clock::time_point expiry_time_in)
+        : request_id(std::move(request_id_in)),
+          expiry_time(std::move(expiry_time_in)),
+          parked_requests() {}
+    RequestId request_id;
+    std::chrono::steady_clock::time_point expiry_time;
+    std::vector<protobuf::Message> parked_requests;
+  };
+
   CacheManager(const CacheManager&);
   CacheManager(const CacheManager&&);
   CacheManager& operator=(const CacheManager&);
 
+  void SendCachedResponse(const protobuf::Message& message, const std::string& response);
+  protobuf::Message MakeCachedResponse(const protobuf::Message& message, const char* response,
+                                       size_t size);
+  // Returns true if the request has been parked behind an identical one already in flight.
+  bool ParkOrAddLookup(const protobuf::Message& message, const std::string& key);
+  void CompleteLookup(const std::string& key, const std::string& response);
+  // Passes on the requests parked behind a lookup which has failed.
+  void FailLookup(const std::string& key);
+  void StoreResponse(const std::string& key, const std::string& response);
+  // Passes on requests parked behind lookups whose responses haven't come back in time, then sets
+  // the expiry alarm for the next lookup due to expire.
+  void ReleaseExpiredLookups();
+  // Must be called with lookups_mutex_ held.
+  void SetExpiryAlarm();
+
   const NodeId kNodeId_;
   NetworkUtils& network_;
+  Scheduler& scheduler_;
   MessageReceivedFunctor message_received_functor_;
   StoreCacheDataFunctor store_cache_data_;
+  ResponseCache response_cache_;
+  std::unique_ptr<PersistentCacheStore> persistent_cache_store_;
+  std::mutex lookups_mutex_;
+  // Requests passed on by this node, keyed as in the response caches, and the keys of these by
+  // request ID so their responses can be recognised on the way back.
+  std::map<std::string, InFlightLookup> in_flight_lookups_;
+  std::map<RequestId, std::string> pending_lookups_;
+  // Set for the earliest expiry among in_flight_lookups_ whenever there are any.
+  std::unique_ptr<Scheduler::Alarm> expiry_alarm_;
+  bool expiry_alarm_set_;
+  std::atomic<uint32_t> pending_stores_;
+  std::atomic<bool> stopped_;
+  AsioService store_service_;  // must be last member so it is destroyed first
 };
 
 }  // namespace routing
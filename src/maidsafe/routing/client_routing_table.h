@@ -30,6 +30,8 @@
 #include "maidsafe/common/rsa.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/memory_accounting.h"
+#include "maidsafe/routing/profiled_mutex.h"
 
 namespace maidsafe {
 
@@ -81,7 +83,8 @@ class ClientRoutingTable {
 
   const NodeId kNodeId_;
   std::vector<NodeInfo> nodes_;
-  mutable std::mutex mutex_;
+  MemoryCharge nodes_memory_;
+  mutable ProfiledMutex mutex_;
 };
 
 }  // namespace routing
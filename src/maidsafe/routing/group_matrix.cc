@@ -28,6 +28,7 @@
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/scoped_probe.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -39,7 +40,8 @@ GroupMatrix::GroupMatrix(const NodeId& this_node_id, bool client_mode)
       unique_nodes_(),
       radius_(crypto::BigInt::Zero()),
       client_mode_(client_mode),
-      matrix_() {
+      matrix_(),
+      memory_(MemorySubsystem::kGroupMatrix) {
   UpdateUniqueNodeList();
 }
 
@@ -54,7 +56,7 @@ std::shared_ptr<MatrixChange> GroupMatrix::AddConnectedPeer(
                           }));
   if (found != std::end(matrix_)) {
     LOG(kWarning) << "Already Added in matrix";
-    return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, old_unique_ids));
+    return MakeMatrixChange(old_unique_ids, old_unique_ids);
   }
 
   std::vector<NodeInfo> nodes_info(std::vector<NodeInfo>(1, node_info));
@@ -62,7 +64,7 @@ std::shared_ptr<MatrixChange> GroupMatrix::AddConnectedPeer(
   matrix_.push_back(nodes_info);
   Prune();
   UpdateUniqueNodeList();
-  return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, GetUniqueNodeIds()));
+  return MakeMatrixChange(old_unique_ids, GetUniqueNodeIds());
 }
 
 std::shared_ptr<MatrixChange> GroupMatrix::RemoveConnectedPeer(const NodeInfo& node_info) {
@@ -74,7 +76,7 @@ std::shared_ptr<MatrixChange> GroupMatrix::RemoveConnectedPeer(const NodeInfo& n
                 std::end(matrix_));
   Prune();
   UpdateUniqueNodeList();
-  return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, GetUniqueNodeIds()));
+  return MakeMatrixChange(old_unique_ids, GetUniqueNodeIds());
 }
 
 std::vector<NodeInfo> GroupMatrix::GetConnectedPeers() const {
@@ -287,10 +289,11 @@ GroupRangeStatus GroupMatrix::IsNodeIdInGroupRange(const NodeId& group_id,
 std::shared_ptr<MatrixChange> GroupMatrix::UpdateFromConnectedPeer(
     const NodeId& peer, const std::vector<NodeInfo>& nodes,
     const std::vector<NodeId>& old_unique_ids) {
+  ROUTING_PROBE("GroupMatrix::UpdateFromConnectedPeer");
   assert(nodes.size() < Parameters::max_routing_table_size);
   if (peer.IsZero()) {
     assert(false && "Invalid peer node id.");
-    return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, old_unique_ids));
+    return MakeMatrixChange(old_unique_ids, old_unique_ids);
   }
   // If peer is in my group
   auto group_itr(std::begin(matrix_));
@@ -301,7 +304,7 @@ std::shared_ptr<MatrixChange> GroupMatrix::UpdateFromConnectedPeer(
 
   if (group_itr == std::end(matrix_)) {
     LOG(kWarning) << "Peer Node : " << DebugId(peer) << " is not in closest group of this node.";
-    return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, old_unique_ids));
+    return MakeMatrixChange(old_unique_ids, old_unique_ids);
   }
 
   // Update peer's row
@@ -314,7 +317,7 @@ std::shared_ptr<MatrixChange> GroupMatrix::UpdateFromConnectedPeer(
   // Update unique node vector
   Prune();
   UpdateUniqueNodeList();
-  return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, GetUniqueNodeIds()));
+  return MakeMatrixChange(old_unique_ids, GetUniqueNodeIds());
 }
 
 bool GroupMatrix::GetRow(const NodeId& row_id, std::vector<NodeInfo>& row_entries) {
@@ -405,6 +408,21 @@ void GroupMatrix::UpdateUniqueNodeList() {
     radius_ =
         (crypto::BigInt((fcn_distance.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()));
   }
+  UpdateMemoryUsage();
+}
+
+std::shared_ptr<MatrixChange> GroupMatrix::MakeMatrixChange(
+    const std::vector<NodeId>& old_unique_ids, const std::vector<NodeId>& new_unique_ids) {
+  ROUTING_PROBE("MatrixChange");
+  return std::make_shared<MatrixChange>(MatrixChange(kNodeId_, old_unique_ids, new_unique_ids));
+}
+
+void GroupMatrix::UpdateMemoryUsage() {
+  size_t bytes(MemoryUsage(unique_nodes_) +
+               matrix_.capacity() * sizeof(std::vector<NodeInfo>));
+  for (const auto& row : matrix_)
+    bytes += MemoryUsage(row);
+  memory_.Update(bytes);
 }
 
 void GroupMatrix::PartialSortFromTarget(const NodeId& target, uint16_t number,
@@ -462,6 +480,7 @@ void GroupMatrix::Prune() {
       itr++;
     }
   }
+  UpdateMemoryUsage();
 //  PrintGroupMatrix();
 }
 
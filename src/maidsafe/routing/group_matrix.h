@@ -28,6 +28,7 @@
 #include "maidsafe/common/node_id.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/memory_accounting.h"
 
 namespace maidsafe {
 
@@ -94,6 +95,9 @@ class GroupMatrix {
   GroupMatrix(const GroupMatrix&);
   GroupMatrix& operator=(const GroupMatrix&);
   void UpdateUniqueNodeList();
+  void UpdateMemoryUsage();
+  std::shared_ptr<MatrixChange> MakeMatrixChange(const std::vector<NodeId>& old_unique_ids,
+                                                 const std::vector<NodeId>& new_unique_ids);
   void PartialSortFromTarget(const NodeId& target, uint16_t number,
                              std::vector<NodeInfo>& nodes);
   void PrintGroupMatrix();
@@ -103,6 +107,7 @@ class GroupMatrix {
   crypto::BigInt radius_;
   bool client_mode_;
   std::vector<std::vector<NodeInfo>> matrix_;
+  MemoryCharge memory_;
 };
 
 }  // namespace routing
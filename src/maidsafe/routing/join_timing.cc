@@ -0,0 +1,124 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/join_timing.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const char* const kPhaseNames[] = {"Bootstrapped", "FirstFindNodesResponse",
+                                   "FirstRoutingTableAdd", "ClosestNodesReached",
+                                   "ThresholdReached", "GroupMatrixComplete"};
+
+const std::chrono::steady_clock::rep kNotReached(
+    std::numeric_limits<std::chrono::steady_clock::rep>::min());
+
+}  // unnamed namespace
+
+JoinTiming::JoinTiming() : JoinTiming(SteadyClockNow()) {}
+
+JoinTiming::JoinTiming(NowFunctor now)
+    : kNow_(std::move(now)),
+      start_time_(kNotReached),
+      phase_times_(),
+      connect_mutex_(),
+      connect_start_times_(),
+      connect_handshake_() {
+  for (auto& phase_time : phase_times_)
+    phase_time = kNotReached;
+}
+
+void JoinTiming::Start() {
+  start_time_ = kNotReached;
+  for (auto& phase_time : phase_times_)
+    phase_time = kNotReached;
+  start_time_ = Now();
+}
+
+void JoinTiming::Record(Phase phase) {
+  if (start_time_ == kNotReached)
+    return;
+  std::chrono::steady_clock::rep not_reached(kNotReached);
+  phase_times_[static_cast<size_t>(phase)].compare_exchange_strong(not_reached, Now());
+}
+
+bool JoinTiming::Reached(Phase phase) const {
+  return phase_times_[static_cast<size_t>(phase)] != kNotReached;
+}
+
+void JoinTiming::ConnectRequestSent(const NodeId& peer_id) {
+  auto now(kNow_());
+  std::lock_guard<std::mutex> lock(connect_mutex_);
+  // Requests which never complete would otherwise accumulate.
+  if (connect_start_times_.size() >= 2U * Parameters::max_routing_table_size &&
+      connect_start_times_.count(peer_id) == 0) {
+    connect_start_times_.erase(std::min_element(
+        std::begin(connect_start_times_), std::end(connect_start_times_),
+        [](const std::pair<const NodeId, std::chrono::steady_clock::time_point>& lhs,
+           const std::pair<const NodeId, std::chrono::steady_clock::time_point>& rhs) {
+          return lhs.second < rhs.second;
+        }));
+  }
+  connect_start_times_[peer_id] = now;
+}
+
+void JoinTiming::PeerAdded(const NodeId& peer_id) {
+  std::chrono::steady_clock::time_point start_time;
+  {
+    std::lock_guard<std::mutex> lock(connect_mutex_);
+    auto itr(connect_start_times_.find(peer_id));
+    if (itr == std::end(connect_start_times_))
+      return;
+    start_time = itr->second;
+    connect_start_times_.erase(itr);
+  }
+  connect_handshake_.Record(kNow_() - start_time);
+}
+
+void JoinTiming::Snapshot(Statistics& statistics) const {
+  static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) == kPhaseCount,
+                "Each phase needs a name");
+  std::chrono::steady_clock::rep start_time(start_time_);
+  for (size_t i(0); i != kPhaseCount; ++i) {
+    std::chrono::steady_clock::rep phase_time(phase_times_[i]);
+    if (start_time == kNotReached || phase_time < start_time)
+      continue;
+    statistics.join_phases[kPhaseNames[i]] =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::duration(phase_time - start_time));
+  }
+  statistics.connect_handshake = connect_handshake_.Buckets();
+}
+
+std::chrono::steady_clock::rep JoinTiming::Now() const {
+  return kNow_().time_since_epoch().count();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,87 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_JOIN_TIMING_H_
+#define MAIDSAFE_ROUTING_JOIN_TIMING_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/scheduler.h"
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+// Records how long after the start of a join each of its phases is first reached, and how long
+// each connect handshake takes from sending the Connect request to adding the peer.
+class JoinTiming {
+ public:
+  enum class Phase : int {
+    kBootstrapped = 0,
+    kFirstFindNodesResponse,
+    kFirstRoutingTableAdd,
+    kClosestNodesReached,
+    kThresholdReached,
+    kGroupMatrixComplete,
+    kCount
+  };
+
+  JoinTiming();
+  // Takes the time from 'now', e.g. the node's Scheduler.
+  explicit JoinTiming(NowFunctor now);
+  // Starts timing a new join, forgetting phases reached by any earlier one.
+  void Start();
+  // Only the first call for each phase after Start has any effect.
+  void Record(Phase phase);
+  bool Reached(Phase phase) const;
+  void ConnectRequestSent(const NodeId& peer_id);
+  void PeerAdded(const NodeId& peer_id);
+  void Snapshot(Statistics& statistics) const;
+
+ private:
+  static const size_t kPhaseCount = static_cast<size_t>(Phase::kCount);
+
+  JoinTiming(const JoinTiming&);
+  JoinTiming(const JoinTiming&&);
+  JoinTiming& operator=(const JoinTiming&);
+
+  std::chrono::steady_clock::rep Now() const;
+
+  const NowFunctor kNow_;
+  // Times are steady_clock ticks since its epoch, with kNotReached meaning not yet reached.  A
+  // scheduler's epoch may be its start, so zero is a valid time.
+  std::atomic<std::chrono::steady_clock::rep> start_time_;
+  std::array<std::atomic<std::chrono::steady_clock::rep>, kPhaseCount> phase_times_;
+  std::mutex connect_mutex_;
+  std::map<NodeId, std::chrono::steady_clock::time_point> connect_start_times_;
+  LatencyHistogram connect_handshake_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_JOIN_TIMING_H_
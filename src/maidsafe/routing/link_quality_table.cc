@@ -0,0 +1,149 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/link_quality_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+// Weight given to the newest sample in the moving averages, as in TCP's smoothed RTT.
+const double kSampleWeight(0.125);
+
+// Halves the failure rate for each Parameters::link_failure_half_life since the peer was last sent
+// to.  Without this a peer passed over as flaky would get no further sends and so stay flaky.
+double DecayedFailureRate(const LinkQuality& link,
+                          const std::chrono::steady_clock::time_point& now) {
+  if (link.failure_rate == 0.0 || Parameters::link_failure_half_life.count() == 0 ||
+      now <= link.last_activity)
+    return link.failure_rate;
+  double half_lives(std::chrono::duration<double>(now - link.last_activity).count() /
+                    std::chrono::duration<double>(Parameters::link_failure_half_life).count());
+  return link.failure_rate * std::pow(0.5, half_lives);
+}
+
+}  // unnamed namespace
+
+LinkQuality::LinkQuality()
+    : send_successes(0),
+      send_failures(0),
+      bytes_sent(0),
+      last_success(),
+      last_activity(),
+      round_trip_time(),
+      failure_rate(0.0) {}
+
+LinkQualityTable::LinkQualityTable() : LinkQualityTable(SteadyClockNow()) {}
+
+LinkQualityTable::LinkQualityTable(NowFunctor now) : kNow_(std::move(now)), mutex_(), links_() {}
+
+void LinkQualityTable::RecordSendSuccess(
+    const NodeId& peer_id, size_t bytes,
+    const std::chrono::steady_clock::duration& round_trip_time) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  LinkQuality& link(Entry(peer_id, lock));
+  link.round_trip_time = (link.send_successes == 0)
+                             ? round_trip_time
+                             : std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   link.round_trip_time * (1.0 - kSampleWeight) +
+                                   round_trip_time * kSampleWeight);
+  ++link.send_successes;
+  link.bytes_sent += bytes;
+  link.failure_rate *= (1.0 - kSampleWeight);
+  link.last_success = link.last_activity;
+}
+
+void LinkQualityTable::RecordSendFailure(const NodeId& peer_id, size_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  LinkQuality& link(Entry(peer_id, lock));
+  ++link.send_failures;
+  link.bytes_sent += bytes;
+  link.failure_rate = link.failure_rate * (1.0 - kSampleWeight) + kSampleWeight;
+}
+
+bool LinkQualityTable::Get(const NodeId& peer_id, LinkQuality& link_quality) const {
+  auto now(kNow_());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(links_.find(peer_id));
+  if (itr == std::end(links_))
+    return false;
+  link_quality = itr->second;
+  link_quality.failure_rate = DecayedFailureRate(itr->second, now);
+  return true;
+}
+
+std::vector<std::pair<NodeId, LinkQuality>> LinkQualityTable::GetAll() const {
+  auto now(kNow_());
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<NodeId, LinkQuality>> links(std::begin(links_), std::end(links_));
+  for (auto& link : links)
+    link.second.failure_rate = DecayedFailureRate(link.second, now);
+  return links;
+}
+
+bool LinkQualityTable::IsFlaky(const NodeId& peer_id) const {
+  auto now(kNow_());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(links_.find(peer_id));
+  return itr != std::end(links_) &&
+         DecayedFailureRate(itr->second, now) * 100.0 > Parameters::flaky_link_failure_percentage;
+}
+
+void LinkQualityTable::Remove(const NodeId& peer_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  links_.erase(peer_id);
+}
+
+LinkQuality& LinkQualityTable::Entry(const NodeId& peer_id, std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  auto now(kNow_());
+  auto itr(links_.find(peer_id));
+  if (itr == std::end(links_)) {
+    // Peers are normally removed as they are dropped; this only guards against unbounded growth
+    // from short-lived connections.
+    if (links_.size() >= 2U * (Parameters::max_routing_table_size +
+                               Parameters::max_client_routing_table_size)) {
+      links_.erase(std::min_element(
+          std::begin(links_), std::end(links_),
+          [](const std::pair<const NodeId, LinkQuality>& lhs,
+             const std::pair<const NodeId, LinkQuality>& rhs) {
+            return lhs.second.last_activity < rhs.second.last_activity;
+          }));
+    }
+    itr = links_.insert(std::make_pair(peer_id, LinkQuality())).first;
+  } else {
+    itr->second.failure_rate = DecayedFailureRate(itr->second, now);
+  }
+  itr->second.last_activity = now;
+  return itr->second;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
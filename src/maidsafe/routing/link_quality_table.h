@@ -0,0 +1,81 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_LINK_QUALITY_TABLE_H_
+#define MAIDSAFE_ROUTING_LINK_QUALITY_TABLE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/scheduler.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+struct LinkQuality {
+  LinkQuality();
+  uint64_t send_successes, send_failures, bytes_sent;
+  std::chrono::steady_clock::time_point last_success, last_activity;
+  // Smoothed time from handing a message to rudp to its delivery being acknowledged.
+  std::chrono::steady_clock::duration round_trip_time;
+  // Exponentially weighted moving average of sends failing, from 0.0 to 1.0.  It decays towards 0.0
+  // while nothing is sent to the peer (see Parameters::link_failure_half_life).
+  double failure_rate;
+};
+
+// Per-peer record of how sends to that peer have fared, used to prefer reliable peers among
+// near-equally-close candidates for forwarding.
+class LinkQualityTable {
+ public:
+  LinkQualityTable();
+  // Takes the time from 'now', e.g. the node's Scheduler.
+  explicit LinkQualityTable(NowFunctor now);
+  void RecordSendSuccess(const NodeId& peer_id, size_t bytes,
+                         const std::chrono::steady_clock::duration& round_trip_time);
+  void RecordSendFailure(const NodeId& peer_id, size_t bytes);
+  // Returns false if nothing has been sent to peer_id.
+  bool Get(const NodeId& peer_id, LinkQuality& link_quality) const;
+  std::vector<std::pair<NodeId, LinkQuality>> GetAll() const;
+  // Returns true if the peer's failure rate exceeds Parameters::flaky_link_failure_percentage.
+  bool IsFlaky(const NodeId& peer_id) const;
+  void Remove(const NodeId& peer_id);
+
+ private:
+  LinkQualityTable(const LinkQualityTable&);
+  LinkQualityTable(const LinkQualityTable&&);
+  LinkQualityTable& operator=(const LinkQualityTable&);
+
+  LinkQuality& Entry(const NodeId& peer_id, std::unique_lock<std::mutex>& lock);
+
+  const NowFunctor kNow_;
+  mutable std::mutex mutex_;
+  std::map<NodeId, LinkQuality> links_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_LINK_QUALITY_TABLE_H_
@@ -0,0 +1,85 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/memory_accounting.h"
+
+#include <array>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kSubsystemCount = static_cast<size_t>(MemorySubsystem::kCount);
+
+const char* const kSubsystemNames[] = {"RoutingTable", "GroupMatrix", "ClientRoutingTable",
+                                       "TimerTasks", "QueuedHandlers",
+                                       "UnvalidatedMatrixUpdates"};
+
+static_assert(sizeof(kSubsystemNames) / sizeof(kSubsystemNames[0]) == kSubsystemCount,
+              "Each subsystem needs a name");
+
+std::array<detail::MemoryAccount, kSubsystemCount>& Accounts() {
+  static std::array<detail::MemoryAccount, kSubsystemCount> accounts;
+  return accounts;
+}
+
+}  // unnamed namespace
+
+namespace detail {
+
+MemoryAccount& GetMemoryAccount(MemorySubsystem subsystem) {
+  return Accounts()[static_cast<size_t>(subsystem)];
+}
+
+}  // namespace detail
+
+MemoryCharge::MemoryCharge(MemorySubsystem subsystem)
+    : account_(detail::GetMemoryAccount(subsystem)), bytes_(0) {}
+
+MemoryCharge::~MemoryCharge() { account_.Subtract(bytes_); }
+
+void MemoryCharge::Update(size_t bytes) {
+  if (bytes > bytes_)
+    account_.Add(bytes - bytes_);
+  else
+    account_.Subtract(bytes_ - bytes);
+  bytes_ = bytes;
+}
+
+size_t MemoryUsage(const std::vector<NodeInfo>& nodes) {
+  size_t bytes(nodes.capacity() * sizeof(NodeInfo));
+  for (const auto& node : nodes)
+    bytes += node.dimension_list.capacity() * sizeof(int32_t);
+  return bytes;
+}
+
+std::map<std::string, MemoryStatistics> GetMemoryStatistics() {
+  std::map<std::string, MemoryStatistics> memory_statistics;
+  for (size_t i(0); i != kSubsystemCount; ++i) {
+    MemoryStatistics& statistics(memory_statistics[kSubsystemNames[i]]);
+    statistics.current_bytes = Accounts()[i].current();
+    statistics.peak_bytes = Accounts()[i].peak();
+  }
+  return memory_statistics;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,134 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/message_capture.h"
+
+#include <utility>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const uint64_t kFileMagic(0x4d53524341505431ULL);  // "MSRCAPT1"
+const size_t kFileHeaderSize(sizeof(kFileMagic) + NodeId::kSize);
+const size_t kRecordHeaderSize(sizeof(uint64_t) + sizeof(uint32_t) + NodeId::kSize);
+
+template <typename Integer>
+void WriteInteger(std::ofstream& file, Integer value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename Integer>
+bool ReadInteger(std::ifstream& file, Integer& value) {
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool ReadBytes(std::ifstream& file, size_t size, std::string& bytes) {
+  bytes.resize(size);
+  return size == 0 || static_cast<bool>(file.read(&bytes[0], size));
+}
+
+}  // unnamed namespace
+
+MessageCapture::MessageCapture(fs::path file_path, const NodeId& node_id, uint64_t max_size)
+    : mutex_(),
+      kFilePath_(std::move(file_path)),
+      kMaxSize_(max_size),
+      kStartTime_(std::chrono::steady_clock::now()),
+      file_(kFilePath_.string().c_str(), std::ios::binary | std::ios::trunc),
+      size_(kFileHeaderSize),
+      full_(false) {
+  if (!file_) {
+    LOG(kError) << "Failed to create message capture " << kFilePath_;
+    return;
+  }
+  WriteInteger(file_, kFileMagic);
+  file_.write(node_id.string().data(), NodeId::kSize);
+  LOG(kInfo) << "Capturing received messages to " << kFilePath_;
+}
+
+MessageCapture::~MessageCapture() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.flush();
+}
+
+void MessageCapture::Record(const std::string& message, const std::string& connection_id) {
+  uint64_t time(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - kStartTime_).count());
+  uint64_t record_size(kRecordHeaderSize + message.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_ || full_)
+    return;
+  if (size_ + record_size > kMaxSize_) {
+    LOG(kWarning) << "Message capture " << kFilePath_ << " is full; no more messages are written";
+    full_ = true;
+    return;
+  }
+  WriteInteger(file_, time);
+  WriteInteger(file_, static_cast<uint32_t>(message.size()));
+  if (connection_id.size() == NodeId::kSize)
+    file_.write(connection_id.data(), NodeId::kSize);
+  else
+    file_.write(std::string(NodeId::kSize, '\0').data(), NodeId::kSize);
+  file_.write(message.data(), message.size());
+  size_ += record_size;
+}
+
+std::vector<CapturedMessage> ReadMessageCapture(const fs::path& file_path, NodeId& node_id) {
+  std::ifstream file(file_path.string().c_str(), std::ios::binary);
+  if (!file) {
+    LOG(kError) << "Failed to open message capture " << file_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  uint64_t magic(0);
+  std::string node_id_bytes;
+  if (!ReadInteger(file, magic) || magic != kFileMagic ||
+      !ReadBytes(file, NodeId::kSize, node_id_bytes)) {
+    LOG(kError) << file_path << " is not a message capture";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+  node_id = NodeId(node_id_bytes);
+
+  std::vector<CapturedMessage> messages;
+  std::string connection_id;
+  for (;;) {
+    uint64_t time(0);
+    uint32_t size(0);
+    CapturedMessage captured_message;
+    if (!ReadInteger(file, time) || !ReadInteger(file, size) ||
+        !ReadBytes(file, NodeId::kSize, connection_id) ||
+        !ReadBytes(file, size, captured_message.message)) {
+      break;
+    }
+    captured_message.time = std::chrono::microseconds(time);
+    captured_message.connection_id = NodeId(connection_id);
+    messages.push_back(std::move(captured_message));
+  }
+  return messages;
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,82 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_MESSAGE_CAPTURE_H_
+#define MAIDSAFE_ROUTING_MESSAGE_CAPTURE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/node_id.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+struct CapturedMessage {
+  CapturedMessage() : time(0), connection_id(), message() {}
+  // Since the capture started.
+  std::chrono::microseconds time;
+  // Zero if the capturing node didn't know it.
+  NodeId connection_id;
+  std::string message;
+};
+
+// Appends each message received, as it arrived from rudp, to a file so that a node's inbound
+// traffic can be replayed offline.  The file holds the capturing node's ID followed by one record
+// per message: its time since the capture started, its length, the connection ID and the message
+// itself.  Integers are in host byte order.  Once 'max_size' bytes have been written further
+// messages are dropped.
+class MessageCapture {
+ public:
+  MessageCapture(boost::filesystem::path file_path, const NodeId& node_id, uint64_t max_size);
+  ~MessageCapture();
+  // 'connection_id' should be NodeId::kSize bytes, or empty if not known.
+  void Record(const std::string& message, const std::string& connection_id);
+
+ private:
+  MessageCapture(const MessageCapture&);
+  MessageCapture(const MessageCapture&&);
+  MessageCapture& operator=(const MessageCapture&);
+
+  std::mutex mutex_;
+  const boost::filesystem::path kFilePath_;
+  const uint64_t kMaxSize_;
+  const std::chrono::steady_clock::time_point kStartTime_;
+  std::ofstream file_;
+  uint64_t size_;
+  bool full_;
+};
+
+// Reads back a capture written by MessageCapture, setting 'node_id' to the capturing node's ID.  A
+// final record cut short by the capturing node stopping is ignored.  Throws if the file can't be
+// read or isn't a capture.
+std::vector<CapturedMessage> ReadMessageCapture(const boost::filesystem::path& file_path,
+                                                NodeId& node_id);
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MESSAGE_CAPTURE_H_
@@ -26,11 +26,13 @@
 #include "maidsafe/routing/client_routing_table.h"
 #include "maidsafe/routing/group_change_handler.h"
 #include "maidsafe/routing/message.h"
+#include "maidsafe/routing/message_tracer.h"
 #include "maidsafe/routing/network_utils.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/service.h"
 #include "maidsafe/routing/remove_furthest_node.h"
+#include "maidsafe/routing/scoped_probe.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -103,15 +105,18 @@ MessageHandler::MessageHandler(RoutingTable& routing_table,
       network_(network),
       remove_furthest_node_(remove_furthest_node),
       group_change_handler_(group_change_handler),
-      cache_manager_(routing_table_.client_mode()
+      // Each CacheManager runs a store thread, so only vaults which cache get one.
+      cache_manager_((routing_table_.client_mode() || !Parameters::caching)
                          ? nullptr
-                         : (new CacheManager(routing_table_.kNodeId(), network_))),
+                         : (new CacheManager(routing_table_.kNodeId(), network_,
+                                             timer.scheduler()))),
       timer_(timer),
       response_handler_(new ResponseHandler(routing_table, client_routing_table, network_,
                                             group_change_handler)),
       service_(new Service(routing_table, client_routing_table, network_)),
       message_received_functor_(),
-      typed_message_received_functors_() {}
+      typed_message_received_functors_(),
+      message_statistics_() {}
 
 void MessageHandler::HandleRoutingMessage(protobuf::Message& message) {
   bool request(message.request());
@@ -192,6 +197,8 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
       message_out.add_data(reply_message);
       message_out.set_last_id(routing_table_.kNodeId().string());
       message_out.set_source_id(routing_table_.kNodeId().string());
+      if (IsCacheableGet(message))
+        message_out.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
       if (message.has_id())
         message_out.set_id(message.id());
       else
@@ -216,6 +223,7 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
         HandleMessage(message_out);
       }
     };
+    ScopedTraceSpan trace_span("UpperLayerRequestFunctor", message);
     if (message_received_functor_)
       message_received_functor_(message.data(0), false, response_functor);
     else
@@ -228,6 +236,7 @@ void MessageHandler::HandleNodeLevelMessageForThisNode(protobuf::Message& messag
     try {
       if (!message.has_id() || message.data_size() != 1)
         BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+      ScopedTraceSpan trace_span("UpperLayerResponseFunctor", message);
       timer_.AddResponse(message.id(), message.data(0));
     }
     catch (const maidsafe_error& e) {
@@ -248,6 +257,10 @@ void MessageHandler::HandleMessageForThisNode(protobuf::Message& message) {
   if (RelayDirectMessageIfNeeded(message))
     return;
 
+  message_statistics_.RecordDelivery(message.has_group_destination()
+                                         ? MessageStatistics::Destination::kGroupMember
+                                         : MessageStatistics::Destination::kDirect,
+                                     message);
   LOG(kVerbose) << "Message for this node."
                 << " id: " << message.id();
   if (IsRoutingMessage(message))
@@ -347,6 +360,7 @@ void MessageHandler::HandleGroupMessageAsClosestNode(protobuf::Message& message)
     return;
   }
 
+  message_statistics_.RecordDelivery(MessageStatistics::Destination::kGroupLeader, message);
   --replication;  // Will send to self as well
   message.set_direct(true);
   message.clear_route_history();
@@ -411,9 +425,12 @@ void MessageHandler::HandleMessageAsFarNode(protobuf::Message& message) {
 }
 
 void MessageHandler::HandleMessage(protobuf::Message& message) {
+  ROUTING_PROBE("MessageHandler::HandleMessage");
   LOG(kVerbose) << "[" << DebugId(routing_table_.kNodeId()) << "]"
                 << " MessageHandler::HandleMessage handle message with id: " << message.id();
+  message_statistics_.Record(message);
   if (!ValidateMessage(message)) {
+    message_statistics_.Record(MessageStatistics::Handling::kDropped);
     LOG(kWarning) << "Validate message failed， id: " << message.id();
     assert((message.hops_to_live() > 0) && "Message has traversed maximum number of hops allowed");
     return;
@@ -424,28 +441,32 @@ void MessageHandler::HandleMessage(protobuf::Message& message) {
 
   if (IsValidCacheableGet(message)) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " with cache manager";
+    message_statistics_.Record(MessageStatistics::Handling::kCacheLookup);
     return HandleCacheLookup(message);  // forwarding message is done by cache manager
   }
   if (IsValidCacheablePut(message)) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " StoreCacheCopy";
-    StoreCacheCopy(message);  //  Upper layer should take this on separate thread
+    StoreCacheCopy(message);  //  Stored on the cache manager's own worker thread
   }
 
   // If group message request to self id
   if (IsGroupMessageRequestToSelfId(message)) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleGroupMessageToSelfId";
+    message_statistics_.Record(MessageStatistics::Handling::kGroupToSelf);
     return HandleGroupMessageToSelfId(message);
   }
 
   // If this node is a client
   if (routing_table_.client_mode()) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleClientMessage";
+    message_statistics_.Record(MessageStatistics::Handling::kClient);
     return HandleClientMessage(message);
   }
 
   // Relay mode message
   if (message.source_id().empty()) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleRelayRequest";
+    message_statistics_.Record(MessageStatistics::Handling::kRelay);
     return HandleRelayRequest(message);
   }
 
@@ -453,23 +474,27 @@ void MessageHandler::HandleMessage(protobuf::Message& message) {
   if (NodeId(message.source_id()).IsZero()) {
     LOG(kWarning) << "Stray message dropped, need valid source ID for processing."
                   << " id: " << message.id();
+    message_statistics_.Record(MessageStatistics::Handling::kDropped);
     return;
   }
 
   // Direct message
   if (message.destination_id() == routing_table_.kNodeId().string()) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageForThisNode";
+    message_statistics_.Record(MessageStatistics::Handling::kForThisNode);
     return HandleMessageForThisNode(message);
   }
 
   if (IsRelayResponseForThisNode(message)) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleRoutingMessage";
+    message_statistics_.Record(MessageStatistics::Handling::kRelayResponse);
     return HandleRoutingMessage(message);
   }
 
   if (client_routing_table_.Contains(NodeId(message.destination_id())) && IsDirect(message)) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id()
                << " HandleMessageForNonRoutingNodes";
+    message_statistics_.Record(MessageStatistics::Handling::kNonRoutingNode);
     return HandleMessageForNonRoutingNodes(message);
   }
 
@@ -479,9 +504,11 @@ void MessageHandler::HandleMessage(protobuf::Message& message) {
       (routing_table_.IsThisNodeClosestTo(NodeId(message.destination_id()), !message.direct()) &&
        message.visited())) {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageAsClosestNode";
+    message_statistics_.Record(MessageStatistics::Handling::kClosestNode);
     return HandleMessageAsClosestNode(message);
   } else {
     LOG(kInfo) << "MessageHandler::HandleMessage " << message.id() << " HandleMessageAsFarNode";
+    message_statistics_.Record(MessageStatistics::Handling::kFarNode);
     return HandleMessageAsFarNode(message);
   }
 }
@@ -727,7 +754,8 @@ void MessageHandler::InvokeTypedMessageReceivedFunctor(const protobuf::Message&
 
 void MessageHandler::set_message_and_caching_functor(MessageAndCachingFunctors functors) {
   message_received_functor_ = functors.message_received;
-  // Initialise caching functors here
+  if (cache_manager_ && functors.message_received && functors.store_cache_data)
+    cache_manager_->InitialiseFunctors(functors.message_received, functors.store_cache_data);
 }
 
 void MessageHandler::set_typed_message_and_caching_functor(TypedMessageAndCachingFunctor functors) {
@@ -746,6 +774,11 @@ void MessageHandler::set_request_public_key_functor(
   service_->set_request_public_key_functor(request_public_key_functor);
 }
 
+void MessageHandler::set_request_public_keys_functor(
+    RequestPublicKeysFunctor request_public_keys_functor) {
+  response_handler_->set_request_public_keys_functor(request_public_keys_functor);
+}
+
 void MessageHandler::HandleCacheLookup(protobuf::Message& message) {
   assert(!routing_table_.client_mode());
   assert(IsCacheableGet(message));
@@ -758,16 +791,21 @@ void MessageHandler::StoreCacheCopy(const protobuf::Message& message) {
   cache_manager_->AddToCache(message);
 }
 
+void MessageHandler::StopCaching() {
+  if (cache_manager_)
+    cache_manager_->Stop();
+}
+
 bool MessageHandler::IsValidCacheableGet(const protobuf::Message& message) {
   // TODO(Prakash): need to differentiate between typed and un typed api
-  return (IsCacheableGet(message) && IsNodeLevelMessage(message) && Parameters::caching &&
-          !routing_table_.client_mode());
+  return (IsCacheableGet(message) && IsNodeLevelMessage(message) && cache_manager_ &&
+          IsRequest(message));
 }
 
 bool MessageHandler::IsValidCacheablePut(const protobuf::Message& message) {
   // TODO(Prakash): need to differentiate between typed and un typed api
-  return (IsNodeLevelMessage(message) && Parameters::caching && !routing_table_.client_mode() &&
-          IsCacheablePut(message) && !IsRequest(message));
+  return (IsNodeLevelMessage(message) && cache_manager_ && IsCacheablePut(message) &&
+          !IsRequest(message));
 }
 
 }  // namespace routing
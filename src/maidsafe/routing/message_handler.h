@@ -25,6 +25,7 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/cache_manager.h"
+#include "maidsafe/routing/message_statistics.h"
 #include "maidsafe/routing/response_handler.h"
 #include "maidsafe/routing/service.h"
 #include "maidsafe/routing/timer.h"
@@ -86,6 +87,11 @@ class MessageHandler {
   void set_typed_message_and_caching_functor(TypedMessageAndCachingFunctor functors);
   void set_message_and_caching_functor(MessageAndCachingFunctors functors);
   void set_request_public_key_functor(RequestPublicKeyFunctor request_public_key_functor);
+  void set_request_public_keys_functor(RequestPublicKeysFunctor request_public_keys_functor);
+  const MessageStatistics& message_statistics() const { return message_statistics_; }
+  // Stops caching.  Must be called before the timer's scheduler is destroyed, if it is destroyed
+  // before this.
+  void StopCaching();
 
  private:
   MessageHandler(const MessageHandler&);
@@ -132,6 +138,7 @@ class MessageHandler {
   std::shared_ptr<Service> service_;
   MessageReceivedFunctor message_received_functor_;
   detail::TypedMessageRecievedFunctors typed_message_received_functors_;
+  MessageStatistics message_statistics_;
 };
 
 }  // namespace routing
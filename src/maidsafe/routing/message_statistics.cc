@@ -0,0 +1,102 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/message_statistics.h"
+
+#include <algorithm>
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const char* const kTypeNames[] = {"Unknown", "Ping", "Connect", "FindNodes", "ConnectSuccess",
+                                  "ConnectSuccessAcknowledgement", "Remove", "ClosestNodesUpdate",
+                                  "GetGroup", "NodeLevel"};
+
+const char* const kHandlingNames[] = {"CacheLookup", "GroupToSelf", "Client", "Relay",
+                                      "ForThisNode", "RelayResponse", "NonRoutingNode",
+                                      "ClosestNode", "FarNode", "Dropped"};
+
+const char* const kDestinationNames[] = {"Direct", "GroupLeader", "GroupMember"};
+
+}  // unnamed namespace
+
+MessageStatistics::MessageStatistics() : type_counts_(), handling_counts_(), hop_counts_() {
+  for (auto& count : type_counts_)
+    count = 0;
+  for (auto& count : handling_counts_)
+    count = 0;
+  for (auto& counts : hop_counts_) {
+    for (auto& count : counts)
+      count = 0;
+  }
+}
+
+void MessageStatistics::Record(const protobuf::Message& message) {
+  size_t index(0);
+  if (message.type() == static_cast<int32_t>(MessageType::kNodeLevel))
+    index = kTypeCount - 1;
+  else if (message.type() >= static_cast<int32_t>(MessageType::kPing) &&
+           message.type() <= static_cast<int32_t>(MessageType::kGetGroup))
+    index = static_cast<size_t>(message.type());
+  type_counts_[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MessageStatistics::Record(Handling handling) {
+  handling_counts_[static_cast<size_t>(handling)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MessageStatistics::RecordDelivery(Destination destination,
+                                       const protobuf::Message& message) {
+  int32_t hops(static_cast<int32_t>(Parameters::hops_to_live) - message.hops_to_live());
+  size_t index(std::min(static_cast<size_t>(std::max(hops, 0)), kMaxHops - 1));
+  hop_counts_[static_cast<size_t>(destination)][index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MessageStatistics::Snapshot(Statistics& statistics) const {
+  static_assert(sizeof(kTypeNames) / sizeof(kTypeNames[0]) == kTypeCount,
+                "Each message type needs a name");
+  static_assert(sizeof(kHandlingNames) / sizeof(kHandlingNames[0]) == kHandlingCount,
+                "Each handling needs a name");
+  static_assert(sizeof(kDestinationNames) / sizeof(kDestinationNames[0]) == kDestinationCount,
+                "Each destination needs a name");
+  for (size_t i(0); i != kTypeCount; ++i)
+    statistics.messages_by_type[kTypeNames[i]] = type_counts_[i].load(std::memory_order_relaxed);
+  for (size_t i(0); i != kHandlingCount; ++i) {
+    statistics.messages_by_handling[kHandlingNames[i]] =
+        handling_counts_[i].load(std::memory_order_relaxed);
+  }
+  for (size_t i(0); i != kDestinationCount; ++i) {
+    HopCounts hop_counts;
+    for (const auto& count : hop_counts_[i])
+      hop_counts.push_back(count.load(std::memory_order_relaxed));
+    while (!hop_counts.empty() && hop_counts.back() == 0)
+      hop_counts.pop_back();
+    statistics.hops_by_destination[kDestinationNames[i]] = hop_counts;
+  }
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
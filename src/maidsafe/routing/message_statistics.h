@@ -0,0 +1,81 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_MESSAGE_STATISTICS_H_
+#define MAIDSAFE_ROUTING_MESSAGE_STATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+// Lock-free counts of received messages by type and by how MessageHandler dealt with them, and of
+// the hops taken by messages delivered to this node.
+class MessageStatistics {
+ public:
+  enum class Handling : int {
+    kCacheLookup = 0,
+    kGroupToSelf,
+    kClient,
+    kRelay,
+    kForThisNode,
+    kRelayResponse,
+    kNonRoutingNode,
+    kClosestNode,
+    kFarNode,
+    kDropped,
+    kCount
+  };
+  enum class Destination : int { kDirect = 0, kGroupLeader, kGroupMember, kCount };
+
+  MessageStatistics();
+  void Record(const protobuf::Message& message);
+  void Record(Handling handling);
+  // Must be called after this node has decremented the message's hops_to_live.
+  void RecordDelivery(Destination destination, const protobuf::Message& message);
+  void Snapshot(Statistics& statistics) const;
+
+ private:
+  static const size_t kTypeCount = 10;  // routing message types, node level and unknown
+  static const size_t kHandlingCount = static_cast<size_t>(Handling::kCount);
+  static const size_t kDestinationCount = static_cast<size_t>(Destination::kCount);
+  static const size_t kMaxHops = 64;  // larger hop counts are recorded as kMaxHops - 1
+
+  MessageStatistics(const MessageStatistics&);
+  MessageStatistics(const MessageStatistics&&);
+  MessageStatistics& operator=(const MessageStatistics&);
+
+  std::array<std::atomic<uint64_t>, kTypeCount> type_counts_;
+  std::array<std::atomic<uint64_t>, kHandlingCount> handling_counts_;
+  std::array<std::array<std::atomic<uint64_t>, kMaxHops>, kDestinationCount> hop_counts_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MESSAGE_STATISTICS_H_
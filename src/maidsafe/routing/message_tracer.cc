@@ -0,0 +1,216 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/message_tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boost/thread/tss.hpp"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const size_t kSpansPerThread(1024);
+
+int64_t Microseconds(const std::chrono::steady_clock::time_point& time_point) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(time_point.time_since_epoch())
+      .count();
+}
+
+// Written only by the owning thread and read by ChromeTraceJson, using 'sequence' as a seqlock: it
+// is odd while the span is being written and zero until the span is first written.  'generation' is
+// the number of calls to ClearTrace before the span was recorded.
+struct Span {
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint32_t> generation;
+  std::atomic<const char*> name;
+  std::atomic<int32_t> message_id;
+  std::atomic<uint64_t> source;
+  std::atomic<int64_t> start, duration;
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(uint32_t thread_index_in)
+      : thread_index(thread_index_in), in_use(true), next(0), spans() {
+    for (auto& span : spans) {
+      span.sequence = 0;
+      span.generation = 0;
+      span.name = nullptr;
+      span.message_id = 0;
+      span.source = 0;
+      span.start = 0;
+      span.duration = 0;
+    }
+  }
+  const uint32_t thread_index;
+  std::atomic<bool> in_use;
+  uint64_t next;  // only accessed by the owning thread
+  std::array<Span, kSpansPerThread> spans;
+};
+
+// Buffers are never destroyed.  When a thread exits its buffer is handed to the next new thread,
+// so the number of buffers is bounded by the peak number of tracing threads.
+struct Registry {
+  Registry() : mutex(), buffers(), generation(0), current_buffer(&Release) {}
+  static void Release(ThreadBuffer* buffer) { buffer->in_use = false; }
+  std::mutex mutex;
+  std::vector<ThreadBuffer*> buffers;
+  std::atomic<uint32_t> generation;
+  boost::thread_specific_ptr<ThreadBuffer> current_buffer;
+};
+
+Registry& GetRegistry() {
+  static Registry* const registry(new Registry);
+  return *registry;
+}
+
+ThreadBuffer& GetThreadBuffer(Registry& registry) {
+  ThreadBuffer* buffer(registry.current_buffer.get());
+  if (buffer)
+    return *buffer;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto candidate : registry.buffers) {
+      if (!candidate->in_use) {
+        candidate->in_use = true;
+        buffer = candidate;
+        break;
+      }
+    }
+    if (!buffer) {
+      buffer = new ThreadBuffer(static_cast<uint32_t>(registry.buffers.size()));
+      registry.buffers.push_back(buffer);
+    }
+  }
+  registry.current_buffer.reset(buffer);
+  return *buffer;
+}
+
+uint64_t Mix(uint64_t value) {  // SplitMix64 finaliser
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+}  // unnamed namespace
+
+TraceKey::TraceKey(const protobuf::Message& message)
+    : message_id(message.id()), source(0), sampled(false) {
+  uint32_t sample_rate(Parameters::message_trace_sample_rate);
+  if (sample_rate == 0)
+    return;
+  const std::string& source_id(message.has_source_id() ? message.source_id()
+                                                       : message.relay_id());
+  std::memcpy(&source, source_id.data(), std::min(sizeof(source), source_id.size()));
+  sampled = (Mix(source ^ static_cast<uint32_t>(message_id)) % sample_rate) == 0;
+}
+
+bool TracingEnabled() { return Parameters::message_trace_sample_rate != 0; }
+
+void RecordTraceSpan(const char* name, const TraceKey& key,
+                     const std::chrono::steady_clock::time_point& start,
+                     const std::chrono::steady_clock::time_point& end) {
+  if (!key.sampled)
+    return;
+  Registry& registry(GetRegistry());
+  ThreadBuffer& buffer(GetThreadBuffer(registry));
+  Span& span(buffer.spans[buffer.next++ % kSpansPerThread]);
+  uint64_t sequence(span.sequence.load(std::memory_order_relaxed));
+  span.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  span.generation.store(registry.generation.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  span.name.store(name, std::memory_order_relaxed);
+  span.message_id.store(key.message_id, std::memory_order_relaxed);
+  span.source.store(key.source, std::memory_order_relaxed);
+  span.start.store(Microseconds(start), std::memory_order_relaxed);
+  span.duration.store(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                      std::memory_order_relaxed);
+  span.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+ScopedTraceSpan::ScopedTraceSpan(const char* name, const TraceKey& key)
+    : kName_(name),
+      kKey_(key),
+      kStart_(kKey_.sampled ? std::chrono::steady_clock::now()
+                            : std::chrono::steady_clock::time_point()) {}
+
+ScopedTraceSpan::ScopedTraceSpan(const char* name, const protobuf::Message& message)
+    : kName_(name),
+      kKey_(message),
+      kStart_(kKey_.sampled ? std::chrono::steady_clock::now()
+                            : std::chrono::steady_clock::time_point()) {}
+
+ScopedTraceSpan::~ScopedTraceSpan() {
+  if (kKey_.sampled)
+    RecordTraceSpan(kName_, kKey_, kStart_, std::chrono::steady_clock::now());
+}
+
+std::string ChromeTraceJson() {
+  Registry& registry(GetRegistry());
+  const uint32_t kGeneration(registry.generation.load());
+  std::ostringstream json;
+  json << "{\"traceEvents\":[";
+  bool first(true);
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto buffer : registry.buffers) {
+    for (const auto& span : buffer->spans) {
+      uint64_t sequence(span.sequence.load(std::memory_order_acquire));
+      if (sequence == 0 || sequence % 2 != 0)
+        continue;
+      uint32_t generation(span.generation.load(std::memory_order_relaxed));
+      const char* name(span.name.load(std::memory_order_relaxed));
+      int32_t message_id(span.message_id.load(std::memory_order_relaxed));
+      uint64_t source(span.source.load(std::memory_order_relaxed));
+      int64_t start(span.start.load(std::memory_order_relaxed));
+      int64_t duration(span.duration.load(std::memory_order_relaxed));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (span.sequence.load(std::memory_order_relaxed) != sequence || generation != kGeneration)
+        continue;  // overwritten while being read, or cleared
+      json << (first ? "" : ",") << "\n{\"name\":\"" << name
+           << "\",\"cat\":\"routing\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_index
+           << ",\"ts\":" << start << ",\"dur\":" << duration
+           << ",\"args\":{\"message_id\":" << message_id << ",\"source\":\"" << std::hex
+           << std::setw(16) << std::setfill('0') << source << std::dec << "\"}}";
+      first = false;
+    }
+  }
+  json << "\n]}\n";
+  return json.str();
+}
+
+void ClearTrace() { ++GetRegistry().generation; }
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,72 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_MESSAGE_TRACER_H_
+#define MAIDSAFE_ROUTING_MESSAGE_TRACER_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "maidsafe/routing/tracing.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace protobuf {
+class Message;
+}
+
+// Identifies a message across hops.  'sampled' is false for all messages while tracing is disabled.
+struct TraceKey {
+  explicit TraceKey(const protobuf::Message& message);
+  int32_t message_id;
+  uint64_t source;  // leading bytes of the source ID, or of the relay ID for relayed messages
+  bool sampled;
+};
+
+// Returns true if Parameters::message_trace_sample_rate is non-zero.
+bool TracingEnabled();
+
+// Records a span for the message if it is sampled.  'name' must be a string literal.
+void RecordTraceSpan(const char* name, const TraceKey& key,
+                     const std::chrono::steady_clock::time_point& start,
+                     const std::chrono::steady_clock::time_point& end);
+
+// Records a span from construction to destruction if the message is sampled.
+class ScopedTraceSpan {
+ public:
+  ScopedTraceSpan(const char* name, const TraceKey& key);
+  ScopedTraceSpan(const char* name, const protobuf::Message& message);
+  ~ScopedTraceSpan();
+
+ private:
+  ScopedTraceSpan(const ScopedTraceSpan&);
+  ScopedTraceSpan(const ScopedTraceSpan&&);
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&);
+
+  const char* const kName_;
+  const TraceKey kKey_;
+  const std::chrono::steady_clock::time_point kStart_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_MESSAGE_TRACER_H_
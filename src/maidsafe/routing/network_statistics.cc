@@ -18,8 +18,9 @@
 
 #include "maidsafe/routing/network_statistics.h"
 
-#include <string>
 #include <algorithm>
+#include <cmath>
+#include <string>
 
 #include "maidsafe/routing/parameters.h"
 
@@ -28,7 +29,11 @@ namespace maidsafe {
 namespace routing {
 
 NetworkStatistics::NetworkStatistics(NodeId node_id)
-    : mutex_(), kNodeId_(std::move(node_id)), distance_(), network_distance_data_() {}
+    : mutex_(),
+      kNodeId_(std::move(node_id)),
+      distance_(),
+      local_distance_(0.0),
+      network_average_distance_(0.0) {}
 
 void NetworkStatistics::UpdateLocalAverageDistance(std::vector<NodeId>& unique_nodes) {
   if (unique_nodes.size() < Parameters::group_size)
@@ -48,44 +53,55 @@ void NetworkStatistics::UpdateLocalAverageDistance(std::vector<NodeId>& unique_n
 #endif
   NodeId furthest_group_node(unique_nodes.at(
       std::min(Parameters::group_size - 1, static_cast<int>(unique_nodes.size()))));
+  NodeId distance(furthest_group_node ^ kNodeId_);
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    distance_ = furthest_group_node ^ kNodeId_;
+    distance_ = distance;
   }
+  local_distance_ = ToFraction(distance);
 }
 
 void NetworkStatistics::UpdateNetworkAverageDistance(const NodeId& distance) {
   if (distance == NodeId())
     return;
-  crypto::BigInt distance_integer(
-      (distance.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str());
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    network_distance_data_.total_distance += distance_integer;
-    auto average(network_distance_data_.total_distance /
-                 ++network_distance_data_.contributors_count);
-    std::string average_str(NodeId::kSize, '\0');
-    for (auto index(NodeId::kSize - 1); index >= 0; --index)
-      average_str[NodeId::kSize - 1 - index] = average.GetByte(index);
-    network_distance_data_.average_distance = NodeId(average_str);
-  }
+  double sample(ToFraction(distance)), average(network_average_distance_.load()), updated(0.0);
+  do {
+    updated = (average == 0.0)
+                  ? sample
+                  : average + (sample - average) / Parameters::network_distance_sample_window;
+  } while (!network_average_distance_.compare_exchange_weak(average, updated));
 }
 
 // FIXME(Prakash) handle the case of sender_id == info_id
-bool NetworkStatistics::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) {
-  NodeId local_distance;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    local_distance = distance_;
-  }
-  return crypto::BigInt(
-             ((info_id ^ sender_id).ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()) <=
-         crypto::BigInt(
-             (local_distance.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()) *
-             Parameters::accepted_distance_tolerance;
+bool NetworkStatistics::EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) const {
+  return ToFraction(info_id ^ sender_id) <=
+         local_distance_.load() * Parameters::accepted_distance_tolerance;
+}
+
+uint64_t NetworkStatistics::EstimatedNetworkSize() const {
+  // The furthest of group_size nodes spread evenly over the address space is on average
+  // group_size / network size away.
+  double distance(network_average_distance_.load());
+  if (distance == 0.0)
+    distance = local_distance_.load();
+  if (distance == 0.0)
+    return 0;
+  return static_cast<uint64_t>(std::llround(Parameters::group_size / distance));
 }
 
-NodeId NetworkStatistics::GetDistance() { return distance_; }
+NodeId NetworkStatistics::GetDistance() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return distance_;
+}
+
+double NetworkStatistics::ToFraction(const NodeId& distance) {
+  // The leading 16 bytes give far more precision than a double holds.
+  const std::string distance_string(distance.string());
+  double fraction(0.0);
+  for (size_t i(0); i != 16; ++i)
+    fraction = fraction * 256.0 + static_cast<unsigned char>(distance_string[i]);
+  return std::ldexp(fraction, -128);
+}
 
 }  // namespace routing
 
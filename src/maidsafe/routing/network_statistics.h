@@ -19,6 +19,9 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_STATISTICS_H_
 #define MAIDSAFE_ROUTING_NETWORK_STATISTICS_H_
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
 #include "maidsafe/common/crypto.h"
@@ -35,12 +38,17 @@ class NetworkStatisticsTest_BEH_AverageDistance_Test;
 class NetworkStatisticsTest_BEH_IsIdInGroupRange_Test;
 }
 
+// Distances are held as fractions of the address space so that they can be updated and read
+// atomically.  The network average is an exponentially weighted moving average of the group radii
+// reported by peers, so stale reports are forgotten.
 class NetworkStatistics {
  public:
   explicit NetworkStatistics(NodeId node_id);
   void UpdateLocalAverageDistance(std::vector<NodeId>& unique_nodes);
   void UpdateNetworkAverageDistance(const NodeId& distance);
-  bool EstimateInGroup(const NodeId& sender_id, const NodeId& info_id);
+  bool EstimateInGroup(const NodeId& sender_id, const NodeId& info_id) const;
+  // Returns 0 until a group radius is known.
+  uint64_t EstimatedNetworkSize() const;
   NodeId GetDistance();
 
   friend class test::NetworkStatisticsTest_BEH_AverageDistance_Test;
@@ -49,15 +57,13 @@ class NetworkStatistics {
  private:
   NetworkStatistics(const NetworkStatistics&);
   NetworkStatistics& operator=(const NetworkStatistics&);
-  struct NetworkDistanceData {
-    NetworkDistanceData() : contributors_count(), total_distance(), average_distance() {}
-    crypto::BigInt contributors_count, total_distance;
-    NodeId average_distance;
-  };
+  static double ToFraction(const NodeId& distance);
+
   std::mutex mutex_;
   const NodeId kNodeId_;
   NodeId distance_;
-  NetworkDistanceData network_distance_data_;
+  std::atomic<double> local_distance_;
+  std::atomic<double> network_average_distance_;
 };
 
 }  // namespace routing
@@ -18,6 +18,9 @@
 
 #include "maidsafe/routing/network_utils.h"
 
+#include <chrono>
+#include <utility>
+
 #include "boost/date_time/posix_time/posix_time_config.hpp"
 
 #include "maidsafe/common/log.h"
@@ -26,6 +29,7 @@
 
 #include "maidsafe/routing/bootstrap_file_handler.h"
 #include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/message_tracer.h"
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -47,8 +51,21 @@ typedef boost::unique_lock<boost::shared_mutex> UniqueLock;
 namespace routing {
 
 NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table)
+    : NetworkUtils(routing_table, client_routing_table,
+                   std::unique_ptr<Transport>(new RudpTransport)) {}
+
+NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+                           std::unique_ptr<Transport> transport)
+    : NetworkUtils(routing_table, client_routing_table, std::move(transport), nullptr) {}
+
+NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+                           std::unique_ptr<Transport> transport, Scheduler& scheduler)
+    : NetworkUtils(routing_table, client_routing_table, std::move(transport), &scheduler) {}
+
+NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+                           std::unique_ptr<Transport> transport, Scheduler* scheduler)
     : running_(true),
-      running_mutex_(),
+      running_mutex_("NetworkUtils"),
       bootstrap_attempt_(0),
       bootstrap_endpoints_(),
       bootstrap_connection_id_(),
@@ -57,10 +74,13 @@ NetworkUtils::NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& clie
       client_routing_table_(client_routing_table),
       nat_type_(rudp::NatType::kUnknown),
       new_bootstrap_endpoint_(),
-      rudp_() {}
+      transport_(std::move(transport)),
+      own_scheduler_(scheduler ? nullptr : new AsioScheduler(1)),
+      scheduler_(scheduler ? *scheduler : *own_scheduler_),
+      bytes_sent_(0) {}
 
 NetworkUtils::~NetworkUtils() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   running_ = false;
 }
 
@@ -69,7 +89,7 @@ int NetworkUtils::Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints,
                             const rudp::ConnectionLostFunctor& connection_lost_functor,
                             Endpoint local_endpoint) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return kNetworkShuttingDown;
   }
@@ -101,9 +121,10 @@ int NetworkUtils::Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints,
   if (bootstrap_endpoints_.empty())
     return kInvalidBootstrapContacts;
 
-  int result(rudp_.Bootstrap(/* sorted_ */ bootstrap_endpoints_, message_received_functor,
-                             connection_lost_functor, routing_table_.kConnectionId(), private_key,
-                             public_key, bootstrap_connection_id_, nat_type_, local_endpoint));
+  int result(transport_->Bootstrap(/* sorted_ */ bootstrap_endpoints_, message_received_functor,
+                                   connection_lost_functor, routing_table_.kConnectionId(),
+                                   private_key, public_key, bootstrap_connection_id_, nat_type_,
+                                   local_endpoint));
   ++bootstrap_attempt_;
   // RUDP will return a kZeroId for zero state !!
   if (result != kSuccess || bootstrap_connection_id_.IsZero()) {
@@ -122,31 +143,32 @@ int NetworkUtils::GetAvailableEndpoint(const NodeId& peer_id,
                                        rudp::EndpointPair& this_endpoint_pair,
                                        rudp::NatType& this_nat_type) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return kNetworkShuttingDown;
   }
-  return rudp_.GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair, this_nat_type);
+  return transport_->GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair,
+                                          this_nat_type);
 }
 
 int NetworkUtils::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
                       const std::string& validation_data) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return kNetworkShuttingDown;
   }
-  return rudp_.Add(peer_id, peer_endpoint_pair, validation_data);
+  return transport_->Add(peer_id, peer_endpoint_pair, validation_data);
 }
 
 int NetworkUtils::MarkConnectionAsValid(const NodeId& peer_id) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return kNetworkShuttingDown;
   }
   Endpoint new_bootstrap_endpoint;
-  int ret_val(rudp_.MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
+  int ret_val(transport_->MarkConnectionAsValid(peer_id, new_bootstrap_endpoint));
   if ((ret_val == kSuccess) && !new_bootstrap_endpoint.address().is_unspecified()) {
     LOG(kVerbose) << "Found usable endpoint for bootstrapping : " << new_bootstrap_endpoint;
     // TODO(Prakash): Is separate thread needed here ?
@@ -158,21 +180,34 @@ int NetworkUtils::MarkConnectionAsValid(const NodeId& peer_id) {
 
 void NetworkUtils::Remove(const NodeId& peer_id) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
-  rudp_.Remove(peer_id);
+  transport_->Remove(peer_id);
 }
 
 void NetworkUtils::RudpSend(const NodeId& peer_id, const protobuf::Message& message,
                             const rudp::MessageSentFunctor& message_sent_functor) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
-  rudp_.Send(peer_id, message.SerializeAsString(), message_sent_functor);
+  TraceKey trace_key(message);
+  ScopedTraceSpan trace_span("RudpSend", trace_key);
+  std::string serialised_message(message.SerializeAsString());
+  bytes_sent_ += serialised_message.size();
+  if (trace_key.sampled) {
+    auto send_time(std::chrono::steady_clock::now());
+    transport_->Send(peer_id, std::move(serialised_message), [=](int result) {
+      RecordTraceSpan("SendCompletion", trace_key, send_time, std::chrono::steady_clock::now());
+      if (message_sent_functor)
+        message_sent_functor(result);
+    });
+  } else {
+    transport_->Send(peer_id, std::move(serialised_message), message_sent_functor);
+  }
   LOG(kVerbose) << "  [" << DebugId(routing_table_.kNodeId())
                 << "] send : " << MessageTypeString(message) << " to   " << DebugId(peer_id)
                 << "   (id: " << message.id() << ")"
@@ -245,11 +280,15 @@ void NetworkUtils::SendToClosestNode(const protobuf::Message& message) {
 void NetworkUtils::SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
                           const NodeId& peer_connection_id) {
   const std::string kThisId(routing_table_.kNodeId().string());
+  const auto kSendTime(scheduler_.Now());
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
     if (rudp::kSuccess == message_sent) {
+      routing_table_.link_quality_table().RecordSendSuccess(
+          peer_node_id, message.ByteSize(), scheduler_.Now() - kSendTime);
       LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
                     << " to   " << DebugId(peer_node_id) << "   (id: " << message.id() << ")";
     } else {
+      routing_table_.link_quality_table().RecordSendFailure(peer_node_id, message.ByteSize());
       LOG(kError) << "Sending type " << MessageTypeString(message) << " message from "
                   << HexSubstr(kThisId) << " to " << DebugId(peer_node_id) << " failed with code "
                   << message_sent << " id: " << message.id();
@@ -262,7 +301,7 @@ void NetworkUtils::SendTo(const protobuf::Message& message, const NodeId& peer_n
 void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node_attempted,
                                    int attempt_count) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
@@ -273,10 +312,10 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
                   << " id: " << message.id();
     attempt_count = 0;
     {
-      std::lock_guard<std::mutex> lock(running_mutex_);
+      std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
       if (!running_)
         return;
-      rudp_.Remove(last_node_attempted.connection_id);
+      transport_->Remove(last_node_attempted.connection_id);
       LOG(kWarning) << " Routing -> removing connection " << last_node_attempted.node_id.string();
       // FIXME Should we remove this node or let rudp handle that?
       routing_table_.DropNode(last_node_attempted.connection_id, false);
@@ -285,14 +324,14 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
   }
 
   if (attempt_count > 0)
-    Sleep(std::chrono::milliseconds(50));
+    scheduler_.Sleep(std::chrono::milliseconds(50));
 
   const std::string kThisId(routing_table_.kNodeId().string());
   bool ignore_exact_match(!IsDirect(message));
   std::vector<std::string> route_history;
   NodeInfo peer;
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
     if (message.route_history().size() > 1)
@@ -316,13 +355,23 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
     }
     AdjustRouteHistory(message);
   }
+  // The count is of failures to this peer, so it starts afresh when a retry moves to another one,
+  // e.g. away from a flaky peer.  Otherwise the new peer would be dropped after a single failure.
+  if (peer.node_id != last_node_attempted.node_id)
+    attempt_count = 0;
 
+  const auto kSendTime(scheduler_.Now());
   rudp::MessageSentFunctor message_sent_functor = [=](int message_sent) {
     {
-      std::lock_guard<std::mutex> lock(running_mutex_);
+      std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
       if (!running_)
         return;
     }
+    if (rudp::kSuccess == message_sent)
+      routing_table_.link_quality_table().RecordSendSuccess(
+          peer.node_id, message.ByteSize(), scheduler_.Now() - kSendTime);
+    else
+      routing_table_.link_quality_table().RecordSendFailure(peer.node_id, message.ByteSize());
     if (rudp::kSuccess == message_sent) {
       LOG(kVerbose) << "  [" << HexSubstr(kThisId) << "] sent : " << MessageTypeString(message)
                     << " to   " << HexSubstr(peer.node_id.string()) << "   (id: " << message.id()
@@ -343,10 +392,10 @@ void NetworkUtils::RecursiveSendOn(protobuf::Message message, NodeInfo last_node
                   << " failed with code " << message_sent << "  Will remove node."
                   << " message id: " << message.id();
       {
-        std::lock_guard<std::mutex> lock(running_mutex_);
+        std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
         if (!running_)
           return;
-        rudp_.Remove(last_node_attempted.connection_id);
+        transport_->Remove(last_node_attempted.connection_id);
       }
       LOG(kWarning) << " Routing-> removing connection " << DebugId(peer.connection_id);
       routing_table_.DropNode(peer.node_id, false);
@@ -19,6 +19,9 @@
 #ifndef MAIDSAFE_ROUTING_NETWORK_UTILS_H_
 #define MAIDSAFE_ROUTING_NETWORK_UTILS_H_
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -30,7 +33,10 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/profiled_mutex.h"
+#include "maidsafe/routing/scheduler.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
 
 namespace maidsafe {
 
@@ -51,6 +57,12 @@ class MockNetworkUtils;
 class NetworkUtils {
  public:
   NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table);
+  // Sends over 'transport' in place of rudp.
+  NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+               std::unique_ptr<Transport> transport);
+  // As above, but takes the time and waits between retries on 'scheduler', which must outlive this.
+  NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+               std::unique_ptr<Transport> transport, Scheduler& scheduler);
   virtual ~NetworkUtils();
   int Bootstrap(const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
                 const rudp::MessageReceivedFunctor& message_received_functor,
@@ -81,6 +93,7 @@ class NetworkUtils {
   NodeId bootstrap_connection_id() const;
   NodeId this_node_relay_connection_id() const;
   rudp::NatType nat_type() const;
+  uint64_t bytes_sent() const { return bytes_sent_; }
 
   friend class test::GenericNode;
   friend class test::MockNetworkUtils;
@@ -90,6 +103,10 @@ class NetworkUtils {
   NetworkUtils(const NetworkUtils&&);
   NetworkUtils& operator=(const NetworkUtils&);
 
+  // Makes a scheduler of its own if 'scheduler' is null.
+  NetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+               std::unique_ptr<Transport> transport, Scheduler* scheduler);
+
   void RudpSend(const NodeId& peer_id, const protobuf::Message& message,
                 const rudp::MessageSentFunctor& message_sent_functor);
   void SendTo(const protobuf::Message& message, const NodeId& peer_node_id,
@@ -99,7 +116,7 @@ class NetworkUtils {
   void AdjustRouteHistory(protobuf::Message& message);
 
   bool running_;
-  std::mutex running_mutex_;
+  ProfiledMutex running_mutex_;
   uint16_t bootstrap_attempt_;
   std::vector<boost::asio::ip::udp::endpoint> bootstrap_endpoints_;
   NodeId bootstrap_connection_id_;
@@ -108,7 +125,10 @@ class NetworkUtils {
   ClientRoutingTable& client_routing_table_;
   rudp::NatType nat_type_;
   NewBootstrapEndpointFunctor new_bootstrap_endpoint_;
-  rudp::ManagedConnections rudp_;
+  std::unique_ptr<Transport> transport_;
+  std::unique_ptr<Scheduler> own_scheduler_;
+  Scheduler& scheduler_;
+  std::atomic<uint64_t> bytes_sent_;
 };
 
 }  // namespace routing
@@ -47,6 +47,7 @@ uint16_t Parameters::maximum_find_close_node_failures(10);
 uint16_t Parameters::max_route_history(5);
 uint16_t Parameters::hops_to_live(50);
 uint16_t Parameters::accepted_distance_tolerance(1);
+uint16_t Parameters::network_distance_sample_window(64);
 uint16_t Parameters::greedy_fraction(Parameters::max_routing_table_size * 3 / 4);
 uint16_t Parameters::split_avoidance(4);
 uint16_t Parameters::routing_table_ready_to_response(Parameters::greedy_fraction * 9 / 10);
@@ -67,6 +68,21 @@ bool Parameters::append_maidsafe_local_endpoints(false);
 bool Parameters::append_local_live_port_endpoint(false);
 // TODO(Prakash): BEFORE_RELEASE enable caching after persona tests are passing
 bool Parameters::caching(false);
+uint64_t Parameters::response_cache_size(static_cast<uint64_t>(Parameters::num_chunks_to_cache) *
+                                         Parameters::max_data_size);
+uint16_t Parameters::max_parked_cache_requests(50);
+std::chrono::steady_clock::duration Parameters::parked_cache_request_timeout(
+    std::chrono::seconds(2));
+uint16_t Parameters::max_pending_cache_stores(100);
+boost::filesystem::path Parameters::persistent_cache_directory;
+uint64_t Parameters::persistent_cache_size(1024 * 1024 * 1024);
+uint16_t Parameters::public_key_cache_size(Parameters::max_routing_table_size * 4);
+std::chrono::seconds Parameters::public_key_cache_lifetime(600);
+uint16_t Parameters::flaky_link_failure_percentage(20);
+std::chrono::seconds Parameters::link_failure_half_life(30);
+uint32_t Parameters::message_trace_sample_rate(0);
+boost::filesystem::path Parameters::message_capture_directory;
+uint64_t Parameters::message_capture_size(1024 * 1024 * 1024);
 }  // namespace routing
 
 }  // namespace maidsafe
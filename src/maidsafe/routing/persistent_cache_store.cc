@@ -0,0 +1,224 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/persistent_cache_store.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "boost/filesystem/operations.hpp"
+#include "boost/interprocess/exceptions.hpp"
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+namespace fs = boost::filesystem;
+namespace bi = boost::interprocess;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+const uint64_t kFileMagic(0x4d53524f55544331ULL);  // "MSROUTC1"
+const uint32_t kRecordMagic(0x52454331);          // "REC1"
+
+}  // unnamed namespace
+
+PersistentCacheStore::PersistentCacheStore(fs::path file_path, uint64_t capacity)
+    : mutex_(),
+      kFilePath_(std::move(file_path)),
+      kCapacity_(capacity),
+      file_mapping_(),
+      mapped_region_(),
+      index_(),
+      keys_by_offset_(),
+      loaded_(false) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Map(lock);
+}
+
+PersistentCacheStore::~PersistentCacheStore() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (mapped_region_)
+    mapped_region_->flush();
+}
+
+void PersistentCacheStore::Load() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (loaded_ || !mapped_region_)
+      return;
+    // Older records first, so that newer copies of the same key replace them in the index.
+    Header& file_header(header());
+    if (file_header.tail_offset >= file_header.write_offset)
+      ScanRecords(file_header.tail_offset, file_header.tail_end, lock);
+    ScanRecords(sizeof(Header), file_header.write_offset, lock);
+    LOG(kInfo) << "Loaded " << index_.size() << " entries from cache store " << kFilePath_;
+  }
+  loaded_ = true;
+}
+
+bool PersistentCacheStore::Get(const std::string& key, const ReadFunctor& read_functor) {
+  if (!loaded_)
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(index_.find(key));
+  if (itr == std::end(index_))
+    return false;
+  const Location& location(itr->second);
+  read_functor(data() + location.offset + sizeof(RecordHeader) + location.key_size,
+               location.value_size);
+  return true;
+}
+
+void PersistentCacheStore::Add(const std::string& key, const std::string& value) {
+  uint64_t record_size(sizeof(RecordHeader) + key.size() + value.size());
+  if (!loaded_ || kCapacity_ < sizeof(Header) || record_size > kCapacity_ - sizeof(Header))
+    return;
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!mapped_region_)
+    return;
+
+  Header& file_header(header());
+  if (file_header.write_offset + record_size > kCapacity_) {
+    // Wrap: records written since the last wrap become the tail, older ones are dropped.
+    RemoveRecords(file_header.write_offset, kCapacity_, lock);
+    file_header.tail_offset = sizeof(Header);
+    file_header.tail_end = file_header.write_offset;
+    file_header.write_offset = sizeof(Header);
+  }
+
+  uint64_t offset(file_header.write_offset);
+  RemoveRecords(offset, offset + record_size, lock);
+  RecordHeader record_header = {kRecordMagic, static_cast<uint32_t>(key.size()),
+                                static_cast<uint32_t>(value.size())};
+  std::memcpy(data() + offset, &record_header, sizeof(record_header));
+  std::memcpy(data() + offset + sizeof(record_header), key.data(), key.size());
+  std::memcpy(data() + offset + sizeof(record_header) + key.size(), value.data(), value.size());
+
+  file_header.write_offset = offset + record_size;
+  auto first_surviving(keys_by_offset_.lower_bound(file_header.write_offset));
+  file_header.tail_offset = (first_surviving == std::end(keys_by_offset_))
+                                ? file_header.tail_end
+                                : std::max(first_surviving->first, file_header.write_offset);
+  if (file_header.tail_offset > file_header.tail_end)
+    file_header.tail_offset = file_header.tail_end;
+  Index(key, Location(offset, record_header.key_size, record_header.value_size), lock);
+}
+
+size_t PersistentCacheStore::size() {
+  if (!loaded_)
+    return 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size();
+}
+
+void PersistentCacheStore::Map(std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  if (kCapacity_ < sizeof(Header))
+    return;
+
+  boost::system::error_code ec;
+  bool reuse_file(fs::exists(kFilePath_, ec) && fs::file_size(kFilePath_, ec) == kCapacity_);
+  if (!reuse_file) {
+    { std::ofstream create_file(kFilePath_.string().c_str(), std::ios::binary | std::ios::trunc); }
+    fs::resize_file(kFilePath_, kCapacity_, ec);
+    if (ec) {
+      LOG(kError) << "Failed to create cache store " << kFilePath_ << ": " << ec.message();
+      return;
+    }
+  }
+
+  try {
+    file_mapping_.reset(new bi::file_mapping(kFilePath_.string().c_str(), bi::read_write));
+    mapped_region_.reset(new bi::mapped_region(*file_mapping_, bi::read_write));
+  }
+  catch (const bi::interprocess_exception& e) {
+    LOG(kError) << "Failed to map cache store " << kFilePath_ << ": " << e.what();
+    mapped_region_.reset();
+    file_mapping_.reset();
+    return;
+  }
+
+  Header& file_header(header());
+  if (!reuse_file || file_header.magic != kFileMagic || file_header.capacity != kCapacity_ ||
+      file_header.write_offset < sizeof(Header) || file_header.write_offset > kCapacity_ ||
+      file_header.tail_offset > file_header.tail_end || file_header.tail_end > kCapacity_) {
+    file_header.magic = kFileMagic;
+    file_header.capacity = kCapacity_;
+    file_header.write_offset = sizeof(Header);
+    file_header.tail_offset = sizeof(Header);
+    file_header.tail_end = sizeof(Header);
+  }
+}
+
+void PersistentCacheStore::ScanRecords(uint64_t begin, uint64_t end,
+                                       std::unique_lock<std::mutex>& lock) {
+  uint64_t offset(begin);
+  while (offset + sizeof(RecordHeader) <= end) {
+    RecordHeader record_header;
+    std::memcpy(&record_header, data() + offset, sizeof(record_header));
+    uint64_t record_size(sizeof(RecordHeader) + record_header.key_size + record_header.value_size);
+    if (record_header.magic != kRecordMagic || offset + record_size > end) {
+      LOG(kWarning) << "Corrupt record at offset " << offset << " in cache store " << kFilePath_;
+      return;
+    }
+    Index(std::string(data() + offset + sizeof(RecordHeader), record_header.key_size),
+          Location(offset, record_header.key_size, record_header.value_size), lock);
+    offset += record_size;
+  }
+}
+
+void PersistentCacheStore::Index(const std::string& key, const Location& location,
+                                 std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  auto itr(index_.find(key));
+  if (itr != std::end(index_)) {
+    keys_by_offset_.erase(itr->second.offset);
+    itr->second = location;
+  } else {
+    index_.insert(std::make_pair(key, location));
+  }
+  keys_by_offset_[location.offset] = key;
+}
+
+void PersistentCacheStore::RemoveRecords(uint64_t begin, uint64_t end,
+                                         std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  auto itr(keys_by_offset_.lower_bound(begin));
+  while (itr != std::end(keys_by_offset_) && itr->first < end) {
+    index_.erase(itr->second);
+    itr = keys_by_offset_.erase(itr);
+  }
+}
+
+PersistentCacheStore::Header& PersistentCacheStore::header() {
+  return *static_cast<Header*>(mapped_region_->get_address());
+}
+
+char* PersistentCacheStore::data() { return static_cast<char*>(mapped_region_->get_address()); }
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,115 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PERSISTENT_CACHE_STORE_H_
+#define MAIDSAFE_ROUTING_PERSISTENT_CACHE_STORE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "boost/filesystem/path.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class PersistentCacheStoreTest_BEH_Wrap_Test;
+}
+
+// File-backed store of cached responses which survives restarts.  The file is created with a
+// fixed size of 'capacity' bytes and memory-mapped.  Records are appended one after another; when
+// the end of the file is reached writing wraps back to the start, overwriting the oldest records.
+// The index of keys to records is held in memory and is rebuilt by Load, which scans the file.
+// Construction only maps the file, so the owner can run Load on a background task rather than
+// delaying startup.
+class PersistentCacheStore {
+ public:
+  typedef std::function<void(const char* /*data*/, size_t /*size*/)> ReadFunctor;
+
+  PersistentCacheStore(boost::filesystem::path file_path, uint64_t capacity);
+  ~PersistentCacheStore();
+  // Indexes the records already in the file.  Until this has finished, Get misses and Add is
+  // ignored.
+  void Load();
+  // If a value is held for key, read_functor is invoked with a pointer directly into the mapped
+  // file and true is returned.  The pointer is only valid for the duration of the call.
+  bool Get(const std::string& key, const ReadFunctor& read_functor);
+  // Values too large to ever fit in the file are not held.
+  void Add(const std::string& key, const std::string& value);
+  size_t size();
+
+  friend class test::PersistentCacheStoreTest_BEH_Wrap_Test;
+
+ private:
+  struct Header {
+    uint64_t magic;
+    uint64_t capacity;
+    uint64_t write_offset;  // end of the records written since the last wrap
+    uint64_t tail_offset;   // start of the surviving records written before the last wrap
+    uint64_t tail_end;      // end of the surviving records written before the last wrap
+  };
+
+  struct RecordHeader {
+    uint32_t magic;
+    uint32_t key_size;
+    uint32_t value_size;
+  };
+
+  struct Location {
+    Location(uint64_t offset_in, uint32_t key_size_in, uint32_t value_size_in)
+        : offset(offset_in), key_size(key_size_in), value_size(value_size_in) {}
+    uint64_t offset;
+    uint32_t key_size;
+    uint32_t value_size;
+  };
+
+  PersistentCacheStore(const PersistentCacheStore&);
+  PersistentCacheStore(const PersistentCacheStore&&);
+  PersistentCacheStore& operator=(const PersistentCacheStore&);
+
+  void Map(std::unique_lock<std::mutex>& lock);
+  void ScanRecords(uint64_t begin, uint64_t end, std::unique_lock<std::mutex>& lock);
+  void Index(const std::string& key, const Location& location, std::unique_lock<std::mutex>& lock);
+  void RemoveRecords(uint64_t begin, uint64_t end, std::unique_lock<std::mutex>& lock);
+  Header& header();
+  char* data();
+
+  std::mutex mutex_;
+  const boost::filesystem::path kFilePath_;
+  const uint64_t kCapacity_;
+  std::unique_ptr<boost::interprocess::file_mapping> file_mapping_;
+  std::unique_ptr<boost::interprocess::mapped_region> mapped_region_;
+  std::unordered_map<std::string, Location> index_;
+  std::map<uint64_t, std::string> keys_by_offset_;
+  std::atomic<bool> loaded_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PERSISTENT_CACHE_STORE_H_
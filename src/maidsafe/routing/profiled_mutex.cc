@@ -0,0 +1,190 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/profiled_mutex.h"
+
+#ifdef ROUTING_LOCK_PROFILING
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#endif
+
+namespace maidsafe {
+
+namespace routing {
+
+#ifdef ROUTING_LOCK_PROFILING
+
+namespace detail {
+
+class LockProfile {
+ public:
+  LockProfile()
+      : acquisitions_(0),
+        wait_time_(),
+        hold_time_(),
+        longest_holds_mutex_(),
+        longest_holds_(),
+        shortest_kept_hold_(0) {}
+
+  void RecordAcquisition(const std::chrono::steady_clock::duration& wait_time) {
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    wait_time_.Record(wait_time);
+  }
+
+  void RecordHold(const std::chrono::steady_clock::duration& hold_time, const char* call_site) {
+    hold_time_.Record(hold_time);
+    // Most holds are shorter than every kept one, so avoid taking longest_holds_mutex_ for them.
+    if (hold_time.count() <= shortest_kept_hold_.load(std::memory_order_relaxed))
+      return;
+    std::lock_guard<std::mutex> lock(longest_holds_mutex_);
+    longest_holds_.push_back(std::make_pair(hold_time, call_site));
+    std::sort(std::begin(longest_holds_), std::end(longest_holds_),
+              [](const std::pair<std::chrono::steady_clock::duration, const char*>& lhs,
+                 const std::pair<std::chrono::steady_clock::duration, const char*>& rhs) {
+      return lhs.first > rhs.first;
+    });
+    if (longest_holds_.size() > kLongestHoldsKept) {
+      longest_holds_.pop_back();
+      shortest_kept_hold_ = longest_holds_.back().first.count();
+    }
+  }
+
+  LockStatistics Snapshot() {
+    LockStatistics statistics;
+    statistics.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    statistics.wait_time = wait_time_.Buckets();
+    statistics.hold_time = hold_time_.Buckets();
+    std::lock_guard<std::mutex> lock(longest_holds_mutex_);
+    for (const auto& hold : longest_holds_) {
+      statistics.longest_holds.push_back(std::make_pair(
+          std::chrono::duration_cast<std::chrono::microseconds>(hold.first),
+          std::string(hold.second)));
+    }
+    return statistics;
+  }
+
+ private:
+  static const size_t kLongestHoldsKept = 8;
+
+  LockProfile(const LockProfile&);
+  LockProfile(const LockProfile&&);
+  LockProfile& operator=(const LockProfile&);
+
+  std::atomic<uint64_t> acquisitions_;
+  LatencyHistogram wait_time_, hold_time_;
+  std::mutex longest_holds_mutex_;
+  std::vector<std::pair<std::chrono::steady_clock::duration, const char*>> longest_holds_;
+  std::atomic<std::chrono::steady_clock::rep> shortest_kept_hold_;
+};
+
+}  // namespace detail
+
+namespace {
+
+// Set by ProfiledMutex::At and consumed by the following lock() or try_lock() on the same thread.
+thread_local const char* next_call_site(nullptr);
+
+const char* TakeCallSite() {
+  const char* call_site(next_call_site);
+  next_call_site = nullptr;
+  return call_site ? call_site : "unknown";
+}
+
+// Profiles are never destroyed, so that mutexes with static storage duration may safely use them.
+struct Registry {
+  Registry() : mutex(), profiles() {}
+  std::mutex mutex;
+  std::map<std::string, detail::LockProfile*> profiles;
+};
+
+Registry& GetRegistry() {
+  static Registry* const registry(new Registry);
+  return *registry;
+}
+
+detail::LockProfile& GetProfile(const char* name) {
+  Registry& registry(GetRegistry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto itr(registry.profiles.find(name));
+  if (itr == std::end(registry.profiles)) {
+    itr = registry.profiles.insert(
+        std::make_pair(std::string(name), new detail::LockProfile)).first;
+  }
+  return *itr->second;
+}
+
+}  // unnamed namespace
+
+ProfiledMutex::ProfiledMutex(const char* name)
+    : mutex_(), profile_(GetProfile(name)), acquired_at_(), call_site_(nullptr) {}
+
+ProfiledMutex& ProfiledMutex::At(const char* call_site) {
+  next_call_site = call_site;
+  return *this;
+}
+
+void ProfiledMutex::lock() {
+  auto wait_start(std::chrono::steady_clock::now());
+  mutex_.lock();
+  acquired_at_ = std::chrono::steady_clock::now();
+  call_site_ = TakeCallSite();
+  profile_.RecordAcquisition(acquired_at_ - wait_start);
+}
+
+bool ProfiledMutex::try_lock() {
+  if (!mutex_.try_lock()) {
+    next_call_site = nullptr;
+    return false;
+  }
+  acquired_at_ = std::chrono::steady_clock::now();
+  call_site_ = TakeCallSite();
+  profile_.RecordAcquisition(std::chrono::steady_clock::duration(0));
+  return true;
+}
+
+void ProfiledMutex::unlock() {
+  auto hold_time(std::chrono::steady_clock::now() - acquired_at_);
+  const char* call_site(call_site_);
+  mutex_.unlock();
+  profile_.RecordHold(hold_time, call_site);
+}
+
+std::map<std::string, LockStatistics> GetLockStatistics() {
+  std::map<std::string, LockStatistics> lock_statistics;
+  Registry& registry(GetRegistry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& profile : registry.profiles)
+    lock_statistics[profile.first] = profile.second->Snapshot();
+  return lock_statistics;
+}
+
+#else
+
+std::map<std::string, LockStatistics> GetLockStatistics() {
+  return std::map<std::string, LockStatistics>();
+}
+
+#endif
+
+}  // namespace routing
+
+}  // namespace maidsafe
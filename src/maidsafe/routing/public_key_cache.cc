@@ -0,0 +1,120 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/public_key_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+PublicKeyCache::PublicKeyCache() : PublicKeyCache(SteadyClockNow()) {}
+
+PublicKeyCache::PublicKeyCache(NowFunctor now)
+    : kNow_(std::move(now)),
+      mutex_(),
+      kMaxSize_(Parameters::public_key_cache_size),
+      kLifetime_(Parameters::public_key_cache_lifetime),
+      entries_() {}
+
+PublicKeyCache::PublicKeyCache(size_t max_size,
+                               const std::chrono::steady_clock::duration& lifetime)
+    : kNow_(SteadyClockNow()), mutex_(), kMaxSize_(max_size), kLifetime_(lifetime), entries_() {}
+
+void PublicKeyCache::Add(const NodeId& node_id, const asymm::PublicKey& public_key) {
+  if (node_id.IsZero() || kMaxSize_ == 0)
+    return;
+  auto now(kNow_());
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto itr(entries_.find(node_id));
+  if (itr != std::end(entries_)) {
+    itr->second = Entry(public_key, now + kLifetime_);
+    return;
+  }
+  if (entries_.size() >= kMaxSize_) {
+    PruneExpired(now, lock);
+    if (entries_.size() >= kMaxSize_)
+      RemoveOldest(lock);
+  }
+  entries_.insert(std::make_pair(node_id, Entry(public_key, now + kLifetime_)));
+}
+
+bool PublicKeyCache::Get(const NodeId& node_id, asymm::PublicKey& public_key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(entries_.find(node_id));
+  if (itr == std::end(entries_))
+    return false;
+  if (itr->second.expiry_time < kNow_()) {
+    entries_.erase(itr);
+    return false;
+  }
+  public_key = itr->second.public_key;
+  return true;
+}
+
+bool PublicKeyCache::Contains(const NodeId& node_id, const asymm::PublicKey& public_key) {
+  asymm::PublicKey cached_key;
+  return Get(node_id, cached_key) && asymm::MatchingKeys(cached_key, public_key);
+}
+
+void PublicKeyCache::Remove(const NodeId& node_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(node_id);
+}
+
+size_t PublicKeyCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void PublicKeyCache::PruneExpired(const std::chrono::steady_clock::time_point& now,
+                                  std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  for (auto itr(std::begin(entries_)); itr != std::end(entries_);) {
+    if (itr->second.expiry_time < now)
+      itr = entries_.erase(itr);
+    else
+      ++itr;
+  }
+}
+
+void PublicKeyCache::RemoveOldest(std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  auto oldest(std::min_element(std::begin(entries_), std::end(entries_),
+                               [](const std::pair<const NodeId, Entry>& lhs,
+                                  const std::pair<const NodeId, Entry>& rhs) {
+    return lhs.second.expiry_time < rhs.second.expiry_time;
+  }));
+  if (oldest != std::end(entries_)) {
+    LOG(kVerbose) << "Public key cache full, evicting key for " << DebugId(oldest->first);
+    entries_.erase(oldest);
+  }
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,88 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
+#define MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/scheduler.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class PublicKeyCacheTest_BEH_Expiry_Test;
+}
+
+// Holds public keys which have already been validated, so that a peer reconnecting shortly after
+// dropping out doesn't need its key fetched from the upper layer and validated again.  Entries
+// expire 'lifetime' after being added.  When full, expired entries are removed first, followed by
+// the oldest entry.
+class PublicKeyCache {
+ public:
+  PublicKeyCache();
+  // Takes the time from 'now', e.g. the node's Scheduler.
+  explicit PublicKeyCache(NowFunctor now);
+  PublicKeyCache(size_t max_size, const std::chrono::steady_clock::duration& lifetime);
+  // Only keys which have passed asymm::ValidateKey should be added.
+  void Add(const NodeId& node_id, const asymm::PublicKey& public_key);
+  // Returns false if no unexpired key is held for node_id.
+  bool Get(const NodeId& node_id, asymm::PublicKey& public_key);
+  // Returns true if an unexpired key is held for node_id and it matches public_key.
+  bool Contains(const NodeId& node_id, const asymm::PublicKey& public_key);
+  void Remove(const NodeId& node_id);
+  size_t size() const;
+
+  friend class test::PublicKeyCacheTest_BEH_Expiry_Test;
+
+ private:
+  struct Entry {
+    Entry(const asymm::PublicKey& public_key_in,
+          const std::chrono::steady_clock::time_point& expiry_time_in)
+        : public_key(public_key_in), expiry_time(expiry_time_in) {}
+    asymm::PublicKey public_key;
+    std::chrono::steady_clock::time_point expiry_time;
+  };
+
+  PublicKeyCache(const PublicKeyCache&);
+  PublicKeyCache(const PublicKeyCache&&);
+  PublicKeyCache& operator=(const PublicKeyCache&);
+
+  void PruneExpired(const std::chrono::steady_clock::time_point& now,
+                    std::unique_lock<std::mutex>& lock);
+  void RemoveOldest(std::unique_lock<std::mutex>& lock);
+
+  const NowFunctor kNow_;
+  mutable std::mutex mutex_;
+  const size_t kMaxSize_;
+  const std::chrono::steady_clock::duration kLifetime_;
+  std::map<NodeId, Entry> entries_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_PUBLIC_KEY_CACHE_H_
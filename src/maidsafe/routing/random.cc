@@ -0,0 +1,56 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/random.h"
+
+#include <mutex>
+#include <random>
+
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+std::mutex& EngineMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::mt19937& Engine() {
+  static std::mt19937 engine(maidsafe::RandomUint32());
+  return engine;
+}
+
+}  // unnamed namespace
+
+uint32_t SeededRandomUint32() {
+  std::lock_guard<std::mutex> lock(EngineMutex());
+  return static_cast<uint32_t>(Engine()());
+}
+
+void SeedRandom(uint32_t seed) {
+  std::lock_guard<std::mutex> lock(EngineMutex());
+  Engine().seed(seed);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -20,6 +20,8 @@
 
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/routing/random.h"
+
 namespace maidsafe {
 
 namespace routing {
@@ -29,7 +31,7 @@ NodeId RandomNodeHelper::Get() const {
   assert(node_ids_.size() <= kMaxSize_);
   if (node_ids_.empty())
     return NodeId();
-  return node_ids_[(node_ids_.size() == kMaxSize_) ? 0 : (RandomUint32() % node_ids_.size())];
+  return node_ids_[(node_ids_.size() == kMaxSize_) ? 0 : (SeededRandomUint32() % node_ids_.size())];
 }
 
 void RandomNodeHelper::Add(const NodeId& node_id) {
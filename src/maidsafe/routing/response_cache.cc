@@ -0,0 +1,97 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/response_cache.h"
+
+#include <cassert>
+
+#include "maidsafe/common/crypto.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+ResponseCache::ResponseCache(uint64_t max_bytes)
+    : mutex_(), kMaxBytes_(max_bytes), bytes_(0), entries_(), index_() {}
+
+std::string ResponseCache::Key(int32_t type, const std::string& destination_id,
+                               const std::string& request) {
+  // The destination's length is included so that no two distinct requests hash the same bytes.
+  return crypto::Hash<crypto::SHA512>(std::to_string(type) + ':' +
+                                      std::to_string(destination_id.size()) + ':' +
+                                      destination_id + request).string();
+}
+
+bool ResponseCache::Get(const std::string& key, std::string& response) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(index_.find(key));
+  if (itr == std::end(index_))
+    return false;
+  entries_.splice(std::begin(entries_), entries_, itr->second);
+  response = itr->second->second;
+  return true;
+}
+
+void ResponseCache::Add(const std::string& key, const std::string& response) {
+  uint64_t entry_size(EntrySize(key, response));
+  if (entry_size > kMaxBytes_)
+    return;
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto itr(index_.find(key));
+  if (itr != std::end(index_)) {
+    bytes_ -= EntrySize(key, itr->second->second);
+    entries_.erase(itr->second);
+    index_.erase(itr);
+  }
+  while (bytes_ + entry_size > kMaxBytes_)
+    RemoveLeastRecentlyUsed(lock);
+  entries_.emplace_front(key, response);
+  index_.insert(std::make_pair(key, std::begin(entries_)));
+  bytes_ += entry_size;
+}
+
+size_t ResponseCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+uint64_t ResponseCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+uint64_t ResponseCache::EntrySize(const std::string& key, const std::string& response) {
+  return key.size() + response.size();
+}
+
+void ResponseCache::RemoveLeastRecentlyUsed(std::unique_lock<std::mutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  assert(!entries_.empty());
+  const auto& least_recently_used(entries_.back());
+  LOG(kVerbose) << "Response cache full, evicting " << HexSubstr(least_recently_used.first);
+  bytes_ -= EntrySize(least_recently_used.first, least_recently_used.second);
+  index_.erase(least_recently_used.first);
+  entries_.pop_back();
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
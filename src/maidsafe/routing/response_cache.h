@@ -0,0 +1,78 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_RESPONSE_CACHE_H_
+#define MAIDSAFE_ROUTING_RESPONSE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+class ResponseCacheTest_BEH_Eviction_Test;
+}
+
+// Least-recently-used store of responses to cacheable requests, keyed by a hash of each request's
+// type, destination and contents and bounded by the total size in bytes of the held keys and
+// responses.  A budget of 0 disables the cache.
+class ResponseCache {
+ public:
+  explicit ResponseCache(uint64_t max_bytes);
+  // Returns the key under which the response to a request of 'type' to 'destination_id' with
+  // contents 'request' is held.
+  static std::string Key(int32_t type, const std::string& destination_id,
+                         const std::string& request);
+  // Returns false if no response is held for key.  A successful lookup marks the entry as most
+  // recently used.
+  bool Get(const std::string& key, std::string& response);
+  // Responses larger than the whole budget are not held.
+  void Add(const std::string& key, const std::string& response);
+  size_t size() const;
+  uint64_t bytes() const;
+
+  friend class test::ResponseCacheTest_BEH_Eviction_Test;
+
+ private:
+  typedef std::list<std::pair<std::string, std::string>> EntryList;
+
+  ResponseCache(const ResponseCache&);
+  ResponseCache(const ResponseCache&&);
+  ResponseCache& operator=(const ResponseCache&);
+
+  static uint64_t EntrySize(const std::string& key, const std::string& response);
+  void RemoveLeastRecentlyUsed(std::unique_lock<std::mutex>& lock);
+
+  mutable std::mutex mutex_;
+  const uint64_t kMaxBytes_;
+  uint64_t bytes_;
+  EntryList entries_;  // most recently used at the front
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_RESPONSE_CACHE_H_
@@ -35,6 +35,7 @@
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/rpcs.h"
+#include "maidsafe/routing/scoped_probe.h"
 #include "maidsafe/routing/utils.h"
 
 namespace bptime = boost::posix_time;
@@ -51,6 +52,13 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
   const int kMaxUnvalidatedUpdates(64);
 #endif
 
+size_t MemoryUsage(const std::deque<std::pair<NodeId, std::vector<NodeInfo>>>& matrix_updates) {
+  size_t bytes(matrix_updates.size() * sizeof(std::pair<NodeId, std::vector<NodeInfo>>));
+  for (const auto& matrix_update : matrix_updates)
+    bytes += MemoryUsage(matrix_update.second);
+  return bytes;
+}
+
 }  // unnamed namespace
 
 ResponseHandler::ResponseHandler(RoutingTable& routing_table,
@@ -58,7 +66,8 @@ ResponseHandler::ResponseHandler(RoutingTable& routing_table,
                                  GroupChangeHandler& group_change_handler)
     : mutex_(), routing_table_(routing_table), client_routing_table_(client_routing_table),
       network_(network), group_change_handler_(group_change_handler), request_public_key_functor_(),
-      unvalidated_matrix_updates() {}
+      request_public_keys_functor_(), unvalidated_matrix_updates(),
+      unvalidated_matrix_updates_memory_(MemorySubsystem::kUnvalidatedMatrixUpdates) {}
 
 ResponseHandler::~ResponseHandler() {}
 
@@ -147,6 +156,7 @@ void ResponseHandler::Connect(protobuf::Message& message) {
 }
 
 void ResponseHandler::FindNodes(const protobuf::Message& message) {
+  ROUTING_PROBE("ResponseHandler::FindNodes");
   protobuf::FindNodesResponse find_nodes_response;
   protobuf::FindNodesRequest find_nodes_request;
   if (!find_nodes_response.ParseFromString(message.data(0))) {
@@ -157,6 +167,7 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
     LOG(kError) << "Could not parse original find node request";
     return;
   }
+  routing_table_.join_timing().Record(JoinTiming::Phase::kFirstFindNodesResponse);
 
   if (find_nodes_request.num_nodes_requested() == 1) {  // detect collision
     if ((find_nodes_response.nodes_size() == 1) &&
@@ -183,10 +194,14 @@ void ResponseHandler::FindNodes(const protobuf::Message& message) {
 
   LOG(kVerbose) << find_node_result;
 
+  std::vector<NodeId> found_nodes;
   for (int i = 0; i < find_nodes_response.nodes_size(); ++i) {
     if (!find_nodes_response.nodes(i).empty())
-      CheckAndSendConnectRequest(NodeId(find_nodes_response.nodes(i)));
+      found_nodes.push_back(NodeId(find_nodes_response.nodes(i)));
   }
+  RequestPublicKeys(found_nodes);
+  for (const auto& node_id : found_nodes)
+    CheckAndSendConnectRequest(node_id);
 }
 
 void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
@@ -239,6 +254,7 @@ void ResponseHandler::SendConnectRequest(const NodeId peer_node_id) {
         routing_table_.client_mode(), this_nat_type, relay_message, relay_connection_id));
     LOG(kVerbose) << "Sending Connect RPC to " << DebugId(peer.node_id)
                   << " message id : " << connect_rpc.id();
+    routing_table_.join_timing().ConnectRequestSent(peer.node_id);
     if (send_to_bootstrap_connection)
       network_.SendToDirect(connect_rpc, network_.bootstrap_connection_id(),
                             network_.bootstrap_connection_id());
@@ -303,7 +319,9 @@ void ResponseHandler::ValidateAndCompleteConnectionToClient(const NodeInfo& peer
 void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
     const NodeInfo& peer, bool from_requestor, const std::vector<NodeId>& close_ids) {
   std::weak_ptr<ResponseHandler> response_handler_weak_ptr = shared_from_this();
-  if (request_public_key_functor_) {
+  asymm::PublicKey cached_public_key;
+  bool use_cached_key(routing_table_.public_key_cache().Get(peer.node_id, cached_public_key));
+  if (use_cached_key || request_public_key_functor_) {
     auto validate_node([=](const asymm::PublicKey& key) {
       LOG(kInfo) << "Validation callback called with public key for " << DebugId(peer.node_id);
       if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock()) {
@@ -318,6 +336,7 @@ void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
           if (matrix_update_itr != std::end(unvalidated_matrix_updates)) {
             matrix_update = matrix_update_itr->second;
             unvalidated_matrix_updates.erase(matrix_update_itr);
+            unvalidated_matrix_updates_memory_.Update(MemoryUsage(unvalidated_matrix_updates));
           }
         }
         if (ValidateAndAddToRoutingTable(response_handler->network_,
@@ -332,7 +351,12 @@ void ResponseHandler::ValidateAndCompleteConnectionToNonClient(
         }
       }
     });
-    request_public_key_functor_(peer.node_id, validate_node);
+    if (use_cached_key) {
+      LOG(kVerbose) << "Validation -- using cached public key for " << DebugId(peer.node_id);
+      validate_node(cached_public_key);
+    } else {
+      request_public_key_functor_(peer.node_id, validate_node);
+    }
   }
 }
 
@@ -356,6 +380,7 @@ void ResponseHandler::HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool
 
 void ResponseHandler::HandleSuccessAcknowledgementAsRequestor(
     const std::vector<NodeId>& close_ids) {
+  RequestPublicKeys(close_ids);
   for (const auto& i : close_ids) {
     if (!i.IsZero()) {
       CheckAndSendConnectRequest(i);
@@ -373,6 +398,47 @@ void ResponseHandler::CheckAndSendConnectRequest(const NodeId& node_id) {
     SendConnectRequest(node_id);
 }
 
+// Resolves in one call the keys of peers this node is likely to connect to, so that the later
+// per-peer validation can be served from the public key cache.
+void ResponseHandler::RequestPublicKeys(const std::vector<NodeId>& node_ids) {
+  if (!request_public_keys_functor_)
+    return;
+  std::vector<NodeId> unknown_node_ids;
+  asymm::PublicKey public_key;
+  for (const auto& node_id : node_ids) {
+    if (!node_id.IsZero() && node_id != routing_table_.kNodeId() &&
+        !routing_table_.public_key_cache().Get(node_id, public_key))
+      unknown_node_ids.push_back(node_id);
+  }
+  if (unknown_node_ids.empty())
+    return;
+
+  LOG(kVerbose) << "[" << DebugId(routing_table_.kNodeId()) << "] requesting public keys for "
+                << unknown_node_ids.size() << " nodes";
+  std::weak_ptr<ResponseHandler> response_handler_weak_ptr = shared_from_this();
+  request_public_keys_functor_(
+      unknown_node_ids,
+      [response_handler_weak_ptr, unknown_node_ids](
+          std::vector<std::pair<NodeId, asymm::PublicKey>> public_keys) {
+        if (std::shared_ptr<ResponseHandler> response_handler = response_handler_weak_ptr.lock()) {
+          for (const auto& public_key : public_keys) {
+            if (std::find(std::begin(unknown_node_ids), std::end(unknown_node_ids),
+                          public_key.first) == std::end(unknown_node_ids)) {
+              LOG(kWarning) << "Ignoring unrequested public key for node "
+                            << DebugId(public_key.first);
+              continue;
+            }
+            if (!asymm::ValidateKey(public_key.second)) {
+              LOG(kInfo) << "Invalid public key for node " << DebugId(public_key.first);
+              continue;
+            }
+            response_handler->routing_table_.public_key_cache().Add(public_key.first,
+                                                                    public_key.second);
+          }
+        }
+      });
+}
+
 void ResponseHandler::CloseNodeUpdateForClient(protobuf::Message& message) {
   assert(routing_table_.client_mode());
   if (message.destination_id() != routing_table_.kNodeId().string()) {
@@ -416,6 +482,7 @@ void ResponseHandler::AddMatrixUpdateFromUnvalidatedPeer(
                                                                                 matrix_update));
   else
     matrix_update_itr->second = matrix_update;
+  unvalidated_matrix_updates_memory_.Update(MemoryUsage(unvalidated_matrix_updates));
   LOG(kVerbose) << "unvalidated_matrix_updates.size() " << unvalidated_matrix_updates.size();
   assert(unvalidated_matrix_updates.size() < kMaxUnvalidatedUpdates);
 }
@@ -440,6 +507,11 @@ RequestPublicKeyFunctor ResponseHandler::request_public_key_functor() const {
   return request_public_key_functor_;
 }
 
+void ResponseHandler::set_request_public_keys_functor(
+    RequestPublicKeysFunctor request_public_keys) {
+  request_public_keys_functor_ = request_public_keys;
+}
+
 }  // namespace routing
 
 }  // namespace maidsafe
@@ -32,6 +32,7 @@
 #include "maidsafe/rudp/managed_connections.h"
 
 #include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/memory_accounting.h"
 #include "maidsafe/routing/timer.h"
 
 namespace maidsafe {
@@ -62,6 +63,7 @@ class ResponseHandler : public std::enable_shared_from_this<ResponseHandler> {
   virtual void ConnectSuccessAcknowledgement(protobuf::Message& message);
   void set_request_public_key_functor(RequestPublicKeyFunctor request_public_key);
   RequestPublicKeyFunctor request_public_key_functor() const;
+  void set_request_public_keys_functor(RequestPublicKeysFunctor request_public_keys);
   void GetGroup(Timer<std::string>& timer, protobuf::Message& message);
   void CloseNodeUpdateForClient(protobuf::Message& message);
   void AddMatrixUpdateFromUnvalidatedPeer(const NodeId& node_id,
@@ -72,6 +74,7 @@ class ResponseHandler : public std::enable_shared_from_this<ResponseHandler> {
  private:
   void SendConnectRequest(const NodeId peer_node_id);
   void CheckAndSendConnectRequest(const NodeId& node_id);
+  void RequestPublicKeys(const std::vector<NodeId>& node_ids);
   void HandleSuccessAcknowledgementAsRequestor(const std::vector<NodeId>& close_ids);
   void HandleSuccessAcknowledgementAsReponder(NodeInfo peer, bool client);
   void ValidateAndCompleteConnectionToClient(const NodeInfo& peer, bool from_requestor,
@@ -85,7 +88,9 @@ class ResponseHandler : public std::enable_shared_from_this<ResponseHandler> {
   NetworkUtils& network_;
   GroupChangeHandler& group_change_handler_;
   RequestPublicKeyFunctor request_public_key_functor_;
+  RequestPublicKeysFunctor request_public_keys_functor_;
   std::deque<std::pair<NodeId, std::vector<NodeInfo>>> unvalidated_matrix_updates;
+  MemoryCharge unvalidated_matrix_updates_memory_;
 };
 
 }  // namespace routing
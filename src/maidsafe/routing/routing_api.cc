@@ -116,6 +116,8 @@ bool Routing::IsConnectedClient(const NodeId& node_id) {
   return pimpl_->IsConnectedClient(node_id);
 }
 
+Statistics Routing::GetStatistics() const { return pimpl_->GetStatistics(); }
+
 }  // namespace routing
 
 }  // namespace maidsafe
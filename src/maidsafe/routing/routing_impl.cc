@@ -18,8 +18,11 @@
 
 #include "maidsafe/routing/routing_impl.h"
 
+#include <cmath>
 #include <cstdint>
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "maidsafe/common/log.h"
 
@@ -30,7 +33,9 @@
 
 #include "maidsafe/routing/bootstrap_file_handler.h"
 #include "maidsafe/routing/message.h"
+#include "maidsafe/routing/memory_accounting.h"
 #include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/message_tracer.h"
 #include "maidsafe/routing/node_info.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
@@ -48,6 +53,32 @@ namespace {
 
 typedef boost::asio::ip::udp::endpoint Endpoint;
 
+// rudp doesn't say which connection a message arrived on, so captures record the node which passed
+// it on if known, otherwise its source.
+std::string CaptureConnectionId(const protobuf::Message& message) {
+  if (message.has_last_id())
+    return message.last_id();
+  if (message.has_source_id())
+    return message.source_id();
+  return message.relay_connection_id();
+}
+
+// A received message waiting for a routing thread.  Allocated with a CountingAllocator, and charges
+// its own message buffer, so that what is actually queued is charged to
+// MemorySubsystem::kQueuedHandlers until the handler has run or been discarded.
+struct QueuedMessage {
+  QueuedMessage(const std::string& message_in,
+                const std::chrono::steady_clock::time_point& receive_time_in)
+      : message(message_in), receive_time(receive_time_in) {
+    detail::GetMemoryAccount(MemorySubsystem::kQueuedHandlers).Add(message.capacity());
+  }
+  ~QueuedMessage() {
+    detail::GetMemoryAccount(MemorySubsystem::kQueuedHandlers).Subtract(message.capacity());
+  }
+  std::string message;
+  std::chrono::steady_clock::time_point receive_time;
+};
+
 }  // unnamed namespace
 
 namespace detail {}  // namespace detail
@@ -85,34 +116,50 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const GroupToSingleRelay
   proto_message.set_relay_connection_id(message.receiver.connection_id.string());
   proto_message.set_actual_destination_is_relay_id(true);
 
-  proto_message.set_id(RandomUint32() % 10000);  // Enable for tracing node level messages
+  proto_message.set_id(SeededRandomUint32() % 10000);  // Enable for tracing node level messages
   return proto_message;
 }
 
 Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys)
+    : Impl(client_mode, node_id, keys, std::unique_ptr<Scheduler>(new AsioScheduler(2)),
+           std::unique_ptr<Transport>(new RudpTransport)) {}
+
+Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                    std::unique_ptr<Scheduler> scheduler, std::unique_ptr<Transport> transport)
     : network_status_mutex_(),
       network_status_(kNotJoined),
       network_statistics_(node_id),
-      routing_table_(client_mode, node_id, keys, network_statistics_),
+      // scheduler_ is declared later, but the routing table only reads the time once constructed.
+      routing_table_(client_mode, node_id, keys, network_statistics_,
+                     [this] { return scheduler_->Now(); }),
       kNodeId_(node_id),
       running_(true),
-      running_mutex_(),
+      running_mutex_("Routing::Impl"),
+      bytes_received_(0),
+      receive_queue_depth_(0),
       functors_(),
       random_node_helper_(),
       // TODO(Prakash) : don't create client_routing_table for client nodes (wrap both)
       client_routing_table_(node_id),
       remove_furthest_node_(routing_table_, network_),
       group_change_handler_(routing_table_, client_routing_table_, network_),
+      message_capture_(),
       message_handler_(),
-      asio_service_(2),
-      network_(routing_table_, client_routing_table_),
-      timer_(asio_service_),
-      re_bootstrap_timer_(asio_service_.service()),
-      recovery_timer_(asio_service_.service()),
-      setup_timer_(asio_service_.service()) {
+      scheduler_(std::move(scheduler)),
+      network_(routing_table_, client_routing_table_, std::move(transport), *scheduler_),
+      timer_(*scheduler_),
+      re_bootstrap_timer_(scheduler_->MakeAlarm()),
+      recovery_timer_(scheduler_->MakeAlarm()),
+      setup_timer_(scheduler_->MakeAlarm()) {
   message_handler_.reset(new MessageHandler(routing_table_, client_routing_table_, network_, timer_,
                                             remove_furthest_node_, group_change_handler_,
                                             network_statistics_));
+  if (!Parameters::message_capture_directory.empty()) {
+    message_capture_.reset(new MessageCapture(
+        Parameters::message_capture_directory /
+            ("routing_capture_" + kNodeId_.ToStringEncoded(NodeId::EncodingType::kHex)),
+        kNodeId_, Parameters::message_capture_size));
+  }
   LOG(kInfo) << (client_mode ? "client " : "non-client ") << "node. Id : " << DebugId(kNodeId_);
   assert((client_mode || !node_id.IsZero()) && "Server Nodes cannot be created without valid keys");
 }
@@ -120,7 +167,9 @@ Routing::Impl::Impl(bool client_mode, const NodeId& node_id, const asymm::Keys&
 Routing::Impl::~Impl() {
   LOG(kVerbose) << "~Impl " << DebugId(kNodeId_) << ", connection id "
                 << DebugId(routing_table_.kConnectionId());
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  // The scheduler is destroyed before the message handler, so the cache's alarm must go first.
+  message_handler_->StopCaching();
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   running_ = false;
 }
 
@@ -149,7 +198,8 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
                                     [this]() { remove_furthest_node_.RemoveNodeRequest(); },
                                     [this](const std::vector<NodeInfo> new_nodes,
                                            const std::vector<NodeInfo> old_nodes) {
-                                      std::lock_guard<std::mutex> lock(running_mutex_);
+                                      std::lock_guard<ProfiledMutex> lock(
+                                          ROUTING_LOCK(running_mutex_));
                                       if (running_)
                                         group_change_handler_.SendClosestNodesUpdateRpcs(new_nodes,
                                                                                          old_nodes);
@@ -173,6 +223,7 @@ void Routing::Impl::ConnectFunctors(const Functors& functors) {
     message_handler_->set_typed_message_and_caching_functor(functors.typed_message_and_caching);
 
   message_handler_->set_request_public_key_functor(functors.request_public_key);
+  message_handler_->set_request_public_keys_functor(functors.request_public_keys);
   network_.set_new_bootstrap_endpoint_functor(functors.new_bootstrap_endpoint);
 }
 
@@ -192,9 +243,11 @@ void Routing::Impl::BootstrapFromTheseEndpoints(const std::vector<Endpoint>& end
 }
 
 void Routing::Impl::DoJoin(const std::vector<Endpoint>& endpoints) {
+  routing_table_.join_timing().Start();
   int return_value(DoBootstrap(endpoints));
   if (kSuccess != return_value)
     return NotifyNetworkStatus(return_value);
+  routing_table_.join_timing().Record(JoinTiming::Phase::kBootstrapped);
 
   assert(!network_.bootstrap_connection_id().IsZero() &&
          "Bootstrap connection id must be populated by now.");
@@ -205,9 +258,9 @@ void Routing::Impl::DoJoin(const std::vector<Endpoint>& endpoints) {
 int Routing::Impl::DoBootstrap(const std::vector<Endpoint>& endpoints) {
   // FIXME race condition if a new connection appears at rudp -- rudp should handle this
   assert(routing_table_.size() == 0);
-  recovery_timer_.cancel();
-  setup_timer_.cancel();
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  recovery_timer_->Cancel();
+  setup_timer_->Cancel();
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   if (!running_)
     return kNetworkShuttingDown;
   if (!network_.bootstrap_connection_id().IsZero()) {
@@ -224,7 +277,7 @@ int Routing::Impl::DoBootstrap(const std::vector<Endpoint>& endpoints) {
 
 void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code, int attempts) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
@@ -237,14 +290,14 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
            "Relay connection id should be set after bootstrapping succeeds");
   } else {
     if (routing_table_.size() > 0) {
-      std::lock_guard<std::mutex> lock(running_mutex_);
+      std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
       if (!running_)
         return;
       // Exit the loop & start recovery loop
       LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] Added a node in routing table."
                     << " Terminating setup loop & Scheduling recovery loop.";
-      recovery_timer_.expires_from_now(Parameters::find_node_interval);
-      recovery_timer_.async_wait([=](const boost::system::error_code & error_code) {
+      recovery_timer_->ExpiresFromNow(Parameters::find_node_interval);
+      recovery_timer_->AsyncWait([=](const boost::system::error_code & error_code) {
         if (error_code != boost::asio::error::operation_aborted)
           ReSendFindNodeRequest(error_code, false);
       });
@@ -279,11 +332,11 @@ void Routing::Impl::FindClosestNode(const boost::system::error_code& error_code,
   ++attempts;
   network_.SendToDirect(find_node_rpc, network_.bootstrap_connection_id(), message_sent_functor);
 
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   if (!running_)
     return;
-  setup_timer_.expires_from_now(Parameters::find_close_node_interval);
-  setup_timer_.async_wait([=](boost::system::error_code error_code_local) {
+  setup_timer_->ExpiresFromNow(Parameters::find_close_node_interval);
+  setup_timer_->AsyncWait([=](boost::system::error_code error_code_local) {
     if (error_code_local != boost::asio::error::operation_aborted)
       FindClosestNode(error_code_local, attempts);
   });
@@ -293,6 +346,7 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
                                  const Endpoint& peer_endpoint, const NodeInfo& peer_info) {
   assert((!routing_table_.client_mode()) && "no client nodes allowed in zero state network");
   ConnectFunctors(functors);
+  routing_table_.join_timing().Start();
   int result(network_.Bootstrap(
       std::vector<Endpoint>(1, peer_endpoint),
       [=](const std::string & message) { OnMessageReceived(message); },
@@ -304,6 +358,7 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
                 << " with peer endpoint : " << peer_endpoint;
     return result;
   }
+  routing_table_.join_timing().Record(JoinTiming::Phase::kBootstrapped);
 
   LOG(kInfo) << "[" << DebugId(kNodeId_)
              << "]'s bootstrap connection id : " << DebugId(network_.bootstrap_connection_id());
@@ -317,7 +372,7 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
   rudp::EndpointPair this_endpoint_pair;
   peer_endpoint_pair.external = peer_endpoint_pair.local = peer_endpoint;
   this_endpoint_pair.external = this_endpoint_pair.local = local_endpoint;
-  Sleep(std::chrono::milliseconds(100));  // FIXME avoiding assert in rudp
+  scheduler_->Sleep(std::chrono::milliseconds(100));  // FIXME avoiding assert in rudp
   result = network_.GetAvailableEndpoint(peer_info.node_id, peer_endpoint_pair, this_endpoint_pair,
                                          nat_type);
   if (result != rudp::kBootstrapConnectionAlreadyExists) {
@@ -336,18 +391,18 @@ int Routing::Impl::ZeroStateJoin(const Functors& functors, const Endpoint& local
   // Now poll for routing table size to have other zero state peer.
   uint8_t poll_count(0);
   do {
-    Sleep(std::chrono::milliseconds(100));
+    scheduler_->Sleep(std::chrono::milliseconds(100));
   } while ((routing_table_.size() == 0) && (++poll_count < 50));
   if (routing_table_.size() != 0) {
     LOG(kInfo) << "Node Successfully joined zero state network, with "
                << DebugId(network_.bootstrap_connection_id()) << ", Routing table size - "
                << routing_table_.size() << ", Node id : " << DebugId(kNodeId_);
 
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return kNetworkShuttingDown;
-    recovery_timer_.expires_from_now(Parameters::find_node_interval);
-    recovery_timer_.async_wait([=](const boost::system::error_code & error_code) {
+    recovery_timer_->ExpiresFromNow(Parameters::find_node_interval);
+    recovery_timer_->AsyncWait([=](const boost::system::error_code & error_code) {
       if (error_code != boost::asio::error::operation_aborted)
         ReSendFindNodeRequest(error_code, false);
     });
@@ -415,10 +470,10 @@ void Routing::Impl::PartiallyJoinedSend(protobuf::Message& proto_message) {
   NodeId bootstrap_connection_id(network_.bootstrap_connection_id());
   assert(proto_message.has_relay_connection_id() && "did not set this_node_relay_connection_id");
   rudp::MessageSentFunctor message_sent([=](int result) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
-    asio_service_.service().post([=]() {
+    scheduler_->Post([=]() {
       if (rudp::kSuccess != result) {
         if (proto_message.id() != 0) {
           try {
@@ -529,14 +584,36 @@ std::future<std::vector<NodeId>> Routing::Impl::GetGroup(const NodeId& group_id)
 }
 
 void Routing::Impl::OnMessageReceived(const std::string& message) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (running_)
-    asio_service_.service().post([=]() { DoOnMessageReceived(message); });  // NOLINT (Fraser)
+  bytes_received_ += message.size();
+  auto receive_time(TracingEnabled() ? std::chrono::steady_clock::now()
+                                     : std::chrono::steady_clock::time_point());
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
+  if (running_) {
+    ++receive_queue_depth_;
+    auto queued(std::allocate_shared<QueuedMessage>(
+        CountingAllocator<QueuedMessage, MemorySubsystem::kQueuedHandlers>(), message,
+        receive_time));
+    scheduler_->Post([this, queued]() {
+      --receive_queue_depth_;
+      DoOnMessageReceived(queued->message, queued->receive_time);
+    });
+  }
 }
 
-void Routing::Impl::DoOnMessageReceived(const std::string& message) {
+void Routing::Impl::DoOnMessageReceived(
+    const std::string& message, const std::chrono::steady_clock::time_point& receive_time) {
+  auto parse_start(TracingEnabled() ? std::chrono::steady_clock::now()
+                                    : std::chrono::steady_clock::time_point());
   protobuf::Message pb_message;
-  if (pb_message.ParseFromString(message)) {
+  bool parsed(pb_message.ParseFromString(message));
+  if (message_capture_)
+    message_capture_->Record(message, parsed ? CaptureConnectionId(pb_message) : std::string());
+  if (parsed) {
+    TraceKey trace_key(pb_message);
+    if (trace_key.sampled) {
+      RecordTraceSpan("QueueWait", trace_key, receive_time, parse_start);
+      RecordTraceSpan("Parse", trace_key, parse_start, std::chrono::steady_clock::now());
+    }
     bool relay_message(!pb_message.has_source_id());
     LOG(kVerbose) << "   [" << DebugId(kNodeId_) << "] rcvd : " << MessageTypeString(pb_message)
                   << " from " << (relay_message ? HexSubstr(pb_message.relay_id())
@@ -550,10 +627,11 @@ void Routing::Impl::DoOnMessageReceived(const std::string& message) {
         random_node_helper_.Add(source_id);
     }
     {
-      std::lock_guard<std::mutex> lock(running_mutex_);
+      std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
       if (!running_)
         return;
     }
+    ScopedTraceSpan trace_span("HandleMessage", trace_key);
     message_handler_->HandleMessage(pb_message);
   } else {
     LOG(kWarning) << "Message received, failed to parse";
@@ -561,9 +639,9 @@ void Routing::Impl::DoOnMessageReceived(const std::string& message) {
 }
 
 void Routing::Impl::OnConnectionLost(const NodeId& lost_connection_id) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   if (running_)
-    asio_service_.service().post([=]() { DoOnConnectionLost(lost_connection_id); });  // NOLINT
+    scheduler_->Post([=]() { DoOnConnectionLost(lost_connection_id); });  // NOLINT
                                                                                       // (Fraser)
 }
 
@@ -571,7 +649,7 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
   LOG(kVerbose) << DebugId(kNodeId_) << "  Routing::ConnectionLost with -----------"
                 << DebugId(lost_connection_id);
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
@@ -603,7 +681,7 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
                     << "Lost temporary connection with bootstrap node. connection id :"
                     << DebugId(lost_connection_id);
       {
-        std::lock_guard<std::mutex> lock(running_mutex_);
+        std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
         if (!running_)
           return;
       }
@@ -619,13 +697,13 @@ void Routing::Impl::DoOnConnectionLost(const NodeId& lost_connection_id) {
   }
 
   if (resend) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
     // Close node lost, get more nodes
     LOG(kWarning) << "Lost close node, getting more.";
-    recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
-    recovery_timer_.async_wait([=](const boost::system::error_code &error_code) {
+    recovery_timer_->ExpiresFromNow(Parameters::recovery_time_lag);
+    recovery_timer_->AsyncWait([=](const boost::system::error_code &error_code) {
       if (error_code != boost::asio::error::operation_aborted)
         ReSendFindNodeRequest(error_code, true);
     });
@@ -650,14 +728,14 @@ void Routing::Impl::RemoveNode(const NodeInfo& node, bool internal_rudp_only) {
 
   bool resend(routing_table_.IsThisNodeInRange(node.node_id, Parameters::closest_nodes_size));
   if (resend) {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
     // Close node removed by routing, get more nodes
     LOG(kWarning) << "[" << DebugId(kNodeId_)
                   << "] Removed close node, sending find node to get more nodes.";
-    recovery_timer_.expires_from_now(Parameters::recovery_time_lag);
-    recovery_timer_.async_wait([=](const boost::system::error_code & error_code) {
+    recovery_timer_->ExpiresFromNow(Parameters::recovery_time_lag);
+    recovery_timer_->AsyncWait([=](const boost::system::error_code & error_code) {
       if (error_code != boost::asio::error::operation_aborted)
         ReSendFindNodeRequest(error_code, true);
     });
@@ -671,7 +749,7 @@ bool Routing::Impl::ConfirmGroupMembers(const NodeId& node1, const NodeId& node2
 void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error_code,
                                           bool ignore_size) {
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (error_code == boost::asio::error::operation_aborted || !running_)
       return;
   }
@@ -701,11 +779,11 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
     protobuf::Message find_node_rpc(rpcs::FindNodes(kNodeId_, kNodeId_, num_nodes_requested));
     network_.SendToClosestNode(find_node_rpc);
 
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
-    recovery_timer_.expires_from_now(Parameters::find_node_interval);
-    recovery_timer_.async_wait([=](boost::system::error_code error_code_local) {
+    recovery_timer_->ExpiresFromNow(Parameters::find_node_interval);
+    recovery_timer_->AsyncWait([=](boost::system::error_code error_code_local) {
       if (error_code != boost::asio::error::operation_aborted)
         ReSendFindNodeRequest(error_code_local, false);
     });
@@ -713,11 +791,11 @@ void Routing::Impl::ReSendFindNodeRequest(const boost::system::error_code& error
 }
 
 void Routing::Impl::ReBootstrap() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
   if (!running_)
     return;
-  re_bootstrap_timer_.expires_from_now(Parameters::re_bootstrap_time_lag);
-  re_bootstrap_timer_.async_wait([=](boost::system::error_code error_code_local) {
+  re_bootstrap_timer_->ExpiresFromNow(Parameters::re_bootstrap_time_lag);
+  re_bootstrap_timer_->AsyncWait([=](boost::system::error_code error_code_local) {
     if (error_code_local != boost::asio::error::operation_aborted)
       DoReBootstrap(error_code_local);
   });
@@ -727,7 +805,7 @@ void Routing::Impl::DoReBootstrap(const boost::system::error_code& error_code) {
   if (error_code == boost::asio::error::operation_aborted)
     return;
   {
-    std::lock_guard<std::mutex> lock(running_mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(running_mutex_));
     if (!running_)
       return;
   }
@@ -758,6 +836,45 @@ bool Routing::Impl::IsConnectedClient(const NodeId& node_id) {
   return client_routing_table_.IsConnected(node_id);
 }
 
+Statistics Routing::Impl::GetStatistics() const {
+  Statistics statistics;
+  message_handler_->message_statistics().Snapshot(statistics);
+  statistics.bytes_received = bytes_received_;
+  statistics.bytes_sent = network_.bytes_sent();
+  statistics.response_latency = timer_.latency_histogram().Buckets();
+  routing_table_.join_timing().Snapshot(statistics);
+  statistics.timed_out_requests = timer_.timed_out_count();
+  statistics.locks = GetLockStatistics();
+  statistics.memory = GetMemoryStatistics();
+  statistics.receive_queue_depth = receive_queue_depth_;
+  statistics.pending_requests = timer_.task_count();
+  auto now(scheduler_->Now());
+  for (const auto& link : routing_table_.link_quality_table().GetAll()) {
+    LinkStatistics& link_statistics(
+        statistics.links[link.first.ToStringEncoded(NodeId::EncodingType::kHex)]);
+    link_statistics.send_successes = link.second.send_successes;
+    link_statistics.send_failures = link.second.send_failures;
+    link_statistics.bytes_sent = link.second.bytes_sent;
+    link_statistics.round_trip_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(link.second.round_trip_time);
+    if (link.second.send_successes != 0) {
+      link_statistics.since_last_success =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - link.second.last_success);
+    }
+    link_statistics.failure_rate = link.second.failure_rate;
+  }
+  uint64_t estimated_network_size(network_statistics_.EstimatedNetworkSize());
+  if (estimated_network_size > 1) {
+    statistics.ideal_hops = std::log2(static_cast<double>(estimated_network_size));
+    for (const auto& hop_counts : statistics.hops_by_destination) {
+      if (!hop_counts.second.empty())
+        statistics.route_stretch[hop_counts.first] = MeanHops(hop_counts.second) /
+                                                     statistics.ideal_hops;
+    }
+  }
+  return statistics;
+}
+
 // New API
 void Routing::Impl::AddDestinationTypeRelatedFields(protobuf::Message& proto_message,
                                                     std::true_type) {
@@ -19,16 +19,17 @@
 #ifndef MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 #define MAIDSAFE_ROUTING_ROUTING_IMPL_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
-#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/ip/udp.hpp"
 #include "boost/system/error_code.hpp"
 
-#include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/node_id.h"
 
 #include "maidsafe/common/rsa.h"
@@ -36,14 +37,19 @@
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/client_routing_table.h"
 #include "maidsafe/routing/group_change_handler.h"
+#include "maidsafe/routing/message_capture.h"
 #include "maidsafe/routing/message_handler.h"
 #include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/profiled_mutex.h"
+#include "maidsafe/routing/random.h"
 #include "maidsafe/routing/random_node_helper.h"
 #include "maidsafe/routing/remove_furthest_node.h"
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/scheduler.h"
 #include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
 
 namespace maidsafe {
 
@@ -94,11 +100,16 @@ struct NodeInfo;
 
 namespace test {
 class GenericNode;
+class SimulatedNetwork;
 }
 
 class Routing::Impl {
  public:
   Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys);
+  // Runs on 'scheduler' and connects to peers over 'transport' in place of an AsioService and rudp
+  // of its own, so that tests may run many nodes on a simulated network.
+  Impl(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+       std::unique_ptr<Scheduler> scheduler, std::unique_ptr<Transport> transport);
   ~Impl();
 
   void Join(const Functors& functors,
@@ -140,7 +151,10 @@ class Routing::Impl {
   bool IsConnectedVault(const NodeId& node_id);
   bool IsConnectedClient(const NodeId& node_id);
 
+  Statistics GetStatistics() const;
+
   friend class test::GenericNode;
+  friend class test::SimulatedNetwork;
 
  private:
   Impl(const Impl&);
@@ -156,7 +170,8 @@ class Routing::Impl {
   void FindClosestNode(const boost::system::error_code& error_code, int attempts);
   void ReSendFindNodeRequest(const boost::system::error_code& error_code, bool ignore_size);
   void OnMessageReceived(const std::string& message);
-  void DoOnMessageReceived(const std::string& message);
+  void DoOnMessageReceived(const std::string& message,
+                           const std::chrono::steady_clock::time_point& receive_time);
   void OnConnectionLost(const NodeId& lost_connection_id);
   void DoOnConnectionLost(const NodeId& lost_connection_id);
   void RemoveNode(const NodeInfo& node, bool internal_rudp_only);
@@ -190,20 +205,23 @@ class Routing::Impl {
   RoutingTable routing_table_;
   const NodeId kNodeId_;
   bool running_;
-  std::mutex running_mutex_;
+  ProfiledMutex running_mutex_;
+  std::atomic<uint64_t> bytes_received_;
+  std::atomic<uint64_t> receive_queue_depth_;
   Functors functors_;
   RandomNodeHelper random_node_helper_;
   ClientRoutingTable client_routing_table_;
   RemoveFurthestNode remove_furthest_node_;
   GroupChangeHandler group_change_handler_;
+  std::unique_ptr<MessageCapture> message_capture_;
   // The following variables' declarations should remain the last ones in this class and should stay
-  // in the order: message_handler_, asio_service_, network_, all timers.  This is important for the
-  // proper destruction of the routing library, i.e. to avoid segmentation faults.
+  // in the order: message_handler_, scheduler_, network_, timer_, all alarms.  This is important for
+  // the proper destruction of the routing library, i.e. to avoid segmentation faults.
   std::unique_ptr<MessageHandler> message_handler_;
-  AsioService asio_service_;
+  std::unique_ptr<Scheduler> scheduler_;
   NetworkUtils network_;
   Timer<std::string> timer_;
-  boost::asio::steady_timer re_bootstrap_timer_, recovery_timer_, setup_timer_;
+  std::unique_ptr<Scheduler::Alarm> re_bootstrap_timer_, recovery_timer_, setup_timer_;
 };
 
 template <>
@@ -247,7 +265,7 @@ protobuf::Message Routing::Impl::CreateNodeLevelMessage(const T& message) {
 
   AddGroupSourceRelatedFields(message, proto_message, detail::is_group_source<T>());
   AddDestinationTypeRelatedFields(proto_message, detail::is_group_destination<T>());
-  proto_message.set_id(RandomUint32() % 10000);  // Enable for tracing node level messages
+  proto_message.set_id(SeededRandomUint32() % 10000);  // Enable for tracing node level messages
   return proto_message;
 }
 
@@ -29,8 +29,10 @@
 
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/random.h"
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/scoped_probe.h"
 
 namespace maidsafe {
 
@@ -38,6 +40,10 @@ namespace routing {
 
 RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
                            NetworkStatistics& network_statistics)
+    : RoutingTable(client_mode, node_id, keys, network_statistics, SteadyClockNow()) {}
+
+RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+                           NetworkStatistics& network_statistics, NowFunctor now)
     : kClientMode_(client_mode),
       kNodeId_(node_id),
       kConnectionId_(kClientMode_ ? NodeId(NodeId::kRandomId) : kNodeId_),
@@ -46,16 +52,20 @@ RoutingTable::RoutingTable(bool client_mode, const NodeId& node_id, const asymm:
                              : Parameters::max_routing_table_size),
       kThresholdSize_(kClientMode_ ? Parameters::max_routing_table_size_for_client
                                    : Parameters::routing_table_size_threshold),
-      mutex_(),
+      mutex_("RoutingTable"),
       furthest_closest_node_id_((NodeId(NodeId::kMaxId) ^ node_id)),
       remove_node_functor_(),
       network_status_functor_(),
       remove_furthest_node_(),
       connected_group_change_functor_(),
       nodes_(),
+      nodes_memory_(MemorySubsystem::kRoutingTable),
       group_matrix_(kNodeId_, client_mode),
       ipc_message_queue_(),
-      network_statistics_(network_statistics) {
+      network_statistics_(network_statistics),
+      public_key_cache_(now),
+      link_quality_table_(now),
+      join_timing_(now) {
 #ifdef TESTING
   try {
     ipc_message_queue_.reset(new boost::interprocess::message_queue(
@@ -112,13 +122,17 @@ bool RoutingTable::CheckNode(const NodeInfo& peer) { return AddOrCheckNode(peer,
 
 bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
                                   const std::vector<NodeInfo>& matrix_update) {
+  ROUTING_PROBE("RoutingTable::AddOrCheckNode");
   if (peer.node_id.IsZero() || peer.node_id == kNodeId_) {
     LOG(kError) << "Attempt to add an invalid node " << DebugId(peer.node_id);
     return false;
   }
-  if (remove && !asymm::ValidateKey(peer.public_key)) {
-    LOG(kInfo) << "Invalid public key for node " << DebugId(peer.node_id);
-    return false;
+  if (remove && !public_key_cache_.Contains(peer.node_id, peer.public_key)) {
+    if (!asymm::ValidateKey(peer.public_key)) {
+      LOG(kInfo) << "Invalid public key for node " << DebugId(peer.node_id);
+      return false;
+    }
+    public_key_cache_.Add(peer.node_id, peer.public_key);
   }
 
   bool return_value(false), remove_furthest_node(false);
@@ -131,7 +145,7 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
     SetBucketIndex(peer);
   std::vector<NodeId> unique_nodes;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     auto found(Find(peer.node_id, lock));
     if (found.first) {
       LOG(kVerbose) << "Node " << DebugId(peer.node_id) << " already in routing table.";
@@ -154,10 +168,17 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
       return_value = true;
     }
     routing_table_size = static_cast<uint16_t>(nodes_.size());
+    nodes_memory_.Update(MemoryUsage(nodes_));
     unique_nodes = group_matrix_.GetUniqueNodeIds();
   }
 
   if (return_value && remove) {  // Firing functors on Add only
+    join_timing_.PeerAdded(peer.node_id);
+    join_timing_.Record(JoinTiming::Phase::kFirstRoutingTableAdd);
+    if (routing_table_size >= Parameters::closest_nodes_size)
+      join_timing_.Record(JoinTiming::Phase::kClosestNodesReached);
+    if (routing_table_size >= kThresholdSize_)
+      join_timing_.Record(JoinTiming::Phase::kThresholdReached);
     UpdateNetworkStatus(routing_table_size);
 
     if (!removed_node.node_id.IsZero()) {
@@ -191,16 +212,18 @@ bool RoutingTable::AddOrCheckNode(NodeInfo peer, bool remove,
 }
 
 NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
+  ROUTING_PROBE("RoutingTable::DropNode");
   std::vector<NodeInfo> new_connected_close_nodes, old_connected_close_nodes;
   NodeInfo dropped_node;
   std::shared_ptr<MatrixChange> matrix_change;
   std::vector<NodeId> unique_nodes;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     auto found(Find(node_to_drop, lock));
     if (found.first) {
       dropped_node = *found.second;
       nodes_.erase(found.second);
+      nodes_memory_.Update(MemoryUsage(nodes_));
       old_connected_close_nodes = group_matrix_.GetConnectedPeers();
       matrix_change = group_matrix_.RemoveConnectedPeer(dropped_node);
       new_connected_close_nodes = group_matrix_.GetConnectedPeers();
@@ -228,6 +251,7 @@ NodeInfo RoutingTable::DropNode(const NodeId& node_to_drop, bool routing_only) {
   }
 
   if (!dropped_node.node_id.IsZero()) {
+    link_quality_table_.Remove(dropped_node.node_id);
     assert(nodes_.size() <= std::numeric_limits<uint16_t>::max());
     UpdateNetworkStatus(static_cast<uint16_t>(nodes_.size()));
   }
@@ -249,7 +273,7 @@ bool RoutingTable::IsThisNodeGroupLeader(const NodeId& target_id, NodeInfo& conn
   if (NodeId::CloserToTarget(closest_peer_id, current_closest_id, target_id))
     current_closest_id = closest_peer_id;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   group_matrix_.GetBetterNodeForSendingMessage(target_id, true, current_closest_id);
   if (current_closest_id != kNodeId_) {
     auto found(Find(current_closest_id, lock));
@@ -269,7 +293,7 @@ bool RoutingTable::IsThisNodeGroupLeader(const NodeId& target_id, NodeInfo& conn
   if (NodeId::CloserToTarget(closest_peer.node_id, current_closest.node_id, target_id))
     current_closest = closest_peer;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     group_matrix_.GetBetterNodeForSendingMessage(target_id, exclude, true, current_closest);
     if (current_closest.node_id != kNodeId_) {
       auto found(Find(current_closest.node_id, lock));
@@ -299,7 +323,7 @@ bool RoutingTable::ClosestToId(const NodeId& target_id) {
   if (target_id == kNodeId_)
     return false;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   if (nodes_.empty())  // should return false ?
     return true;
 
@@ -326,12 +350,12 @@ GroupRangeStatus RoutingTable::IsNodeIdInGroupRange(const NodeId& group_id) cons
 
 GroupRangeStatus RoutingTable::IsNodeIdInGroupRange(const NodeId& group_id,
                                                     const NodeId& node_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return group_matrix_.IsNodeIdInGroupRange(group_id, node_id);
 }
 
 NodeId RoutingTable::RandomConnectedNode() {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   assert(nodes_.size() > Parameters::closest_nodes_size &&
          "Shouldn't call RandomConnectedNode when routing table size is <= closest_nodes_size");
   if (nodes_.size() <= Parameters::closest_nodes_size)
@@ -339,24 +363,24 @@ NodeId RoutingTable::RandomConnectedNode() {
 
   PartialSortFromTarget(kNodeId_, static_cast<uint16_t>(nodes_.size()), lock);
   size_t index(Parameters::closest_nodes_size +
-               RandomUint32() % (nodes_.size() - Parameters::closest_nodes_size));
+               SeededRandomUint32() % (nodes_.size() - Parameters::closest_nodes_size));
   return nodes_.at(index).node_id;
 }
 
 std::vector<NodeInfo> RoutingTable::GetMatrixNodes() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return group_matrix_.GetUniqueNodes();
 }
 
 bool RoutingTable::IsConnected(const NodeId& node_id) {
   if (Contains(node_id))
     return true;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return group_matrix_.Contains(node_id);
 }
 
 bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   auto found(Find(node_id, lock));
   if (found.first)
     peer = *found.second;
@@ -364,7 +388,7 @@ bool RoutingTable::GetNodeInfo(const NodeId& node_id, NodeInfo& peer) const {
 }
 
 bool RoutingTable::IsThisNodeInRange(const NodeId& target_id, const uint16_t range) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   if (nodes_.size() < range)
     return true;
   NthElementSortFromTarget(kNodeId_, range, lock);
@@ -396,12 +420,12 @@ bool RoutingTable::IsThisNodeClosestToIncludingMatrix(const NodeId& target_id,
     return false;
 
   NodeId connected_peer;
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return group_matrix_.IsThisNodeGroupLeader(target_id, connected_peer);  // use connected peer?
 }
 
 bool RoutingTable::Contains(const NodeId& node_id) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return Find(node_id, lock).first;
 }
 
@@ -415,7 +439,7 @@ void RoutingTable::GroupUpdateFromConnectedPeer(const NodeId& peer,
   std::shared_ptr<MatrixChange> matrix_change;
   std::vector<NodeInfo> new_connected_peers, old_connected_peers;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     std::vector<NodeId> old_unique_ids(group_matrix_.GetUniqueNodeIds());
     old_connected_peers = group_matrix_.GetConnectedPeers();
     if (std::find_if(old_connected_peers.begin(), old_connected_peers.end(),
@@ -428,6 +452,17 @@ void RoutingTable::GroupUpdateFromConnectedPeer(const NodeId& peer,
     }
     matrix_change = group_matrix_.UpdateFromConnectedPeer(peer, nodes, old_unique_ids);
     new_connected_peers = group_matrix_.GetConnectedPeers();
+    // Only complete once the table holds a full close group, so a first update from a lone peer
+    // at the start of a join doesn't count.
+    if (!join_timing_.Reached(JoinTiming::Phase::kGroupMatrixComplete) &&
+        nodes_.size() >= Parameters::closest_nodes_size &&
+        new_connected_peers.size() >= Parameters::closest_nodes_size &&
+        std::none_of(std::begin(new_connected_peers), std::end(new_connected_peers),
+                     [this](const NodeInfo& node_info) {
+                       return group_matrix_.IsRowEmpty(node_info);
+                     })) {
+      join_timing_.Record(JoinTiming::Phase::kGroupMatrixComplete);
+    }
   }
   if (!matrix_change->OldEqualsToNew() && matrix_change_functor_)
     matrix_change_functor_(matrix_change);
@@ -447,7 +482,7 @@ void RoutingTable::UpdateConnectedPeersMatrix(const std::vector<NodeInfo>& new_c
 }
 
 std::shared_ptr<MatrixChange> RoutingTable::UpdateCloseNodeChange(
-    std::unique_lock<std::mutex>& lock, const NodeInfo& peer,
+    std::unique_lock<ProfiledMutex>& lock, const NodeInfo& peer,
     std::vector<NodeInfo>& new_connected_nodes, const std::vector<NodeInfo>& matrix_update) {
   assert(lock.owns_lock());
   std::shared_ptr<MatrixChange> matrix_change;
@@ -485,7 +520,7 @@ void RoutingTable::SetBucketIndex(NodeInfo& node_info) const {
 }
 
 bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
-                                          std::unique_lock<std::mutex>& lock) const {
+                                          std::unique_lock<ProfiledMutex>& lock) const {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   // If we already have a duplicate public key return false
@@ -514,7 +549,7 @@ bool RoutingTable::CheckPublicKeyIsUnique(const NodeInfo& node,
 
 bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
                                              NodeInfo& removed_node,
-                                             std::unique_lock<std::mutex>& lock) {
+                                             std::unique_lock<ProfiledMutex>& lock) {
   assert(lock.owns_lock());
 
   if (remove && !CheckPublicKeyIsUnique(node, lock))
@@ -560,7 +595,7 @@ bool RoutingTable::MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove,
 }
 
 uint16_t RoutingTable::PartialSortFromTarget(const NodeId& target, uint16_t number,
-                                             std::unique_lock<std::mutex>& lock) {
+                                             std::unique_lock<ProfiledMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   uint16_t count = std::min(number, static_cast<uint16_t>(nodes_.size()));
@@ -572,7 +607,7 @@ uint16_t RoutingTable::PartialSortFromTarget(const NodeId& target, uint16_t numb
 }
 
 void RoutingTable::NthElementSortFromTarget(const NodeId& target, uint16_t nth_element,
-                                            std::unique_lock<std::mutex>& lock) {
+                                            std::unique_lock<ProfiledMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   assert((nodes_.size() >= nth_element) &&
@@ -597,7 +632,7 @@ NodeId RoutingTable::FurthestCloseNode() {
 }
 
 NodeInfo RoutingTable::GetClosestNode(const NodeId& target_id, bool ignore_exact_match) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   int sorted_count(PartialSortFromTarget(target_id, 2, lock));
   if (sorted_count == 0)
     return NodeInfo();
@@ -637,12 +672,18 @@ NodeInfo RoutingTable::GetNodeForSendingMessage(const NodeId& target_id,
 NodeInfo RoutingTable::GetNodeForSendingMessage(const NodeId& target_id,
                                                 const std::vector<std::string>& exclude,
                                                 bool ignore_exact_match) {
+  ROUTING_PROBE("RoutingTable::GetNodeForSendingMessage");
   NodeInfo current_peer(GetClosestNode(target_id, exclude, ignore_exact_match));
   if (current_peer.node_id != target_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     group_matrix_.GetBetterNodeForSendingMessage(target_id, exclude, ignore_exact_match,
                                                  current_peer);
   }
+  if (current_peer.node_id != target_id &&
+      link_quality_table_.IsFlaky(current_peer.node_id)) {
+    std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
+    AvoidFlakyPeer(target_id, exclude, ignore_exact_match, current_peer, lock);
+  }
   std::string excluded_ids;
   for (const auto& excluded_id : exclude) {
     excluded_ids.append("\t");
@@ -653,9 +694,41 @@ NodeInfo RoutingTable::GetNodeForSendingMessage(const NodeId& target_id,
   return current_peer;
 }
 
+// Peers sharing at least as many leading bits with the target as the chosen peer, and closer to it
+// than this node, are treated as near-equally close.  If one of these isn't failing sends, it's
+// used in preference.
+void RoutingTable::AvoidFlakyPeer(const NodeId& target_id, const std::vector<std::string>& exclude,
+                                  bool ignore_exact_match, NodeInfo& current_peer,
+                                  std::unique_lock<ProfiledMutex>& lock) {
+  assert(lock.owns_lock());
+  static_cast<void>(lock);
+  const int kCurrentCommonBits(current_peer.node_id.CommonLeadingBits(target_id));
+  const NodeInfo* alternative(nullptr);
+  for (const auto& node : nodes_) {
+    if (node.node_id == current_peer.node_id || (ignore_exact_match && node.node_id == target_id))
+      continue;
+    if (std::find(std::begin(exclude), std::end(exclude), node.node_id.string()) !=
+        std::end(exclude))
+      continue;
+    if (node.node_id.CommonLeadingBits(target_id) < kCurrentCommonBits ||
+        !NodeId::CloserToTarget(node.node_id, kNodeId_, target_id))
+      continue;
+    if (alternative && !NodeId::CloserToTarget(node.node_id, alternative->node_id, target_id))
+      continue;
+    if (!link_quality_table_.IsFlaky(node.node_id))
+      alternative = &node;
+  }
+  if (alternative) {
+    LOG(kVerbose) << "[" << DebugId(kNodeId_) << "] avoiding flaky peer "
+                  << DebugId(current_peer.node_id) << " in favour of "
+                  << DebugId(alternative->node_id);
+    current_peer = *alternative;
+  }
+}
+
 NodeInfo RoutingTable::GetRemovableNode(std::vector<std::string> attempted) {
   std::map<uint32_t, uint16_t> bucket_rank_map;
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   PartialSortFromTarget(kNodeId_, static_cast<uint16_t>(nodes_.size()), lock);
 
   auto const from_iterator(nodes_.begin() + Parameters::closest_nodes_size);
@@ -700,7 +773,7 @@ NodeInfo RoutingTable::GetRemovableNode(std::vector<std::string> attempted) {
 }
 
 void RoutingTable::GetNodesNeedingGroupUpdates(std::vector<NodeInfo>& nodes_needing_update) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   int sorted_count(PartialSortFromTarget(kNodeId_, Parameters::closest_nodes_size, lock));
   if (sorted_count == 0)
     return;
@@ -715,7 +788,7 @@ void RoutingTable::GetNodesNeedingGroupUpdates(std::vector<NodeInfo>& nodes_need
 
 NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, uint16_t node_number) {
   assert((node_number > 0) && "Node number starts with position 1");
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   if (nodes_.size() < node_number) {
     NodeInfo node_info;
     node_info.node_id = (NodeId(NodeId::kMaxId) ^ kNodeId_);
@@ -727,7 +800,7 @@ NodeInfo RoutingTable::GetNthClosestNode(const NodeId& target_id, uint16_t node_
 
 std::vector<NodeId> RoutingTable::GetClosestNodes(const NodeId& target_id, uint16_t number_to_get) {
   std::vector<NodeId> close_nodes;
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   int sorted_count(PartialSortFromTarget(target_id, number_to_get, lock));
 
   for (int i = 0; i != sorted_count; ++i)
@@ -763,7 +836,7 @@ std::vector<NodeId> RoutingTable::GetGroup(const NodeId& target_id) {
 std::vector<NodeInfo> RoutingTable::GetClosestNodeInfo(const NodeId& target_id,
                                                        uint16_t number_to_get,
                                                        bool ignore_exact_match) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::unique_lock<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   int sorted_count(PartialSortFromTarget(target_id, number_to_get + 1, lock));
   if (sorted_count == 0)
     return std::vector<NodeInfo>();
@@ -780,7 +853,7 @@ std::vector<NodeInfo> RoutingTable::GetClosestNodeInfo(const NodeId& target_id,
 }
 
 std::pair<bool, std::vector<NodeInfo>::iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) {
+    const NodeId& node_id, std::unique_lock<ProfiledMutex>& lock) {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
@@ -790,7 +863,7 @@ std::pair<bool, std::vector<NodeInfo>::iterator> RoutingTable::Find(
 }
 
 std::pair<bool, std::vector<NodeInfo>::const_iterator> RoutingTable::Find(
-    const NodeId& node_id, std::unique_lock<std::mutex>& lock) const {
+    const NodeId& node_id, std::unique_lock<ProfiledMutex>& lock) const {
   assert(lock.owns_lock());
   static_cast<void>(lock);
   auto itr(std::find_if(nodes_.begin(), nodes_.end(), [&node_id](const NodeInfo & node_info) {
@@ -811,7 +884,7 @@ void RoutingTable::UpdateNetworkStatus(uint16_t size) const {
 }
 
 size_t RoutingTable::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
   return nodes_.size();
 }
 
@@ -820,7 +893,7 @@ void RoutingTable::IpcSendGroupMatrix() const {
     network_viewer::MatrixRecord matrix_record(kNodeId_);
     std::vector<NodeInfo> matrix, close;
     {
-      std::lock_guard<std::mutex> lock(mutex_);
+      std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
       matrix = group_matrix_.GetUniqueNodes();
       close = group_matrix_.GetConnectedPeers();
     }
@@ -854,7 +927,7 @@ void RoutingTable::IpcSendGroupMatrix() const {
 std::string RoutingTable::PrintRoutingTable() {
   std::vector<NodeInfo> rt;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex_));
     std::sort(nodes_.begin(), nodes_.end(), [&](const NodeInfo & lhs, const NodeInfo & rhs) {
       return NodeId::CloserToTarget(lhs.node_id, rhs.node_id, kNodeId_);
     });
@@ -37,8 +37,14 @@
 
 #include "maidsafe/routing/api_config.h"
 #include "maidsafe/routing/group_matrix.h"
+#include "maidsafe/routing/join_timing.h"
+#include "maidsafe/routing/link_quality_table.h"
+#include "maidsafe/routing/memory_accounting.h"
 #include "maidsafe/routing/network_statistics.h"
 #include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/profiled_mutex.h"
+#include "maidsafe/routing/public_key_cache.h"
+#include "maidsafe/routing/scheduler.h"
 
 namespace maidsafe {
 
@@ -71,6 +77,10 @@ class RoutingTable {
  public:
   RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
                NetworkStatistics& network_statistics);
+  // Takes the time for link quality, join timing and key expiry from 'now', e.g. the node's
+  // Scheduler.
+  RoutingTable(bool client_mode, const NodeId& node_id, const asymm::Keys& keys,
+               NetworkStatistics& network_statistics, NowFunctor now);
   virtual ~RoutingTable();
   void InitialiseFunctors(NetworkStatusFunctor network_status_functor,
                           std::function<void(const NodeInfo&, bool)> remove_node_functor,
@@ -122,6 +132,11 @@ class RoutingTable {
   asymm::PublicKey kPublicKey() const { return kKeys_.public_key; }
   NodeId kConnectionId() const { return kConnectionId_; }
   bool client_mode() const { return kClientMode_; }
+  PublicKeyCache& public_key_cache() { return public_key_cache_; }
+  LinkQualityTable& link_quality_table() { return link_quality_table_; }
+  const LinkQualityTable& link_quality_table() const { return link_quality_table_; }
+  JoinTiming& join_timing() { return join_timing_; }
+  const JoinTiming& join_timing() const { return join_timing_; }
 
   friend class test::GenericNode;
   friend class GroupChangeHandler;
@@ -139,26 +154,29 @@ class RoutingTable {
   bool AddOrCheckNode(NodeInfo node, bool remove,
                       const std::vector<NodeInfo>& matrix_update = std::vector<NodeInfo>());
   void SetBucketIndex(NodeInfo& node_info) const;
-  bool CheckPublicKeyIsUnique(const NodeInfo& node, std::unique_lock<std::mutex>& lock) const;
+  void AvoidFlakyPeer(const NodeId& target_id, const std::vector<std::string>& exclude,
+                      bool ignore_exact_match, NodeInfo& current_peer,
+                      std::unique_lock<ProfiledMutex>& lock);
+  bool CheckPublicKeyIsUnique(const NodeInfo& node, std::unique_lock<ProfiledMutex>& lock) const;
   NodeInfo ResolveConnectionDuplication(const NodeInfo& new_duplicate_node, bool local_endpoint,
                                         NodeInfo& existing_node);
   std::shared_ptr<MatrixChange> UpdateCloseNodeChange(
-      std::unique_lock<std::mutex>& lock, const NodeInfo& peer,
+      std::unique_lock<ProfiledMutex>& lock, const NodeInfo& peer,
       std::vector<NodeInfo>& new_connected_nodes,
       const std::vector<NodeInfo>& matrix_update = std::vector<NodeInfo>());
   bool MakeSpaceForNodeToBeAdded(const NodeInfo& node, bool remove, NodeInfo& removed_node,
-                                 std::unique_lock<std::mutex>& lock);
+                                 std::unique_lock<ProfiledMutex>& lock);
   uint16_t PartialSortFromTarget(const NodeId& target, uint16_t number,
-                                 std::unique_lock<std::mutex>& lock);
+                                 std::unique_lock<ProfiledMutex>& lock);
   void NthElementSortFromTarget(const NodeId& target, uint16_t nth_element,
-                                std::unique_lock<std::mutex>& lock);
+                                std::unique_lock<ProfiledMutex>& lock);
   NodeId FurthestCloseNode();
   std::vector<NodeInfo> GetClosestNodeInfo(const NodeId& target_id, uint16_t number_to_get,
                                            bool ignore_exact_match = false);
   std::pair<bool, std::vector<NodeInfo>::iterator> Find(const NodeId& node_id,
-                                                        std::unique_lock<std::mutex>& lock);
+                                                        std::unique_lock<ProfiledMutex>& lock);
   std::pair<bool, std::vector<NodeInfo>::const_iterator> Find(
-      const NodeId& node_id, std::unique_lock<std::mutex>& lock) const;
+      const NodeId& node_id, std::unique_lock<ProfiledMutex>& lock) const;
   void UpdateNetworkStatus(uint16_t size) const;
   void UpdateConnectedPeersMatrix(const std::vector<NodeInfo>& new_connected_peers,
                                   const std::vector<NodeInfo>& old_connected_peers);
@@ -173,7 +191,7 @@ class RoutingTable {
   const asymm::Keys kKeys_;
   const uint16_t kMaxSize_;
   const uint16_t kThresholdSize_;
-  mutable std::mutex mutex_;
+  mutable ProfiledMutex mutex_;
   NodeId furthest_closest_node_id_;
   std::function<void(const NodeInfo&, bool)> remove_node_functor_;
   NetworkStatusFunctor network_status_functor_;
@@ -181,9 +199,13 @@ class RoutingTable {
   ConnectedGroupChangeFunctor connected_group_change_functor_;
   MatrixChangedFunctor matrix_change_functor_;
   std::vector<NodeInfo> nodes_;
+  MemoryCharge nodes_memory_;
   GroupMatrix group_matrix_;
   std::unique_ptr<boost::interprocess::message_queue> ipc_message_queue_;
   NetworkStatistics& network_statistics_;
+  PublicKeyCache public_key_cache_;
+  LinkQualityTable link_quality_table_;
+  JoinTiming join_timing_;
 };
 
 }  // namespace routing
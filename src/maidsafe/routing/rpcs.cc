@@ -24,6 +24,7 @@
 #include "maidsafe/common/utils.h"
 
 #include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/random.h"
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/utils.h"
 
@@ -79,7 +80,7 @@ protobuf::Message Connect(const NodeId& node_id, const rudp::EndpointPair& our_e
 #ifdef TESTING
   protobuf_connect_request.set_timestamp(GetTimeStamp());
 #endif
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   message.set_destination_id(node_id.string());
   message.set_routing_message(true);
   message.add_data(protobuf_connect_request.SerializeAsString());
@@ -121,7 +122,7 @@ protobuf::Message Remove(const NodeId& node_id, const NodeId& this_node_id,
   message.set_direct(true);
   message.set_replication(1);
   message.set_type(static_cast<int32_t>(MessageType::kRemove));
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   message.set_client_node(false);
   message.set_hops_to_live(Parameters::hops_to_live);
   message.set_source_id(this_node_id.string());
@@ -153,7 +154,7 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
   message.add_route_history(this_node_id.string());
   message.set_client_node(false);
   message.set_visited(false);
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   if (!relay_message) {
     message.set_source_id(this_node_id.string());
   } else {
@@ -163,7 +164,7 @@ protobuf::Message FindNodes(const NodeId& node_id, const NodeId& this_node_id,
     message.set_relay_connection_id(relay_connection_id.string());
   }
   message.set_hops_to_live(Parameters::hops_to_live);
-  //  message.set_id(RandomUint32() % 10000);
+  //  message.set_id(SeededRandomUint32() % 10000);
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
@@ -189,7 +190,7 @@ protobuf::Message ConnectSuccess(const NodeId& node_id, const NodeId& this_node_
   message.set_hops_to_live(Parameters::hops_to_live);
   message.set_source_id(this_node_id.string());
   message.set_request(true);
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
@@ -220,7 +221,7 @@ protobuf::Message ConnectSuccessAcknowledgement(const NodeId& node_id, const Nod
   message.set_hops_to_live(Parameters::hops_to_live);
   message.set_source_id(this_node_id.string());
   message.set_request(false);
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
@@ -249,7 +250,7 @@ protobuf::Message ClosestNodesUpdate(const NodeId& node_id, const NodeId& my_nod
   message.set_request(true);
   message.set_client_node(false);
   message.set_hops_to_live(Parameters::hops_to_live);
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
@@ -271,7 +272,7 @@ protobuf::Message GetGroup(const NodeId& node_id, const NodeId& my_node_id) {
   message.set_client_node(false);
   message.set_hops_to_live(Parameters::hops_to_live);
   message.set_visited(false);
-  message.set_id(RandomUint32() % 10000);
+  message.set_id(SeededRandomUint32() % 10000);
   assert(message.IsInitialized() && "Unintialised message");
   return message;
 }
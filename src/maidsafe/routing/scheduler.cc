@@ -0,0 +1,83 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/scheduler.h"
+
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+class AsioAlarm : public Scheduler::Alarm {
+ public:
+  explicit AsioAlarm(boost::asio::io_service& io_service) : timer_(io_service) {}
+  virtual ~AsioAlarm() {}
+  virtual void ExpiresFromNow(const std::chrono::steady_clock::duration& duration) {
+    timer_.expires_from_now(duration);
+  }
+  virtual void AsyncWait(const Scheduler::WaitHandler& handler) { timer_.async_wait(handler); }
+  virtual void Cancel() { timer_.cancel(); }
+
+ private:
+  AsioAlarm(const AsioAlarm&);
+  AsioAlarm(const AsioAlarm&&);
+  AsioAlarm& operator=(const AsioAlarm&);
+
+  boost::asio::steady_timer timer_;
+};
+
+}  // unnamed namespace
+
+NowFunctor SteadyClockNow() {
+  return [] { return std::chrono::steady_clock::now(); };
+}
+
+AsioScheduler::AsioScheduler(uint32_t thread_count)
+    : own_asio_service_(new AsioService(thread_count)), asio_service_(*own_asio_service_) {}
+
+AsioScheduler::AsioScheduler(AsioService& asio_service)
+    : own_asio_service_(), asio_service_(asio_service) {}
+
+AsioScheduler::~AsioScheduler() {}
+
+std::chrono::steady_clock::time_point AsioScheduler::Now() const {
+  return std::chrono::steady_clock::now();
+}
+
+void AsioScheduler::Post(const std::function<void()>& functor) {
+  asio_service_.service().post(functor);
+}
+
+void AsioScheduler::Dispatch(const std::function<void()>& functor) {
+  asio_service_.service().dispatch(functor);
+}
+
+std::unique_ptr<Scheduler::Alarm> AsioScheduler::MakeAlarm() {
+  return std::unique_ptr<Alarm>(new AsioAlarm(asio_service_.service()));
+}
+
+void AsioScheduler::Sleep(const std::chrono::steady_clock::duration& duration) {
+  maidsafe::Sleep(duration);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,203 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/scoped_probe.h"
+
+#ifdef ROUTING_SCOPED_PROBES
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "boost/thread/tss.hpp"
+#endif
+
+namespace maidsafe {
+
+namespace routing {
+
+#ifdef ROUTING_SCOPED_PROBES
+
+namespace detail {
+
+// One node per distinct call stack.
+struct ProbeNode {
+  explicit ProbeNode(const char* name_in)
+      : name(name_in), count(0), inclusive_time(0), exclusive_time(0), children() {}
+  const char* const name;
+  uint64_t count;
+  std::chrono::steady_clock::duration inclusive_time, exclusive_time;
+  std::vector<std::unique_ptr<ProbeNode>> children;
+};
+
+// The tree is only modified by the owning thread, under 'mutex' so that it can be read by
+// FoldedProbeStacks and ResetProbes.
+struct ThreadProbes {
+  explicit ThreadProbes(uint32_t thread_index_in)
+      : thread_index(thread_index_in), in_use(true), mutex(), root(nullptr), innermost(nullptr) {}
+  const uint32_t thread_index;
+  std::atomic<bool> in_use;
+  std::mutex mutex;
+  ProbeNode root;
+  ScopedProbe* innermost;  // only accessed by the owning thread
+};
+
+}  // namespace detail
+
+namespace {
+
+// Trees are never destroyed.  When a thread exits its tree is handed to the next new thread, so
+// the number of trees is bounded by the peak number of probed threads.
+struct Registry {
+  Registry() : mutex(), threads(), current_thread(&Release) {}
+  static void Release(detail::ThreadProbes* thread_probes) { thread_probes->in_use = false; }
+  std::mutex mutex;
+  std::vector<detail::ThreadProbes*> threads;
+  boost::thread_specific_ptr<detail::ThreadProbes> current_thread;
+};
+
+Registry& GetRegistry() {
+  static Registry* const registry(new Registry);
+  return *registry;
+}
+
+detail::ThreadProbes& GetThreadProbes() {
+  Registry& registry(GetRegistry());
+  detail::ThreadProbes* thread_probes(registry.current_thread.get());
+  if (thread_probes)
+    return *thread_probes;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto candidate : registry.threads) {
+      if (!candidate->in_use) {
+        candidate->in_use = true;
+        thread_probes = candidate;
+        break;
+      }
+    }
+    if (!thread_probes) {
+      thread_probes = new detail::ThreadProbes(static_cast<uint32_t>(registry.threads.size()));
+      registry.threads.push_back(thread_probes);
+    }
+  }
+  registry.current_thread.reset(thread_probes);
+  return *thread_probes;
+}
+
+detail::ProbeNode* GetChild(detail::ThreadProbes& thread_probes, detail::ProbeNode& parent,
+                            const char* name) {
+  std::lock_guard<std::mutex> lock(thread_probes.mutex);
+  for (const auto& child : parent.children) {
+    if (child->name == name || std::strcmp(child->name, name) == 0)
+      return child.get();
+  }
+  parent.children.emplace_back(new detail::ProbeNode(name));
+  return parent.children.back().get();
+}
+
+void AddFoldedStacks(const detail::ProbeNode& node, const std::string& stack, ProbeTime probe_time,
+                     std::map<std::string, std::chrono::steady_clock::duration>& folded_stacks) {
+  for (const auto& child : node.children) {
+    std::string child_stack(stack + ';' + child->name);
+    if (child->count != 0) {
+      folded_stacks[child_stack] += (probe_time == ProbeTime::kExclusive ? child->exclusive_time
+                                                                         : child->inclusive_time);
+    }
+    AddFoldedStacks(*child, child_stack, probe_time, folded_stacks);
+  }
+}
+
+void Reset(detail::ProbeNode& node) {
+  node.count = 0;
+  node.inclusive_time = node.exclusive_time = std::chrono::steady_clock::duration(0);
+  for (auto& child : node.children)
+    Reset(*child);
+}
+
+}  // unnamed namespace
+
+namespace detail {
+
+ScopedProbe::ScopedProbe(const char* name)
+    : thread_probes_(GetThreadProbes()),
+      kParent_(thread_probes_.innermost),
+      node_(GetChild(thread_probes_, kParent_ ? *kParent_->node_ : thread_probes_.root, name)),
+      nested_time_(0),
+      kStart_(std::chrono::steady_clock::now()) {
+  thread_probes_.innermost = this;
+}
+
+ScopedProbe::~ScopedProbe() {
+  auto elapsed(std::chrono::steady_clock::now() - kStart_);
+  {
+    std::lock_guard<std::mutex> lock(thread_probes_.mutex);
+    ++node_->count;
+    node_->inclusive_time += elapsed;
+    node_->exclusive_time += elapsed - nested_time_;
+  }
+  if (kParent_)
+    kParent_->nested_time_ += elapsed;
+  thread_probes_.innermost = kParent_;
+}
+
+}  // namespace detail
+
+std::string FoldedProbeStacks(ProbeTime probe_time) {
+  std::map<std::string, std::chrono::steady_clock::duration> folded_stacks;
+  {
+    Registry& registry(GetRegistry());
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto thread_probes : registry.threads) {
+      std::lock_guard<std::mutex> thread_lock(thread_probes->mutex);
+      AddFoldedStacks(thread_probes->root, "thread-" + std::to_string(thread_probes->thread_index),
+                      probe_time, folded_stacks);
+    }
+  }
+  std::ostringstream output;
+  for (const auto& folded_stack : folded_stacks) {
+    output << folded_stack.first << ' '
+           << std::chrono::duration_cast<std::chrono::microseconds>(folded_stack.second).count()
+           << '\n';
+  }
+  return output.str();
+}
+
+void ResetProbes() {
+  Registry& registry(GetRegistry());
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto thread_probes : registry.threads) {
+    std::lock_guard<std::mutex> thread_lock(thread_probes->mutex);
+    Reset(thread_probes->root);
+  }
+}
+
+#else
+
+std::string FoldedProbeStacks(ProbeTime /*probe_time*/) { return std::string(); }
+
+void ResetProbes() {}
+
+#endif
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,73 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_SCOPED_PROBE_H_
+#define MAIDSAFE_ROUTING_SCOPED_PROBE_H_
+
+#include <chrono>
+
+#include "maidsafe/routing/probes.h"
+
+#ifdef ROUTING_SCOPED_PROBES
+
+#define ROUTING_PROBE_CONCATENATE_DETAIL(prefix, line) prefix##line
+#define ROUTING_PROBE_CONCATENATE(prefix, line) ROUTING_PROBE_CONCATENATE_DETAIL(prefix, line)
+// Times the rest of the enclosing scope.  'name' must be a string literal.
+#define ROUTING_PROBE(name)                                                                    \
+  ::maidsafe::routing::detail::ScopedProbe ROUTING_PROBE_CONCATENATE(scoped_probe_, __LINE__)( \
+      name)
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace detail {
+
+struct ProbeNode;
+struct ThreadProbes;
+
+class ScopedProbe {
+ public:
+  explicit ScopedProbe(const char* name);
+  ~ScopedProbe();
+
+ private:
+  ScopedProbe(const ScopedProbe&);
+  ScopedProbe(const ScopedProbe&&);
+  ScopedProbe& operator=(const ScopedProbe&);
+
+  ThreadProbes& thread_probes_;
+  ScopedProbe* const kParent_;
+  ProbeNode* node_;
+  std::chrono::steady_clock::duration nested_time_;
+  const std::chrono::steady_clock::time_point kStart_;
+};
+
+}  // namespace detail
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#else
+
+#define ROUTING_PROBE(name) static_cast<void>(0)
+
+#endif
+
+#endif  // MAIDSAFE_ROUTING_SCOPED_PROBE_H_
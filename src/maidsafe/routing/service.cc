@@ -37,6 +37,7 @@
 #include "maidsafe/routing/routing.pb.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/rpcs.h"
+#include "maidsafe/routing/scoped_probe.h"
 #include "maidsafe/routing/utils.h"
 
 namespace maidsafe {
@@ -89,6 +90,7 @@ void Service::Ping(protobuf::Message& message) {
 }
 
 void Service::Connect(protobuf::Message& message) {
+  ROUTING_PROBE("Service::Connect");
   if (message.destination_id() != routing_table_.kNodeId().string()) {
     // Message not for this node and we should not pass it on.
     LOG(kError) << "Message not for this node.";
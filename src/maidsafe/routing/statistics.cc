@@ -0,0 +1,129 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/statistics.h"
+
+#include <cmath>
+
+namespace maidsafe {
+
+namespace routing {
+
+Statistics::Statistics()
+    : messages_by_type(),
+      messages_by_handling(),
+      bytes_received(0),
+      bytes_sent(0),
+      response_latency(),
+      timed_out_requests(0),
+      receive_queue_depth(0),
+      pending_requests(0),
+      links(),
+      hops_by_destination(),
+      ideal_hops(0.0),
+      route_stretch(),
+      locks(),
+      join_phases(),
+      connect_handshake(),
+      memory() {}
+
+LinkStatistics::LinkStatistics()
+    : send_successes(0),
+      send_failures(0),
+      bytes_sent(0),
+      round_trip_time(0),
+      since_last_success(-1),
+      failure_rate(0.0) {}
+
+LockStatistics::LockStatistics()
+    : acquisitions(0), wait_time(), hold_time(), longest_holds() {}
+
+MemoryStatistics::MemoryStatistics() : current_bytes(0), peak_bytes(0) {}
+
+std::chrono::microseconds LatencyPercentile(const LatencyBuckets& buckets, double percentile) {
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  if (total == 0)
+    return std::chrono::microseconds(0);
+  uint64_t rank(static_cast<uint64_t>(std::ceil(total * percentile / 100.0)));
+  uint64_t seen(0);
+  for (const auto& bucket : buckets) {
+    seen += bucket.second;
+    if (seen >= rank)
+      return bucket.first;
+  }
+  return buckets.back().first;
+}
+
+double MeanHops(const HopCounts& hop_counts) {
+  uint64_t total(0), total_hops(0);
+  for (size_t hops(0); hops != hop_counts.size(); ++hops) {
+    total += hop_counts[hops];
+    total_hops += hops * hop_counts[hops];
+  }
+  return total == 0 ? 0.0 : static_cast<double>(total_hops) / total;
+}
+
+LatencyHistogram::LatencyHistogram() : counts_() {
+  for (auto& count : counts_)
+    count = 0;
+}
+
+void LatencyHistogram::Record(const std::chrono::steady_clock::duration& duration) {
+  auto microseconds(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+  counts_[BucketIndex(microseconds < 0 ? 0 : static_cast<uint64_t>(microseconds))].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+LatencyBuckets LatencyHistogram::Buckets() const {
+  LatencyBuckets buckets;
+  for (size_t i(0); i != kBucketCount; ++i) {
+    uint64_t count(counts_[i].load(std::memory_order_relaxed));
+    if (count != 0) {
+      buckets.push_back(std::make_pair(
+          std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(
+              BucketUpperBound(i))),
+          count));
+    }
+  }
+  return buckets;
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t microseconds) {
+  if (microseconds < kSubBucketCount)
+    return static_cast<size_t>(microseconds);
+  size_t most_significant_bit(kSubBucketBits);
+  while (microseconds >> (most_significant_bit + 1))
+    ++most_significant_bit;
+  size_t shift(most_significant_bit - kSubBucketBits);
+  return (shift + 1) * kSubBucketCount +
+         static_cast<size_t>((microseconds >> shift) - kSubBucketCount);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < kSubBucketCount)
+    return index;
+  size_t shift(index / kSubBucketCount - 1);
+  uint64_t lower_bound(static_cast<uint64_t>(kSubBucketCount + index % kSubBucketCount) << shift);
+  return lower_bound + ((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe
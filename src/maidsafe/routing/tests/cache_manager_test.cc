@@ -0,0 +1,287 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/cache_manager.h"
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/tests/mock_network_utils.h"
+#include "maidsafe/routing/tests/virtual_clock.h"
+#include "maidsafe/routing/tests/virtual_scheduler.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class CacheManagerTest : public testing::Test {
+ public:
+  CacheManagerTest()
+      : node_id_(NodeId::kRandomId),
+        network_statistics_(node_id_),
+        routing_table_(false, node_id_, asymm::GenerateKeyPair(), network_statistics_),
+        client_routing_table_(node_id_),
+        network_(routing_table_, client_routing_table_),
+        clock_(),
+        scheduler_(clock_),
+        cache_manager_(node_id_, network_, scheduler_, 1024 * 1024),
+        data_holder_id_(NodeId::kRandomId) {}
+
+  protobuf::Message MakeGetRequest(const std::string& data, int32_t id) {
+    return MakeGetRequest(data, id, 1, data_holder_id_);
+  }
+
+  protobuf::Message MakeGetRequest(const std::string& data, int32_t id, int32_t type,
+                                   const NodeId& destination_id) {
+    protobuf::Message message;
+    message.set_request(true);
+    message.set_direct(true);
+    message.set_routing_message(false);
+    message.set_client_node(false);
+    message.set_hops_to_live(Parameters::hops_to_live);
+    message.set_type(type);
+    message.set_source_id(NodeId(NodeId::kRandomId).string());
+    message.set_destination_id(destination_id.string());
+    message.set_cacheable(static_cast<int32_t>(Cacheable::kGet));
+    message.set_id(id);
+    message.add_data(data);
+    return message;
+  }
+
+  protobuf::Message MakeResponse(const protobuf::Message& request, const std::string& data) {
+    protobuf::Message message(request);
+    message.set_request(false);
+    message.set_source_id(request.destination_id());
+    message.set_destination_id(request.source_id());
+    message.set_cacheable(static_cast<int32_t>(Cacheable::kPut));
+    message.clear_data();
+    message.add_data(data);
+    return message;
+  }
+
+ protected:
+  NodeId node_id_;
+  NetworkStatistics network_statistics_;
+  RoutingTable routing_table_;
+  ClientRoutingTable client_routing_table_;
+  MockNetworkUtils network_;
+  VirtualClock clock_;
+  VirtualScheduler scheduler_;
+  CacheManager cache_manager_;
+  // Destination of the requests made, unless given otherwise.
+  NodeId data_holder_id_;
+};
+
+TEST_F(CacheManagerTest, BEH_CoalesceIdenticalGets) {
+  const std::string kRequestData(RandomString(64)), kResponseData(RandomString(1024));
+  const int kParkedCount(5);
+  auto is_request([](const protobuf::Message& message) { return message.request(); });
+  auto is_response([&](const protobuf::Message& message) {
+    return !message.request() && message.data(0) == kResponseData;
+  });
+
+  // Only the first of the identical requests is passed on
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(1);
+  protobuf::Message first_request(MakeGetRequest(kRequestData, 1));
+  cache_manager_.HandleGetFromCache(first_request);
+  for (int i(0); i != kParkedCount; ++i) {
+    protobuf::Message request(MakeGetRequest(kRequestData, i + 2));
+    cache_manager_.HandleGetFromCache(request);
+  }
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // The response to the first answers all the parked ones
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_response))).Times(kParkedCount);
+  cache_manager_.AddToCache(MakeResponse(first_request, kResponseData));
+  testing::Mock::VerifyAndClearExpectations(&network_);
+  while (cache_manager_.pending_stores_ != 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // Later identical requests are answered from the response cache
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_response))).Times(1);
+  protobuf::Message later_request(MakeGetRequest(kRequestData, kParkedCount + 2));
+  cache_manager_.HandleGetFromCache(later_request);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // Different requests are passed on independently
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(2);
+  for (int i(0); i != 2; ++i) {
+    protobuf::Message request(MakeGetRequest(RandomString(64), i));
+    cache_manager_.HandleGetFromCache(request);
+  }
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // As are requests with the same contents but of another type or to another destination
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(2);
+  protobuf::Message other_type_request(
+      MakeGetRequest(kRequestData, kParkedCount + 3, 2, data_holder_id_));
+  cache_manager_.HandleGetFromCache(other_type_request);
+  protobuf::Message other_destination_request(
+      MakeGetRequest(kRequestData, kParkedCount + 4, 1, NodeId(NodeId::kRandomId)));
+  cache_manager_.HandleGetFromCache(other_destination_request);
+}
+
+TEST_F(CacheManagerTest, BEH_ReleaseParkedOnExpiry) {
+  const std::string kRequestData(RandomString(64));
+  const int kParkedCount(3);
+  const VirtualClock::Duration kTimeout(std::chrono::duration_cast<VirtualClock::Duration>(
+      Parameters::parked_cache_request_timeout));
+  auto is_request([](const protobuf::Message& message) { return message.request(); });
+
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(1);
+  protobuf::Message first_request(MakeGetRequest(kRequestData, 1));
+  cache_manager_.HandleGetFromCache(first_request);
+  for (int i(0); i != kParkedCount; ++i) {
+    protobuf::Message request(MakeGetRequest(kRequestData, i + 2));
+    cache_manager_.HandleGetFromCache(request);
+  }
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // Nothing is released before the expiry, even with no further traffic
+  EXPECT_CALL(network_, SendToClosestNode(testing::_)).Times(0);
+  clock_.RunUntil(kTimeout - VirtualClock::Duration(1));
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // At the expiry, the parked requests are passed on and the lookup is forgotten
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(kParkedCount);
+  clock_.RunUntil(kTimeout);
+  testing::Mock::VerifyAndClearExpectations(&network_);
+  EXPECT_TRUE(cache_manager_.in_flight_lookups_.empty());
+  EXPECT_TRUE(cache_manager_.pending_lookups_.empty());
+
+  // A later lookup gets an alarm of its own
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(2);
+  protobuf::Message later_request(MakeGetRequest(kRequestData, kParkedCount + 2));
+  cache_manager_.HandleGetFromCache(later_request);
+  protobuf::Message parked_request(MakeGetRequest(kRequestData, kParkedCount + 3));
+  cache_manager_.HandleGetFromCache(parked_request);
+  clock_.RunUntil(clock_.Now() + kTimeout);
+  EXPECT_TRUE(cache_manager_.in_flight_lookups_.empty());
+}
+
+TEST_F(CacheManagerTest, BEH_ReleaseParkedOnFailure) {
+  const std::string kRequestData(RandomString(64));
+  const int kParkedCount(3);
+  auto is_request([](const protobuf::Message& message) { return message.request(); });
+
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(1);
+  protobuf::Message first_request(MakeGetRequest(kRequestData, 1));
+  cache_manager_.HandleGetFromCache(first_request);
+  for (int i(0); i != kParkedCount; ++i) {
+    protobuf::Message request(MakeGetRequest(kRequestData, i + 2));
+    cache_manager_.HandleGetFromCache(request);
+  }
+  testing::Mock::VerifyAndClearExpectations(&network_);
+
+  // An empty response fails the lookup, so the parked requests are passed on straight away rather
+  // than answered with it
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(kParkedCount);
+  cache_manager_.AddToCache(MakeResponse(first_request, ""));
+  testing::Mock::VerifyAndClearExpectations(&network_);
+  EXPECT_TRUE(cache_manager_.in_flight_lookups_.empty());
+  EXPECT_EQ(0U, cache_manager_.pending_stores_.load());
+}
+
+TEST_F(CacheManagerTest, BEH_IgnoreUnrequestedResponses) {
+  const std::string kRequestData(RandomString(64));
+  auto is_request([](const protobuf::Message& message) { return message.request(); });
+
+  // A response to a request this node never passed on isn't cached
+  protobuf::Message request(MakeGetRequest(kRequestData, 1));
+  cache_manager_.AddToCache(MakeResponse(request, RandomString(1024)));
+  while (cache_manager_.pending_stores_ != 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_CALL(network_, SendToClosestNode(testing::Truly(is_request))).Times(1);
+  cache_manager_.HandleGetFromCache(request);
+}
+
+TEST_F(CacheManagerTest, BEH_DropStoresWhenFull) {
+  const uint16_t kMaxPendingStores(Parameters::max_pending_cache_stores);
+  Parameters::max_pending_cache_stores = 5;
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  bool release(false);
+  int stored_count(0);
+  cache_manager_.InitialiseFunctors(
+      [](const std::string&, bool, ReplyFunctor reply_functor) { reply_functor(""); },
+      [&](const std::string&) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond_var.wait(lock, [&] { return release; });
+        ++stored_count;
+      });
+
+  // With the store blocked, only the first max_pending_cache_stores responses are queued, and
+  // queueing doesn't wait for the store
+  auto start(std::chrono::steady_clock::now());
+  for (int i(0); i != Parameters::max_pending_cache_stores * 2; ++i)
+    cache_manager_.AddToCache(MakeResponse(MakeGetRequest(RandomString(64), i), RandomString(64)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  EXPECT_EQ(Parameters::max_pending_cache_stores, cache_manager_.pending_stores_.load());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cond_var.notify_all();
+  while (cache_manager_.pending_stores_ != 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(Parameters::max_pending_cache_stores, stored_count);
+  Parameters::max_pending_cache_stores = kMaxPendingStores;
+}
+
+TEST_F(CacheManagerTest, BEH_FailedStoreFreesQueueSlot) {
+  const uint16_t kMaxPendingStores(Parameters::max_pending_cache_stores);
+  Parameters::max_pending_cache_stores = 1;
+  int store_count(0);
+  cache_manager_.InitialiseFunctors(
+      [](const std::string&, bool, ReplyFunctor reply_functor) { reply_functor(""); },
+      [&](const std::string&) {
+        ++store_count;
+        BOOST_THROW_EXCEPTION(MakeError(CommonErrors::unable_to_handle_request));
+      });
+
+  // Each store throws, but still frees its place in the queue for the next response
+  for (int i(0); i != 3; ++i) {
+    cache_manager_.AddToCache(MakeResponse(MakeGetRequest(RandomString(64), i), RandomString(64)));
+    while (cache_manager_.pending_stores_ != 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(3, store_count);
+  Parameters::max_pending_cache_stores = kMaxPendingStores;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,123 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/join_timing.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(JoinTimingTest, BEH_PhasesRecordedOncePerJoin) {
+  JoinTiming join_timing;
+  join_timing.Record(JoinTiming::Phase::kBootstrapped);
+  EXPECT_FALSE(join_timing.Reached(JoinTiming::Phase::kBootstrapped));
+  Statistics statistics;
+  join_timing.Snapshot(statistics);
+  EXPECT_TRUE(statistics.join_phases.empty());
+
+  join_timing.Start();
+  join_timing.Record(JoinTiming::Phase::kBootstrapped);
+  Sleep(std::chrono::milliseconds(20));
+  join_timing.Record(JoinTiming::Phase::kFirstRoutingTableAdd);
+  join_timing.Record(JoinTiming::Phase::kBootstrapped);
+  EXPECT_TRUE(join_timing.Reached(JoinTiming::Phase::kBootstrapped));
+  EXPECT_TRUE(join_timing.Reached(JoinTiming::Phase::kFirstRoutingTableAdd));
+  EXPECT_FALSE(join_timing.Reached(JoinTiming::Phase::kThresholdReached));
+
+  join_timing.Snapshot(statistics);
+  ASSERT_EQ(2U, statistics.join_phases.size());
+  EXPECT_GT(std::chrono::milliseconds(20), statistics.join_phases["Bootstrapped"]);
+  EXPECT_LE(std::chrono::milliseconds(20), statistics.join_phases["FirstRoutingTableAdd"]);
+
+  join_timing.Start();
+  EXPECT_FALSE(join_timing.Reached(JoinTiming::Phase::kBootstrapped));
+  Statistics restarted_statistics;
+  join_timing.Snapshot(restarted_statistics);
+  EXPECT_TRUE(restarted_statistics.join_phases.empty());
+}
+
+TEST(JoinTimingTest, BEH_ConnectHandshake) {
+  JoinTiming join_timing;
+  NodeId peer_id(NodeId::kRandomId), unrequested_peer_id(NodeId::kRandomId);
+  join_timing.ConnectRequestSent(peer_id);
+  Sleep(std::chrono::milliseconds(10));
+  join_timing.PeerAdded(peer_id);
+  join_timing.PeerAdded(peer_id);
+  join_timing.PeerAdded(unrequested_peer_id);
+
+  Statistics statistics;
+  join_timing.Snapshot(statistics);
+  ASSERT_EQ(1U, statistics.connect_handshake.size());
+  EXPECT_EQ(1U, statistics.connect_handshake.front().second);
+  EXPECT_LE(std::chrono::milliseconds(10), statistics.connect_handshake.front().first);
+}
+
+TEST(JoinTimingTest, BEH_GroupMatrixCompleteNeedsFullCloseGroup) {
+  NodeId node_id(NodeId::kRandomId);
+  NetworkStatistics network_statistics(node_id);
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), network_statistics);
+  routing_table.InitialiseFunctors([](int) {}, [](const NodeInfo&, bool) {}, []() {},
+                                   [](std::vector<NodeInfo>, std::vector<NodeInfo>) {},
+                                   [](std::shared_ptr<MatrixChange>) {});
+  routing_table.join_timing().Start();
+  std::vector<NodeInfo> peer_closest_nodes;
+  for (int i(0); i != 4; ++i)
+    peer_closest_nodes.push_back(MakeNode());
+
+  // With a single node in the table, its first ClosestNodesUpdate doesn't complete the matrix
+  std::vector<NodeInfo> peers;
+  peers.push_back(MakeNode());
+  ASSERT_TRUE(routing_table.AddNode(peers.back()));
+  routing_table.GroupUpdateFromConnectedPeer(peers.back().node_id, peer_closest_nodes);
+  EXPECT_FALSE(routing_table.join_timing().Reached(JoinTiming::Phase::kGroupMatrixComplete));
+
+  while (peers.size() < Parameters::closest_nodes_size) {
+    peers.push_back(MakeNode());
+    ASSERT_TRUE(routing_table.AddNode(peers.back()));
+  }
+  ASSERT_TRUE(routing_table.join_timing().Reached(JoinTiming::Phase::kClosestNodesReached));
+  for (size_t i(1); i < peers.size() - 1; ++i)
+    routing_table.GroupUpdateFromConnectedPeer(peers.at(i).node_id, peer_closest_nodes);
+  EXPECT_FALSE(routing_table.join_timing().Reached(JoinTiming::Phase::kGroupMatrixComplete));
+
+  routing_table.GroupUpdateFromConnectedPeer(peers.back().node_id, peer_closest_nodes);
+  EXPECT_TRUE(routing_table.join_timing().Reached(JoinTiming::Phase::kGroupMatrixComplete));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
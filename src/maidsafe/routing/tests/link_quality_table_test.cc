@@ -0,0 +1,137 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/link_quality_table.h"
+#include "maidsafe/routing/parameters.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(LinkQualityTableTest, BEH_RecordAndGet) {
+  LinkQualityTable link_quality_table;
+  NodeId peer_id(NodeId::kRandomId);
+  LinkQuality link_quality;
+  EXPECT_FALSE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_FALSE(link_quality_table.IsFlaky(peer_id));
+
+  link_quality_table.RecordSendSuccess(peer_id, 100, std::chrono::milliseconds(80));
+  ASSERT_TRUE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_EQ(1U, link_quality.send_successes);
+  EXPECT_EQ(0U, link_quality.send_failures);
+  EXPECT_EQ(100U, link_quality.bytes_sent);
+  EXPECT_EQ(std::chrono::milliseconds(80),
+            std::chrono::duration_cast<std::chrono::milliseconds>(link_quality.round_trip_time));
+  EXPECT_EQ(link_quality.last_activity, link_quality.last_success);
+
+  // Further samples are smoothed rather than replacing the estimate
+  link_quality_table.RecordSendSuccess(peer_id, 50, std::chrono::milliseconds(160));
+  ASSERT_TRUE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_EQ(2U, link_quality.send_successes);
+  EXPECT_EQ(150U, link_quality.bytes_sent);
+  EXPECT_EQ(std::chrono::milliseconds(90),
+            std::chrono::duration_cast<std::chrono::milliseconds>(link_quality.round_trip_time));
+
+  link_quality_table.RecordSendFailure(peer_id, 10);
+  ASSERT_TRUE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_EQ(1U, link_quality.send_failures);
+  EXPECT_EQ(160U, link_quality.bytes_sent);
+  EXPECT_LT(link_quality.last_success, link_quality.last_activity);
+
+  EXPECT_EQ(1U, link_quality_table.GetAll().size());
+  link_quality_table.Remove(peer_id);
+  EXPECT_FALSE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_TRUE(link_quality_table.GetAll().empty());
+}
+
+TEST(LinkQualityTableTest, BEH_FlakyPeers) {
+  LinkQualityTable link_quality_table;
+  NodeId peer_id(NodeId::kRandomId);
+  // A single failure doesn't make an otherwise untested peer flaky...
+  link_quality_table.RecordSendFailure(peer_id, 0);
+  EXPECT_FALSE(link_quality_table.IsFlaky(peer_id));
+  // ...but repeated failures do, before the three consecutive failures which cause a node to be
+  // dropped.
+  link_quality_table.RecordSendFailure(peer_id, 0);
+  EXPECT_TRUE(link_quality_table.IsFlaky(peer_id));
+
+  // Successful sends restore the peer
+  int successes(0);
+  while (link_quality_table.IsFlaky(peer_id)) {
+    link_quality_table.RecordSendSuccess(peer_id, 0, std::chrono::milliseconds(10));
+    ASSERT_GT(10, ++successes);
+  }
+  EXPECT_LT(1, successes);
+
+  // Occasional failures among mostly successful sends aren't enough to mark a peer as flaky
+  NodeId other_peer_id(NodeId::kRandomId);
+  for (int i(0); i != 100; ++i) {
+    if (i % 10 == 0)
+      link_quality_table.RecordSendFailure(other_peer_id, 0);
+    else
+      link_quality_table.RecordSendSuccess(other_peer_id, 0, std::chrono::milliseconds(10));
+    EXPECT_FALSE(link_quality_table.IsFlaky(other_peer_id));
+  }
+}
+
+TEST(LinkQualityTableTest, BEH_FlakyPeersRecoverWhenIdle) {
+  std::chrono::steady_clock::time_point now;
+  LinkQualityTable link_quality_table([&now] { return now; });
+  NodeId peer_id(NodeId::kRandomId);
+  link_quality_table.RecordSendFailure(peer_id, 0);
+  link_quality_table.RecordSendFailure(peer_id, 0);
+  EXPECT_TRUE(link_quality_table.IsFlaky(peer_id));
+  now += Parameters::link_failure_half_life / 10;
+  EXPECT_TRUE(link_quality_table.IsFlaky(peer_id));
+
+  // A peer passed over as flaky gets no sends, but is tried again once its failures have decayed
+  now += Parameters::link_failure_half_life;
+  EXPECT_FALSE(link_quality_table.IsFlaky(peer_id));
+  LinkQuality link_quality;
+  ASSERT_TRUE(link_quality_table.Get(peer_id, link_quality));
+  EXPECT_GT(Parameters::flaky_link_failure_percentage / 100.0, link_quality.failure_rate);
+  EXPECT_EQ(2U, link_quality.send_failures);
+}
+
+TEST(LinkQualityTableTest, BEH_Bounded) {
+  LinkQualityTable link_quality_table;
+  const size_t kMaxSize(2U * (Parameters::max_routing_table_size +
+                              Parameters::max_client_routing_table_size));
+  std::vector<NodeId> peer_ids;
+  for (size_t i(0); i != kMaxSize + 10; ++i) {
+    peer_ids.push_back(NodeId(NodeId::kRandomId));
+    link_quality_table.RecordSendSuccess(peer_ids.back(), 0, std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(kMaxSize, link_quality_table.GetAll().size());
+  LinkQuality link_quality;
+  EXPECT_TRUE(link_quality_table.Get(peer_ids.back(), link_quality));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
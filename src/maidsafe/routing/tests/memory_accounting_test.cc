@@ -0,0 +1,82 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/memory_accounting.h"
+#include "maidsafe/routing/node_info.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+MemoryStatistics GetSubsystemStatistics(const std::string& subsystem) {
+  auto memory_statistics(GetMemoryStatistics());
+  EXPECT_EQ(static_cast<size_t>(MemorySubsystem::kCount), memory_statistics.size());
+  return memory_statistics[subsystem];
+}
+
+}  // unnamed namespace
+
+TEST(MemoryAccountingTest, BEH_CountingAllocator) {
+  uint64_t initial_bytes(GetSubsystemStatistics("TimerTasks").current_bytes);
+  {
+    std::map<int, int, std::less<int>,
+             CountingAllocator<std::pair<const int, int>, MemorySubsystem::kTimerTasks>> counted;
+    for (int i(0); i != 100; ++i)
+      counted[i] = i;
+    MemoryStatistics statistics(GetSubsystemStatistics("TimerTasks"));
+    EXPECT_LE(initial_bytes + 100 * sizeof(std::pair<const int, int>), statistics.current_bytes);
+    EXPECT_LE(statistics.current_bytes, statistics.peak_bytes);
+  }
+  MemoryStatistics statistics(GetSubsystemStatistics("TimerTasks"));
+  EXPECT_EQ(initial_bytes, statistics.current_bytes);
+  EXPECT_LE(initial_bytes + 100 * sizeof(std::pair<const int, int>), statistics.peak_bytes);
+}
+
+TEST(MemoryAccountingTest, BEH_MemoryCharge) {
+  uint64_t initial_bytes(GetSubsystemStatistics("ClientRoutingTable").current_bytes);
+  std::vector<NodeInfo> nodes(10);
+  nodes.front().dimension_list.resize(100);
+  EXPECT_LE(10 * sizeof(NodeInfo) + 100 * sizeof(int32_t), MemoryUsage(nodes));
+  {
+    MemoryCharge charge(MemorySubsystem::kClientRoutingTable);
+    charge.Update(MemoryUsage(nodes));
+    EXPECT_EQ(initial_bytes + MemoryUsage(nodes),
+              GetSubsystemStatistics("ClientRoutingTable").current_bytes);
+    charge.Update(100);
+    EXPECT_EQ(initial_bytes + 100, GetSubsystemStatistics("ClientRoutingTable").current_bytes);
+  }
+  MemoryStatistics statistics(GetSubsystemStatistics("ClientRoutingTable"));
+  EXPECT_EQ(initial_bytes, statistics.current_bytes);
+  EXPECT_LE(initial_bytes + MemoryUsage(nodes), statistics.peak_bytes);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,109 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message_capture.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(MessageCaptureTest, BEH_RecordAndRead) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestCapture"));
+  fs::path file_path(*test_path / "capture");
+  NodeId node_id(NodeId::kRandomId), connection_id(NodeId::kRandomId);
+  std::vector<std::string> messages;
+  for (int i(0); i != 10; ++i)
+    messages.push_back(RandomString(100 * i));
+  {
+    MessageCapture capture(file_path, node_id, 1024 * 1024);
+    for (size_t i(0); i != messages.size(); ++i)
+      capture.Record(messages[i], i % 2 == 0 ? connection_id.string() : std::string());
+  }
+
+  NodeId read_node_id;
+  auto captured(ReadMessageCapture(file_path, read_node_id));
+  EXPECT_EQ(node_id, read_node_id);
+  ASSERT_EQ(messages.size(), captured.size());
+  for (size_t i(0); i != messages.size(); ++i) {
+    EXPECT_EQ(messages[i], captured[i].message);
+    if (i % 2 == 0) {
+      EXPECT_EQ(connection_id, captured[i].connection_id);
+    } else {
+      EXPECT_TRUE(captured[i].connection_id.IsZero());
+    }
+    if (i != 0) {
+      EXPECT_LE(captured[i - 1].time, captured[i].time);
+    }
+  }
+}
+
+TEST(MessageCaptureTest, BEH_StopsWhenFull) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestCapture"));
+  fs::path file_path(*test_path / "capture");
+  NodeId node_id(NodeId::kRandomId);
+  {
+    MessageCapture capture(file_path, node_id, 4000);
+    for (int i(0); i != 10; ++i)
+      capture.Record(RandomString(1000), std::string());
+  }
+  EXPECT_GE(4000U, fs::file_size(file_path));
+  NodeId read_node_id;
+  EXPECT_EQ(3U, ReadMessageCapture(file_path, read_node_id).size());
+}
+
+TEST(MessageCaptureTest, BEH_TruncatedRecord) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestCapture"));
+  fs::path file_path(*test_path / "capture");
+  NodeId node_id(NodeId::kRandomId);
+  {
+    MessageCapture capture(file_path, node_id, 1024 * 1024);
+    capture.Record(RandomString(1000), std::string());
+    capture.Record(RandomString(1000), std::string());
+  }
+  fs::resize_file(file_path, fs::file_size(file_path) - 1);
+  NodeId read_node_id;
+  EXPECT_EQ(1U, ReadMessageCapture(file_path, read_node_id).size());
+
+  {
+    std::ofstream other_file(file_path.string().c_str(), std::ios::binary | std::ios::trunc);
+    other_file << "not a capture";
+  }
+  EXPECT_THROW(ReadMessageCapture(file_path, read_node_id), maidsafe_error);
+  EXPECT_THROW(ReadMessageCapture(*test_path / "missing", read_node_id), maidsafe_error);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,168 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/tests/message_replayer.h"
+
+#include <set>
+#include <thread>
+
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/rudp/return_codes.h"
+
+#include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/matrix_change.h"
+#include "maidsafe/routing/node_info.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+int ReplayTransport::Bootstrap(
+    const std::vector<boost::asio::ip::udp::endpoint>& /*bootstrap_endpoints*/,
+    const rudp::MessageReceivedFunctor& /*message_received_functor*/,
+    const rudp::ConnectionLostFunctor& /*connection_lost_functor*/, const NodeId& /*this_node_id*/,
+    std::shared_ptr<asymm::PrivateKey> /*private_key*/,
+    std::shared_ptr<asymm::PublicKey> /*public_key*/, NodeId& /*chosen_bootstrap_peer*/,
+    rudp::NatType& /*nat_type*/, const boost::asio::ip::udp::endpoint& /*local_endpoint*/) {
+  return rudp::kInvalidConnection;
+}
+
+int ReplayTransport::GetAvailableEndpoint(const NodeId& /*peer_id*/,
+                                          const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                          rudp::EndpointPair& /*this_endpoint_pair*/,
+                                          rudp::NatType& /*this_nat_type*/) {
+  return rudp::kInvalidConnection;
+}
+
+int ReplayTransport::Add(const NodeId& /*peer_id*/,
+                         const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                         const std::string& /*validation_data*/) {
+  return rudp::kInvalidConnection;
+}
+
+int ReplayTransport::MarkConnectionAsValid(
+    const NodeId& /*peer_id*/, boost::asio::ip::udp::endpoint& /*new_bootstrap_endpoint*/) {
+  return rudp::kInvalidConnection;
+}
+
+void ReplayTransport::Send(const NodeId& /*peer_id*/, std::string&& /*message*/,
+                           const rudp::MessageSentFunctor& /*message_sent_functor*/) {
+  ++sent_count_;
+}
+
+ReplayNetworkUtils::ReplayNetworkUtils(RoutingTable& routing_table,
+                                       ClientRoutingTable& client_routing_table)
+    : ReplayNetworkUtils(routing_table, client_routing_table, new ReplayTransport) {}
+
+ReplayNetworkUtils::ReplayNetworkUtils(RoutingTable& routing_table,
+                                       ClientRoutingTable& client_routing_table,
+                                       ReplayTransport* transport)
+    : NetworkUtils(routing_table, client_routing_table, std::unique_ptr<Transport>(transport)),
+      transport_(*transport) {}
+
+int ReplayNetworkUtils::GetAvailableEndpoint(const NodeId& /*peer_id*/,
+                                             const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                             rudp::EndpointPair& /*this_endpoint_pair*/,
+                                             rudp::NatType& /*this_nat_type*/) {
+  return kGeneralError;
+}
+
+int ReplayNetworkUtils::Add(const NodeId& /*peer_id*/,
+                            const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                            const std::string& /*validation_data*/) {
+  return kGeneralError;
+}
+
+int ReplayNetworkUtils::MarkConnectionAsValid(const NodeId& /*peer_id*/) { return kGeneralError; }
+
+ReplayResults::ReplayResults() : messages(0), parse_failures(0), sends(0), elapsed() {}
+
+MessageReplayer::MessageReplayer(const NodeId& node_id,
+                                 const std::vector<CapturedMessage>& messages)
+    : asio_service_(2),
+      timer_(asio_service_),
+      kNodeId_(node_id),
+      network_statistics_(kNodeId_),
+      routing_table_(false, kNodeId_, asymm::GenerateKeyPair(), network_statistics_),
+      client_routing_table_(kNodeId_),
+      network_(routing_table_, client_routing_table_),
+      remove_furthest_node_(routing_table_, network_),
+      group_change_handler_(routing_table_, client_routing_table_, network_),
+      message_handler_(routing_table_, client_routing_table_, network_, timer_,
+                       remove_furthest_node_, group_change_handler_, network_statistics_) {
+  routing_table_.InitialiseFunctors([](int) {}, [](const NodeInfo&, bool) {}, []() {},
+                                    [](std::vector<NodeInfo>, std::vector<NodeInfo>) {},
+                                    [](std::shared_ptr<MatrixChange>) {});
+  std::set<NodeId> peers;
+  for (const auto& message : messages) {
+    if (peers.size() == Parameters::max_routing_table_size)
+      break;
+    if (message.connection_id.IsZero() || message.connection_id == kNodeId_ ||
+        !peers.insert(message.connection_id).second) {
+      continue;
+    }
+    NodeInfo peer;
+    peer.node_id = message.connection_id;
+    peer.connection_id = message.connection_id;
+    peer.public_key = asymm::GenerateKeyPair().public_key;
+    routing_table_.AddNode(peer);
+  }
+
+  // The upper layer neither replies nor has anything cached.
+  MessageAndCachingFunctors functors;
+  functors.message_received = [](const std::string& /*message*/, bool /*cache_lookup*/,
+                                 ReplyFunctor /*reply_functor*/) {};
+  functors.have_cache_data = [](std::string&) { return false; };
+  functors.store_cache_data = [](const std::string&) {};
+  message_handler_.set_message_and_caching_functor(functors);
+}
+
+MessageReplayer::~MessageReplayer() { asio_service_.Stop(); }
+
+ReplayResults MessageReplayer::Replay(const std::vector<CapturedMessage>& messages,
+                                      bool original_pacing) {
+  ReplayResults results;
+  if (messages.empty())
+    return results;
+  const uint64_t kFirstSentCount(network_.sent_count());
+  const auto kStart(std::chrono::steady_clock::now());
+  for (const auto& captured_message : messages) {
+    if (original_pacing)
+      std::this_thread::sleep_until(kStart + (captured_message.time - messages.front().time));
+    protobuf::Message message;
+    if (message.ParseFromString(captured_message.message))
+      message_handler_.HandleMessage(message);
+    else
+      ++results.parse_failures;
+    ++results.messages;
+  }
+  results.elapsed = std::chrono::steady_clock::now() - kStart;
+  results.sends = network_.sent_count() - kFirstSentCount;
+  return results;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,154 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TESTS_MESSAGE_REPLAYER_H_
+#define MAIDSAFE_ROUTING_TESTS_MESSAGE_REPLAYER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/client_routing_table.h"
+#include "maidsafe/routing/group_change_handler.h"
+#include "maidsafe/routing/message_capture.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/network_statistics.h"
+#include "maidsafe/routing/network_utils.h"
+#include "maidsafe/routing/remove_furthest_node.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/timer.h"
+#include "maidsafe/routing/transport.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Counts and discards every message sent over it, without running their message sent functors,
+// so that nothing is recorded as either delivered or failed.  Refuses all connections.
+class ReplayTransport : public Transport {
+ public:
+  ReplayTransport() : sent_count_(0) {}
+  virtual ~ReplayTransport() {}
+  virtual int Bootstrap(const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id, std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                        const boost::asio::ip::udp::endpoint& local_endpoint);
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id,
+                                    boost::asio::ip::udp::endpoint& new_bootstrap_endpoint);
+  virtual void Remove(const NodeId& /*peer_id*/) {}
+  virtual void Send(const NodeId& peer_id, std::string&& message,
+                    const rudp::MessageSentFunctor& message_sent_functor);
+  uint64_t sent_count() const { return sent_count_; }
+
+ private:
+  ReplayTransport(const ReplayTransport&);
+  ReplayTransport(const ReplayTransport&&);
+  ReplayTransport& operator=(const ReplayTransport&);
+
+  std::atomic<uint64_t> sent_count_;
+};
+
+// Sends over a ReplayTransport, and refuses all new connections.
+class ReplayNetworkUtils : public NetworkUtils {
+ public:
+  ReplayNetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table);
+  virtual ~ReplayNetworkUtils() {}
+
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id);
+  uint64_t sent_count() const { return transport_.sent_count(); }
+
+ private:
+  ReplayNetworkUtils(const ReplayNetworkUtils&);
+  ReplayNetworkUtils(const ReplayNetworkUtils&&);
+  ReplayNetworkUtils& operator=(const ReplayNetworkUtils&);
+  ReplayNetworkUtils(RoutingTable& routing_table, ClientRoutingTable& client_routing_table,
+                     ReplayTransport* transport);
+
+  // Owned by the base class.
+  ReplayTransport& transport_;
+};
+
+struct ReplayResults {
+  ReplayResults();
+  uint64_t messages, parse_failures, sends;
+  std::chrono::steady_clock::duration elapsed;
+};
+
+// A vault's MessageHandler behind a ReplayNetworkUtils, through which a capture (see
+// message_capture.h) is fed back.  The routing table is filled with the nodes which the captured
+// messages came from, so that forwarding resembles that of the capturing node.
+class MessageReplayer {
+ public:
+  MessageReplayer(const NodeId& node_id, const std::vector<CapturedMessage>& messages);
+  ~MessageReplayer();
+  // Handles the messages in turn on the calling thread, either each at its captured time relative
+  // to the first or as fast as possible.
+  ReplayResults Replay(const std::vector<CapturedMessage>& messages, bool original_pacing);
+  size_t routing_table_size() const { return routing_table_.size(); }
+
+ private:
+  MessageReplayer(const MessageReplayer&);
+  MessageReplayer(const MessageReplayer&&);
+  MessageReplayer& operator=(const MessageReplayer&);
+
+  AsioService asio_service_;
+  Timer<std::string> timer_;
+  const NodeId kNodeId_;
+  NetworkStatistics network_statistics_;
+  RoutingTable routing_table_;
+  ClientRoutingTable client_routing_table_;
+  ReplayNetworkUtils network_;
+  RemoveFurthestNode remove_furthest_node_;
+  GroupChangeHandler group_change_handler_;
+  MessageHandler message_handler_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TESTS_MESSAGE_REPLAYER_H_
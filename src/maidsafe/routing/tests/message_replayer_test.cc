@@ -0,0 +1,99 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/message_capture.h"
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/tests/message_replayer.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+std::string MakeMessage(const NodeId& source_id, const NodeId& destination_id, bool direct,
+                        int32_t id) {
+  protobuf::Message message;
+  message.set_source_id(source_id.string());
+  message.set_destination_id(destination_id.string());
+  message.set_routing_message(false);
+  message.set_direct(direct);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_type(static_cast<int32_t>(MessageType::kNodeLevel));
+  message.set_id(id);
+  message.add_data("data");
+  if (!direct)
+    message.set_replication(Parameters::group_size);
+  return message.SerializeAsString();
+}
+
+}  // unnamed namespace
+
+TEST(MessageReplayerTest, BEH_Replay) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestReplayer"));
+  boost::filesystem::path file_path(*test_path / "capture");
+  NodeId node_id(NodeId::kRandomId), peer_a(NodeId::kRandomId);
+  std::string peer_b_id(peer_a.string()), group_id(node_id.string());
+  peer_b_id.back() ^= 0x01;
+  group_id.back() ^= 0x01;
+  NodeId peer_b(peer_b_id);
+  {
+    MessageCapture capture(file_path, node_id, 1024 * 1024);
+    // Passed on to the peer it's for
+    capture.Record(MakeMessage(peer_a, peer_b, true, 1), peer_a.string());
+    capture.Record("not a message", peer_b.string());
+    // This node leads the group, so it's replicated to both peers
+    capture.Record(MakeMessage(peer_b, NodeId(group_id), false, 2), peer_b.string());
+    // Peer B is closer than this node to peer A's group, so it's passed on to peer B
+    capture.Record(MakeMessage(peer_b, peer_a, false, 3), peer_b.string());
+  }
+
+  NodeId read_node_id;
+  auto messages(ReadMessageCapture(file_path, read_node_id));
+  ASSERT_EQ(4U, messages.size());
+  MessageReplayer replayer(read_node_id, messages);
+  EXPECT_EQ(2U, replayer.routing_table_size());
+  ReplayResults results(replayer.Replay(messages, false));
+  EXPECT_EQ(4U, results.messages);
+  EXPECT_EQ(1U, results.parse_failures);
+  EXPECT_EQ(4U, results.sends);
+
+  // The counts are of each replay alone
+  results = replayer.Replay(messages, false);
+  EXPECT_EQ(4U, results.messages);
+  EXPECT_EQ(1U, results.parse_failures);
+  EXPECT_EQ(4U, results.sends);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,119 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <cstdint>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/message_statistics.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+protobuf::Message MessageOfType(int32_t type) {
+  protobuf::Message message;
+  message.set_type(type);
+  return message;
+}
+
+protobuf::Message MessageAfterHops(int32_t hops) {
+  protobuf::Message message;
+  message.set_hops_to_live(static_cast<int32_t>(Parameters::hops_to_live) - hops);
+  return message;
+}
+
+}  // unnamed namespace
+
+TEST(MessageStatisticsTest, BEH_RecordTypeAndHandling) {
+  MessageStatistics message_statistics;
+  Statistics statistics;
+  message_statistics.Snapshot(statistics);
+  EXPECT_EQ(10U, statistics.messages_by_type.size());
+  for (const auto& count : statistics.messages_by_type)
+    EXPECT_EQ(0U, count.second) << count.first;
+  EXPECT_EQ(10U, statistics.messages_by_handling.size());
+  for (const auto& count : statistics.messages_by_handling)
+    EXPECT_EQ(0U, count.second) << count.first;
+
+  message_statistics.Record(MessageOfType(static_cast<int32_t>(MessageType::kPing)));
+  message_statistics.Record(MessageOfType(static_cast<int32_t>(MessageType::kPing)));
+  message_statistics.Record(MessageOfType(static_cast<int32_t>(MessageType::kGetGroup)));
+  message_statistics.Record(MessageOfType(static_cast<int32_t>(MessageType::kNodeLevel)));
+  // Types outside the routing range, other than node level, are counted as unknown
+  message_statistics.Record(MessageOfType(1000));
+  message_statistics.Record(MessageOfType(-5));
+  message_statistics.Record(MessageStatistics::Handling::kFarNode);
+  message_statistics.Record(MessageStatistics::Handling::kFarNode);
+  message_statistics.Record(MessageStatistics::Handling::kDropped);
+
+  message_statistics.Snapshot(statistics);
+  EXPECT_EQ(2U, statistics.messages_by_type.at("Ping"));
+  EXPECT_EQ(1U, statistics.messages_by_type.at("GetGroup"));
+  EXPECT_EQ(1U, statistics.messages_by_type.at("NodeLevel"));
+  EXPECT_EQ(2U, statistics.messages_by_type.at("Unknown"));
+  EXPECT_EQ(0U, statistics.messages_by_type.at("Connect"));
+  EXPECT_EQ(2U, statistics.messages_by_handling.at("FarNode"));
+  EXPECT_EQ(1U, statistics.messages_by_handling.at("Dropped"));
+  EXPECT_EQ(0U, statistics.messages_by_handling.at("Relay"));
+}
+
+TEST(MessageStatisticsTest, BEH_RecordDelivery) {
+  MessageStatistics message_statistics;
+  Statistics statistics;
+  message_statistics.Snapshot(statistics);
+  ASSERT_EQ(3U, statistics.hops_by_destination.size());
+  for (const auto& hop_counts : statistics.hops_by_destination)
+    EXPECT_TRUE(hop_counts.second.empty()) << hop_counts.first;
+
+  message_statistics.RecordDelivery(MessageStatistics::Destination::kDirect, MessageAfterHops(3));
+  message_statistics.RecordDelivery(MessageStatistics::Destination::kDirect, MessageAfterHops(3));
+  message_statistics.RecordDelivery(MessageStatistics::Destination::kDirect, MessageAfterHops(1));
+  // More hops to live than a message starts with is counted as zero hops, and very long routes
+  // are counted in the last slot
+  message_statistics.RecordDelivery(MessageStatistics::Destination::kGroupLeader,
+                                    MessageAfterHops(-2));
+  message_statistics.RecordDelivery(MessageStatistics::Destination::kGroupMember,
+                                    MessageAfterHops(1000));
+
+  message_statistics.Snapshot(statistics);
+  // Trailing zero counts are trimmed
+  HopCounts expected_direct(4, 0);
+  expected_direct[1] = 1;
+  expected_direct[3] = 2;
+  EXPECT_EQ(expected_direct, statistics.hops_by_destination.at("Direct"));
+  EXPECT_EQ(HopCounts(1, 1), statistics.hops_by_destination.at("GroupLeader"));
+  const HopCounts& group_member(statistics.hops_by_destination.at("GroupMember"));
+  ASSERT_EQ(64U, group_member.size());
+  EXPECT_EQ(1U, group_member.back());
+  EXPECT_DOUBLE_EQ((1.0 + 3.0 * 2) / 3, MeanHops(statistics.hops_by_destination.at("Direct")));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
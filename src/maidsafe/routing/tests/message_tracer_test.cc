@@ -0,0 +1,153 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/message_tracer.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/routing.pb.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count(0);
+  for (size_t position(text.find(pattern)); position != std::string::npos;
+       position = text.find(pattern, position + pattern.size()))
+    ++count;
+  return count;
+}
+
+protobuf::Message MakeMessage(int32_t message_id) {
+  protobuf::Message message;
+  message.set_id(message_id);
+  message.set_source_id(NodeId(NodeId::kRandomId).string());
+  return message;
+}
+
+}  // unnamed namespace
+
+class MessageTracerTest : public testing::Test {
+ protected:
+  MessageTracerTest() : kSampleRate_(Parameters::message_trace_sample_rate) { ClearTrace(); }
+  ~MessageTracerTest() { Parameters::message_trace_sample_rate = kSampleRate_; }
+
+  const uint32_t kSampleRate_;
+};
+
+TEST_F(MessageTracerTest, BEH_Sampling) {
+  Parameters::message_trace_sample_rate = 0;
+  EXPECT_FALSE(TracingEnabled());
+  EXPECT_FALSE(TraceKey(MakeMessage(1)).sampled);
+
+  Parameters::message_trace_sample_rate = 1;
+  EXPECT_TRUE(TracingEnabled());
+  EXPECT_TRUE(TraceKey(MakeMessage(1)).sampled);
+
+  // Roughly one in sample_rate messages is sampled, and the same message is always sampled alike
+  Parameters::message_trace_sample_rate = 10;
+  int sampled_count(0);
+  for (int32_t i(0); i != 1000; ++i) {
+    protobuf::Message message(MakeMessage(i));
+    TraceKey key(message);
+    EXPECT_EQ(key.sampled, TraceKey(message).sampled);
+    if (key.sampled)
+      ++sampled_count;
+  }
+  EXPECT_LT(50, sampled_count);
+  EXPECT_GT(150, sampled_count);
+}
+
+TEST_F(MessageTracerTest, BEH_ChromeTraceJson) {
+  Parameters::message_trace_sample_rate = 1;
+  protobuf::Message message(MakeMessage(1234));
+  {
+    ScopedTraceSpan outer_span("Outer", message);
+    ScopedTraceSpan inner_span("Inner", TraceKey(message));
+  }
+  auto now(std::chrono::steady_clock::now());
+  RecordTraceSpan("Explicit", TraceKey(message), now - std::chrono::milliseconds(5), now);
+
+  std::string json(ChromeTraceJson());
+  EXPECT_EQ(0U, json.find("{\"traceEvents\":["));
+  EXPECT_EQ(3U, CountOccurrences(json, "\"ph\":\"X\""));
+  EXPECT_EQ(1U, CountOccurrences(json, "\"name\":\"Outer\""));
+  EXPECT_EQ(1U, CountOccurrences(json, "\"name\":\"Inner\""));
+  EXPECT_EQ(1U, CountOccurrences(json, "\"name\":\"Explicit\""));
+  EXPECT_EQ(3U, CountOccurrences(json, "\"message_id\":1234"));
+  EXPECT_NE(std::string::npos, json.find("\"dur\":5000"));
+
+  // Unsampled messages aren't recorded
+  Parameters::message_trace_sample_rate = 0;
+  { ScopedTraceSpan span("Unsampled", message); }
+  EXPECT_EQ(std::string::npos, ChromeTraceJson().find("Unsampled"));
+
+  ClearTrace();
+  EXPECT_EQ(0U, CountOccurrences(ChromeTraceJson(), "\"ph\":\"X\""));
+}
+
+TEST_F(MessageTracerTest, BEH_PerThreadRingBuffers) {
+  Parameters::message_trace_sample_rate = 1;
+  const int kThreadCount(4), kSpanCount(5000);
+  std::atomic<int> finished_count(0);
+  std::vector<std::thread> threads;
+  for (int i(0); i != kThreadCount; ++i) {
+    threads.push_back(std::thread([i, kSpanCount, kThreadCount, &finished_count] {
+      TraceKey key(MakeMessage(i));
+      for (int j(0); j != kSpanCount; ++j) {
+        ScopedTraceSpan span("Span", key);
+      }
+      // An exited thread's buffer is reused by the next new thread, so keep all threads alive
+      ++finished_count;
+      while (finished_count != kThreadCount)
+        std::this_thread::yield();
+    }));
+  }
+  // Reading while spans are being written must be safe
+  std::string json;
+  for (int i(0); i != 10; ++i)
+    json = ChromeTraceJson();
+  for (auto& thread : threads)
+    thread.join();
+
+  // Each thread keeps only its most recent spans
+  json = ChromeTraceJson();
+  size_t span_count(CountOccurrences(json, "\"ph\":\"X\""));
+  EXPECT_LT(static_cast<size_t>(kThreadCount), span_count);
+  EXPECT_GT(static_cast<size_t>(kThreadCount * kSpanCount), span_count);
+  for (int i(0); i != kThreadCount; ++i)
+    EXPECT_NE(std::string::npos, json.find("\"message_id\":" + std::to_string(i) + ","));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
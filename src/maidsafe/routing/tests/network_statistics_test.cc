@@ -18,7 +18,7 @@
 
 #include <bitset>
 #include <memory>
-#include <numeric>
+#include <string>
 #include <vector>
 
 #include "maidsafe/common/node_id.h"
@@ -34,54 +34,74 @@ namespace maidsafe {
 namespace routing {
 namespace test {
 
+namespace {
+
+// Returns a distance of 'fraction' of the address space.
+NodeId FractionToDistance(double fraction) {
+  std::string distance(NodeId::kSize, '\0');
+  for (size_t i(0); i != 16; ++i) {
+    fraction *= 256.0;
+    auto byte(static_cast<unsigned char>(fraction));
+    distance[i] = static_cast<char>(byte);
+    fraction -= byte;
+  }
+  return NodeId(distance);
+}
+
+}  // unnamed namespace
+
 TEST(NetworkStatisticsTest, BEH_AverageDistance) {
   NodeId node_id(NodeId::kRandomId);
-  NodeId average(node_id);
   NetworkStatistics network_statistics(node_id);
-  network_statistics.network_distance_data_.average_distance = average;
-  network_statistics.UpdateNetworkAverageDistance(average);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
-
-  node_id = NodeId();
-  network_statistics.network_distance_data_.total_distance = crypto::BigInt::Zero();
-  network_statistics.network_distance_data_.average_distance = NodeId();
-  average = node_id;
-  network_statistics.UpdateNetworkAverageDistance(node_id);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
+  EXPECT_EQ(0.0, network_statistics.network_average_distance_.load());
 
-  node_id = NodeId(NodeId::kMaxId);
-  network_statistics.network_distance_data_.total_distance =
-      crypto::BigInt((node_id.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()) *
-      network_statistics.network_distance_data_.contributors_count;
-  average = node_id;
-  network_statistics.UpdateNetworkAverageDistance(node_id);
-  EXPECT_EQ(network_statistics.network_distance_data_.average_distance, average);
+  // A zero distance is ignored
+  network_statistics.UpdateNetworkAverageDistance(NodeId());
+  EXPECT_EQ(0.0, network_statistics.network_average_distance_.load());
 
-  network_statistics.network_distance_data_.contributors_count = 0;
-  network_statistics.network_distance_data_.total_distance = crypto::BigInt::Zero();
-
-  std::vector<NodeId> distances_as_node_id;
-  std::vector<crypto::BigInt> distances_as_bigint;
-  uint32_t kCount(RandomUint32() % 1000 + 9000);
-  for (uint32_t i(0); i < kCount; ++i) {
-    NodeId node_id(NodeId::kRandomId);
-    distances_as_node_id.push_back(node_id);
-    distances_as_bigint.push_back(
-        crypto::BigInt((node_id.ToStringEncoded(NodeId::EncodingType::kHex) + 'h').c_str()));
+  // The first sample is taken as the average, and a constant sample leaves it unchanged
+  NodeId distance(FractionToDistance(0.25));
+  for (int i(0); i != 10; ++i) {
+    network_statistics.UpdateNetworkAverageDistance(distance);
+    EXPECT_DOUBLE_EQ(0.25, network_statistics.network_average_distance_.load());
   }
 
-  crypto::BigInt total(std::accumulate(distances_as_bigint.begin(), distances_as_bigint.end(),
-                                       crypto::BigInt::Zero()));
-
-  for (const auto& node_id : distances_as_node_id)
-    network_statistics.UpdateNetworkAverageDistance(node_id);
+  node_id = NodeId(NodeId::kMaxId);
+  network_statistics.network_average_distance_ = 0.0;
+  network_statistics.UpdateNetworkAverageDistance(node_id);
+  EXPECT_NEAR(1.0, network_statistics.network_average_distance_.load(), 1e-12);
 
-  crypto::BigInt matrix_average_as_bigint(
-      (network_statistics.network_distance_data_.average_distance.ToStringEncoded(
-           NodeId::EncodingType::kHex) +
-       'h').c_str());
+  // Random distances average out at half the address space
+  network_statistics.network_average_distance_ = 0.0;
+  uint32_t kCount(RandomUint32() % 1000 + 9000);
+  for (uint32_t i(0); i < kCount; ++i)
+    network_statistics.UpdateNetworkAverageDistance(NodeId(NodeId::kRandomId));
+  EXPECT_NEAR(0.5, network_statistics.network_average_distance_.load(), 0.2);
+
+  // Stale samples are forgotten
+  distance = FractionToDistance(0.001);
+  for (uint16_t i(0); i < Parameters::network_distance_sample_window * 20; ++i)
+    network_statistics.UpdateNetworkAverageDistance(distance);
+  EXPECT_NEAR(0.001, network_statistics.network_average_distance_.load(), 0.0001);
+}
 
-  EXPECT_EQ(total / kCount, matrix_average_as_bigint);
+TEST(NetworkStatisticsTest, BEH_EstimatedNetworkSize) {
+  NetworkStatistics network_statistics((NodeId(NodeId::kRandomId)));
+  EXPECT_EQ(0U, network_statistics.EstimatedNetworkSize());
+
+  // Falls back to the local group radius if no peer has reported one
+  std::vector<NodeId> nodes;
+  for (int i(0); i != 10000; ++i)
+    nodes.push_back(NodeId(NodeId::kRandomId));
+  network_statistics.UpdateLocalAverageDistance(nodes);
+  EXPECT_GT(network_statistics.EstimatedNetworkSize(), 1000U);
+  EXPECT_LT(network_statistics.EstimatedNetworkSize(), 100000U);
+
+  const uint64_t kNetworkSize(5000);
+  NodeId distance(FractionToDistance(static_cast<double>(Parameters::group_size) / kNetworkSize));
+  network_statistics.UpdateNetworkAverageDistance(distance);
+  EXPECT_NEAR(static_cast<double>(kNetworkSize),
+              static_cast<double>(network_statistics.EstimatedNetworkSize()), 1.0);
 }
 
 TEST(NetworkStatisticsTest, BEH_IsIdInGroupRange) {
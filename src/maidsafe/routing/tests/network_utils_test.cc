@@ -21,6 +21,7 @@
 #include <future>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "boost/filesystem/exception.hpp"
@@ -36,6 +37,7 @@
 #include "maidsafe/routing/return_codes.h"
 #include "maidsafe/routing/routing_table.h"
 #include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/transport.h"
 #include "maidsafe/routing/tests/test_utils.h"
 
 namespace maidsafe {
@@ -50,6 +52,53 @@ namespace {
 
 typedef boost::asio::ip::udp::endpoint Endpoint;
 
+// Keeps each send's functor, so that the test decides how the send fares, and each peer removed.
+class RecordingTransport : public Transport {
+ public:
+  typedef std::vector<std::pair<NodeId, rudp::MessageSentFunctor>> Sends;
+  RecordingTransport(Sends& sends, std::vector<NodeId>& removed)
+      : sends_(sends), removed_(removed) {}
+  virtual int Bootstrap(const std::vector<Endpoint>& /*bootstrap_endpoints*/,
+                        const rudp::MessageReceivedFunctor& /*message_received_functor*/,
+                        const rudp::ConnectionLostFunctor& /*connection_lost_functor*/,
+                        const NodeId& /*this_node_id*/,
+                        std::shared_ptr<asymm::PrivateKey> /*private_key*/,
+                        std::shared_ptr<asymm::PublicKey> /*public_key*/,
+                        NodeId& /*chosen_bootstrap_peer*/, rudp::NatType& /*nat_type*/,
+                        const Endpoint& /*local_endpoint*/) {
+    return rudp::kSuccess;
+  }
+  virtual int GetAvailableEndpoint(const NodeId& /*peer_id*/,
+                                   const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                   rudp::EndpointPair& /*this_endpoint_pair*/,
+                                   rudp::NatType& /*this_nat_type*/) {
+    return rudp::kSuccess;
+  }
+  virtual int Add(const NodeId& /*peer_id*/, const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                  const std::string& /*validation_data*/) {
+    return rudp::kSuccess;
+  }
+  virtual int MarkConnectionAsValid(const NodeId& /*peer_id*/,
+                                    Endpoint& /*new_bootstrap_endpoint*/) {
+    return rudp::kSuccess;
+  }
+  virtual void Remove(const NodeId& peer_id) { removed_.push_back(peer_id); }
+  virtual void Send(const NodeId& peer_id, std::string&& /*message*/,
+                    const rudp::MessageSentFunctor& message_sent_functor) {
+    sends_.push_back(std::make_pair(peer_id, message_sent_functor));
+  }
+
+ private:
+  Sends& sends_;
+  std::vector<NodeId>& removed_;
+};
+
+// Fails the latest send.  Its functor is copied first, as the retry it causes adds to 'sends'.
+void FailLastSend(const RecordingTransport::Sends& sends) {
+  rudp::MessageSentFunctor message_sent_functor(sends.back().second);
+  message_sent_functor(rudp::kSendFailure);
+}
+
 void SortFromThisNode(const NodeId& from, std::vector<NodeInfoAndPrivateKey> nodes) {
   std::sort(nodes.begin(), nodes.end(),
             [from](const NodeInfoAndPrivateKey & i, const NodeInfoAndPrivateKey & j) {
@@ -98,6 +147,61 @@ TEST(NetworkUtilsTest, BEH_ProcessSendUnavailableDirectEndpoint) {
   network.SendToDirect(message, NodeId(NodeId::kRandomId), NodeId(NodeId::kRandomId));
 }
 
+TEST(NetworkUtilsTest, BEH_RetryAvoidsFlakyPeerWithoutDroppingAlternative) {
+  NodeId node_id(NodeId::kRandomId);
+  NetworkStatistics network_statistics(node_id);
+  RoutingTable routing_table(false, node_id, asymm::GenerateKeyPair(), network_statistics);
+  ClientRoutingTable client_routing_table(routing_table.kNodeId());
+  routing_table.InitialiseFunctors([](int) {}, [](const NodeInfo&, bool) {}, []() {},
+                                   [](std::vector<NodeInfo>, std::vector<NodeInfo>) {},
+                                   [](std::shared_ptr<MatrixChange>) {});
+  // Both peers differ from the target first at the same bit, and so are near-equally close to it.
+  const NodeId kTargetId(NodeId::kRandomId);
+  std::string closest_id(kTargetId.string()), alternative_id(kTargetId.string());
+  closest_id.back() ^= 0x02;
+  alternative_id.back() ^= 0x03;
+  NodeInfo closest(MakeNode()), alternative(MakeNode());
+  closest.node_id = closest.connection_id = NodeId(closest_id);
+  alternative.node_id = alternative.connection_id = NodeId(alternative_id);
+  ASSERT_TRUE(routing_table.AddNode(closest));
+  ASSERT_TRUE(routing_table.AddNode(alternative));
+
+  RecordingTransport::Sends sends;
+  std::vector<NodeId> removed;
+  NetworkUtils network(routing_table, client_routing_table,
+                       std::unique_ptr<Transport>(new RecordingTransport(sends, removed)));
+  protobuf::Message message;
+  message.set_routing_message(true);
+  message.set_client_node(false);
+  message.set_request(true);
+  message.add_data("data");
+  message.set_direct(false);
+  message.set_type(10);
+  message.set_hops_to_live(Parameters::hops_to_live);
+  message.set_source_id(node_id.string());
+  message.set_destination_id(kTargetId.string());
+  network.SendToClosestNode(message);
+  ASSERT_EQ(1U, sends.size());
+  EXPECT_EQ(closest.connection_id, sends.back().first);
+
+  // Two failures make the closest peer flaky, so the second retry goes to the alternative.
+  FailLastSend(sends);
+  ASSERT_EQ(2U, sends.size());
+  EXPECT_EQ(closest.connection_id, sends.back().first);
+  FailLastSend(sends);
+  ASSERT_EQ(3U, sends.size());
+  EXPECT_EQ(alternative.connection_id, sends.back().first);
+  ASSERT_TRUE(routing_table.link_quality_table().IsFlaky(closest.node_id));
+
+  // That is the alternative's first failure, not the message's third, so it is retried and kept.
+  FailLastSend(sends);
+  ASSERT_EQ(4U, sends.size());
+  EXPECT_EQ(alternative.connection_id, sends.back().first);
+  EXPECT_TRUE(removed.empty());
+  EXPECT_EQ(2U, routing_table.size());
+  EXPECT_TRUE(routing_table.IsConnected(alternative.node_id));
+}
+
 TEST(NetworkUtilsTest, FUNC_ProcessSendDirectEndpoint) {
   const int kMessageCount(10);
   rudp::ManagedConnections rudp1, rudp2;
@@ -0,0 +1,131 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/persistent_cache_store.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+std::string Read(PersistentCacheStore& store, const std::string& key) {
+  std::string value;
+  store.Get(key, [&value](const char* data, size_t size) { value.assign(data, size); });
+  return value;
+}
+
+}  // unnamed namespace
+
+TEST(PersistentCacheStoreTest, BEH_AddGetAndReload) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestCacheStore"));
+  fs::path file_path(*test_path / "cache_store");
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (int i(0); i != 10; ++i)
+    entries.push_back(std::make_pair(RandomString(64), RandomString(1000)));
+  {
+    PersistentCacheStore store(file_path, 1024 * 1024);
+    // Nothing is held or added until the file has been loaded
+    store.Add(entries.front().first, entries.front().second);
+    store.Load();
+    EXPECT_EQ(0U, store.size());
+    EXPECT_FALSE(store.Get(entries.front().first, [](const char*, size_t) { FAIL(); }));
+    for (const auto& entry : entries)
+      store.Add(entry.first, entry.second);
+    EXPECT_EQ(entries.size(), store.size());
+    for (const auto& entry : entries)
+      EXPECT_EQ(entry.second, Read(store, entry.first));
+    // Re-adding replaces the held value
+    entries.front().second = RandomString(10);
+    store.Add(entries.front().first, entries.front().second);
+    EXPECT_EQ(entries.size(), store.size());
+    EXPECT_EQ(entries.front().second, Read(store, entries.front().first));
+  }
+  EXPECT_EQ(1024 * 1024U, fs::file_size(file_path));
+
+  // Entries survive reopening
+  {
+    PersistentCacheStore store(file_path, 1024 * 1024);
+    store.Load();
+    EXPECT_EQ(entries.size(), store.size());
+    for (const auto& entry : entries)
+      EXPECT_EQ(entry.second, Read(store, entry.first));
+  }
+
+  // Reopening with a different capacity discards the contents
+  {
+    PersistentCacheStore store(file_path, 512 * 1024);
+    store.Load();
+    EXPECT_EQ(0U, store.size());
+  }
+}
+
+TEST(PersistentCacheStoreTest, BEH_Wrap) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_TestCacheStore"));
+  fs::path file_path(*test_path / "cache_store");
+  const uint64_t kCapacity(16 * 1024);
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (int i(0); i != 100; ++i)
+    entries.push_back(std::make_pair(RandomString(64), RandomString(RandomUint32() % 1000)));
+  size_t held_count(0);
+  {
+    PersistentCacheStore store(file_path, kCapacity);
+    store.Load();
+    for (const auto& entry : entries) {
+      store.Add(entry.first, entry.second);
+      EXPECT_EQ(entry.second, Read(store, entry.first));
+      EXPECT_LE(store.header().write_offset, kCapacity);
+      EXPECT_EQ(store.index_.size(), store.keys_by_offset_.size());
+    }
+    held_count = store.size();
+    EXPECT_LT(held_count, entries.size());
+    // The most recently added entries are the ones still held
+    for (size_t i(0); i != entries.size(); ++i) {
+      bool held(store.Get(entries.at(i).first, [](const char*, size_t) {}));
+      EXPECT_EQ(i >= entries.size() - held_count, held);
+    }
+    // A value which could never fit is not held
+    store.Add(RandomString(64), RandomString(kCapacity));
+    EXPECT_EQ(held_count, store.size());
+  }
+
+  PersistentCacheStore store(file_path, kCapacity);
+  store.Load();
+  EXPECT_EQ(held_count, store.size());
+  for (size_t i(entries.size() - held_count); i != entries.size(); ++i)
+    EXPECT_EQ(entries.at(i).second, Read(store, entries.at(i).first));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,94 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/profiled_mutex.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(ProfiledMutexTest, BEH_MutualExclusion) {
+  ProfiledMutex mutex("ProfiledMutexTest.MutualExclusion");
+  int counter(0);
+  std::vector<std::thread> threads;
+  for (int i(0); i != 4; ++i) {
+    threads.push_back(std::thread([&] {
+      for (int j(0); j != 1000; ++j) {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        ++counter;
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(4000, counter);
+
+  std::unique_lock<ProfiledMutex> lock(mutex, std::try_to_lock);
+  EXPECT_TRUE(lock.owns_lock());
+}
+
+TEST(ProfiledMutexTest, BEH_Statistics) {
+  const std::string kName("ProfiledMutexTest.Statistics");
+  ProfiledMutex mutex(kName.c_str()), other_mutex(kName.c_str());
+  for (int i(0); i != 10; ++i) {
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(mutex));
+  }
+  const char* const kSlowSite(ROUTING_LOCK_SITE);
+  {
+    std::lock_guard<ProfiledMutex> lock(other_mutex.At(kSlowSite));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  auto lock_statistics(GetLockStatistics());
+#ifdef ROUTING_LOCK_PROFILING
+  // Mutexes sharing a name are reported together
+  ASSERT_EQ(1U, lock_statistics.count(kName));
+  const LockStatistics& statistics(lock_statistics.at(kName));
+  EXPECT_EQ(11U, statistics.acquisitions);
+  uint64_t wait_count(0), hold_count(0);
+  for (const auto& bucket : statistics.wait_time)
+    wait_count += bucket.second;
+  for (const auto& bucket : statistics.hold_time)
+    hold_count += bucket.second;
+  EXPECT_EQ(11U, wait_count);
+  EXPECT_EQ(11U, hold_count);
+  EXPECT_GE(LatencyPercentile(statistics.hold_time, 100), std::chrono::milliseconds(20));
+  ASSERT_FALSE(statistics.longest_holds.empty());
+  EXPECT_GE(statistics.longest_holds.front().first, std::chrono::milliseconds(20));
+  EXPECT_EQ(std::string(kSlowSite), statistics.longest_holds.front().second);
+  for (size_t i(1); i < statistics.longest_holds.size(); ++i)
+    EXPECT_GE(statistics.longest_holds[i - 1].first, statistics.longest_holds[i].first);
+#else
+  EXPECT_TRUE(lock_statistics.empty());
+#endif
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,100 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/public_key_cache.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(PublicKeyCacheTest, BEH_AddAndGet) {
+  PublicKeyCache public_key_cache(10, std::chrono::minutes(10));
+  NodeId node_id(NodeId::kRandomId);
+  asymm::Keys keys(asymm::GenerateKeyPair()), other_keys(asymm::GenerateKeyPair());
+  asymm::PublicKey public_key;
+  EXPECT_FALSE(public_key_cache.Get(node_id, public_key));
+  EXPECT_FALSE(public_key_cache.Contains(node_id, keys.public_key));
+
+  public_key_cache.Add(node_id, keys.public_key);
+  EXPECT_EQ(1U, public_key_cache.size());
+  EXPECT_TRUE(public_key_cache.Get(node_id, public_key));
+  EXPECT_TRUE(asymm::MatchingKeys(keys.public_key, public_key));
+  EXPECT_TRUE(public_key_cache.Contains(node_id, keys.public_key));
+  EXPECT_FALSE(public_key_cache.Contains(node_id, other_keys.public_key));
+
+  // Re-adding replaces the held key
+  public_key_cache.Add(node_id, other_keys.public_key);
+  EXPECT_EQ(1U, public_key_cache.size());
+  EXPECT_TRUE(public_key_cache.Contains(node_id, other_keys.public_key));
+  EXPECT_FALSE(public_key_cache.Contains(node_id, keys.public_key));
+
+  public_key_cache.Remove(node_id);
+  EXPECT_EQ(0U, public_key_cache.size());
+  EXPECT_FALSE(public_key_cache.Get(node_id, public_key));
+
+  // Zero ids are never held
+  public_key_cache.Add(NodeId(), keys.public_key);
+  EXPECT_EQ(0U, public_key_cache.size());
+}
+
+TEST(PublicKeyCacheTest, BEH_Expiry) {
+  PublicKeyCache public_key_cache(10, std::chrono::milliseconds(100));
+  asymm::Keys keys(asymm::GenerateKeyPair());
+  NodeId node_id(NodeId::kRandomId);
+  asymm::PublicKey public_key;
+  public_key_cache.Add(node_id, keys.public_key);
+  EXPECT_TRUE(public_key_cache.Get(node_id, public_key));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(1U, public_key_cache.entries_.size());
+  EXPECT_FALSE(public_key_cache.Get(node_id, public_key));
+  EXPECT_TRUE(public_key_cache.entries_.empty());
+}
+
+TEST(PublicKeyCacheTest, BEH_Bounded) {
+  const size_t kMaxSize(5);
+  PublicKeyCache public_key_cache(kMaxSize, std::chrono::minutes(10));
+  asymm::Keys keys(asymm::GenerateKeyPair());
+  std::vector<NodeId> node_ids;
+  for (size_t i(0); i != kMaxSize * 2; ++i) {
+    node_ids.push_back(NodeId(NodeId::kRandomId));
+    public_key_cache.Add(node_ids.back(), keys.public_key);
+    EXPECT_LE(public_key_cache.size(), kMaxSize);
+    // Ensure each entry has a distinct expiry time
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_EQ(kMaxSize, public_key_cache.size());
+  // The oldest entries should have been evicted first
+  for (size_t i(0); i != node_ids.size(); ++i)
+    EXPECT_EQ(i >= kMaxSize, public_key_cache.Contains(node_ids.at(i), keys.public_key));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,111 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/response_cache.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(ResponseCacheTest, BEH_Key) {
+  const std::string kDestination(RandomString(64)), kRequest(RandomString(100));
+  std::string key(ResponseCache::Key(1, kDestination, kRequest));
+  EXPECT_EQ(key, ResponseCache::Key(1, kDestination, kRequest));
+  EXPECT_NE(key, ResponseCache::Key(1, kDestination, RandomString(100)));
+  // Requests of another type, or to another destination, don't share responses
+  EXPECT_NE(key, ResponseCache::Key(2, kDestination, kRequest));
+  EXPECT_NE(key, ResponseCache::Key(1, RandomString(64), kRequest));
+  // Moving bytes between the destination and the contents changes the key
+  EXPECT_NE(ResponseCache::Key(1, "ab", "c"), ResponseCache::Key(1, "a", "bc"));
+}
+
+TEST(ResponseCacheTest, BEH_AddAndGet) {
+  ResponseCache response_cache(1024 * 1024);
+  std::string response(RandomString(1000)), cached_response;
+  std::string key(ResponseCache::Key(1, RandomString(64), RandomString(100)));
+  EXPECT_FALSE(response_cache.Get(key, cached_response));
+
+  response_cache.Add(key, response);
+  EXPECT_EQ(1U, response_cache.size());
+  EXPECT_EQ(key.size() + response.size(), response_cache.bytes());
+  EXPECT_TRUE(response_cache.Get(key, cached_response));
+  EXPECT_EQ(response, cached_response);
+
+  // Re-adding replaces the held response
+  std::string new_response(RandomString(10));
+  response_cache.Add(key, new_response);
+  EXPECT_EQ(1U, response_cache.size());
+  EXPECT_EQ(key.size() + new_response.size(), response_cache.bytes());
+  EXPECT_TRUE(response_cache.Get(key, cached_response));
+  EXPECT_EQ(new_response, cached_response);
+}
+
+TEST(ResponseCacheTest, BEH_Eviction) {
+  const size_t kEntryCount(10), kResponseSize(100);
+  const std::string kDestination(RandomString(64));
+  std::string first_key(ResponseCache::Key(1, kDestination, RandomString(10)));
+  const uint64_t kEntrySize(first_key.size() + kResponseSize);
+  ResponseCache response_cache(kEntrySize * kEntryCount);
+  std::vector<std::string> keys(1, first_key);
+  for (size_t i(1); i != kEntryCount; ++i)
+    keys.push_back(ResponseCache::Key(1, kDestination, RandomString(10)));
+  for (const auto& key : keys)
+    response_cache.Add(key, RandomString(kResponseSize));
+  EXPECT_EQ(kEntryCount, response_cache.size());
+  EXPECT_EQ(kEntrySize * kEntryCount, response_cache.bytes());
+
+  // Touch the first entry so the second becomes least recently used
+  std::string cached_response;
+  EXPECT_TRUE(response_cache.Get(keys.at(0), cached_response));
+  EXPECT_EQ(keys.at(0), response_cache.entries_.front().first);
+  std::string new_key(ResponseCache::Key(1, kDestination, RandomString(10)));
+  response_cache.Add(new_key, RandomString(kResponseSize));
+  EXPECT_EQ(kEntryCount, response_cache.size());
+  EXPECT_EQ(response_cache.index_.size(), response_cache.entries_.size());
+  EXPECT_LE(response_cache.bytes_, kEntrySize * kEntryCount);
+  EXPECT_TRUE(response_cache.Get(keys.at(0), cached_response));
+  EXPECT_FALSE(response_cache.Get(keys.at(1), cached_response));
+  EXPECT_TRUE(response_cache.Get(new_key, cached_response));
+
+  // A response larger than the whole budget is not held
+  response_cache.Add(ResponseCache::Key(1, kDestination, RandomString(10)),
+                     RandomString(kEntrySize * kEntryCount));
+  EXPECT_EQ(kEntryCount, response_cache.size());
+}
+
+TEST(ResponseCacheTest, BEH_Disabled) {
+  ResponseCache response_cache(0);
+  std::string key(ResponseCache::Key(1, RandomString(64), RandomString(10))), cached_response;
+  response_cache.Add(key, RandomString(10));
+  EXPECT_EQ(0U, response_cache.size());
+  EXPECT_FALSE(response_cache.Get(key, cached_response));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -67,6 +67,7 @@ typedef boost::asio::ip::udp::endpoint Endpoint;
 }  // unnamed namespace
 
 size_t GenericNode::next_node_id_(1);
+bool GenericNode::typed_message_api_(false);
 
 GenericNode::GenericNode(bool client_mode, bool has_symmetric_nat, bool non_mutating_client)
     : functors_(),
@@ -80,6 +81,7 @@ GenericNode::GenericNode(bool client_mode, bool has_symmetric_nat, bool non_muta
       has_symmetric_nat_(has_symmetric_nat),
       endpoint_(),
       messages_(),
+      message_received_observer_(),
       routing_(),
       health_mutex_(),
       health_(0) {
@@ -116,6 +118,7 @@ GenericNode::GenericNode(bool client_mode, const rudp::NatType& nat_type)
       has_symmetric_nat_(nat_type == rudp::NatType::kSymmetric),
       endpoint_(),
       messages_(),
+      message_received_observer_(),
       routing_(),
       health_mutex_(),
       health_(0) {
@@ -150,6 +153,7 @@ GenericNode::GenericNode(bool client_mode, const NodeInfoAndPrivateKey& node_inf
       has_symmetric_nat_(has_symmetric_nat),
       endpoint_(),
       messages_(),
+      message_received_observer_(),
       routing_(),
       health_mutex_(),
       health_(0) {
@@ -197,15 +201,28 @@ void GenericNode::InitialiseFunctors() {
     std::cout << "Node " << HexSubstr(node_info_plus_->node_info.node_id.string())
               << " got close node replaced " << std::endl;
   };  // NOLINT (Fraser)
-  functors_.message_and_caching.message_received = [this](
-      const std::string & message, const bool & cache_lookup, ReplyFunctor reply_functor) {
-    assert(!cache_lookup && "CacheLookup should be disabled for test");
-    static_cast<void>(cache_lookup);
-    LOG(kInfo) << id_ << " -- Received: message : " << message.substr(0, 10);
-    std::lock_guard<std::mutex> guard(mutex_);
-    messages_.push_back(message);
-    reply_functor(node_id().string() + ">::< response to >:<" + message);
-  };
+  if (typed_message_api_) {
+    auto& typed_functors(functors_.typed_message_and_caching);
+    typed_functors.single_to_single.message_received = [this](
+        const SingleToSingleMessage & message) { StoreMessage(message.contents); };
+    typed_functors.single_to_group.message_received = [this](
+        const SingleToGroupMessage & message) { StoreMessage(message.contents); };
+    typed_functors.group_to_single.message_received = [this](
+        const GroupToSingleMessage & message) { StoreMessage(message.contents); };
+    typed_functors.group_to_group.message_received = [this](
+        const GroupToGroupMessage & message) { StoreMessage(message.contents); };
+    typed_functors.single_to_group_relay.message_received = [this](
+        const SingleToGroupRelayMessage & message) { StoreMessage(message.contents); };
+  } else {
+    functors_.message_and_caching.message_received = [this](
+        const std::string & message, const bool & cache_lookup, ReplyFunctor reply_functor) {
+      assert(!cache_lookup && "CacheLookup should be disabled for test");
+      static_cast<void>(cache_lookup);
+      LOG(kInfo) << id_ << " -- Received: message : " << message.substr(0, 10);
+      StoreMessage(message);
+      reply_functor(node_id().string() + ">::< response to >:<" + message);
+    };
+  }
   functors_.network_status = [&](const int & health) { SetHealth(health); };  // NOLINT
   functors_.matrix_changed = [&](std::shared_ptr<routing::MatrixChange> /*matrix_change*/) {
 //     matrix_change_functor(node_info_plus_->node_info.node_id, matrix_change);
@@ -373,14 +390,14 @@ void GenericNode::PrintRoutingTable() {
              << (IsClient() ? " (Client)" : " (Vault) :")
              << "Routing table size: " << routing_->pimpl_->routing_table_.nodes_.size();
   {
-    std::lock_guard<std::mutex> lock(routing_->pimpl_->routing_table_.mutex_);
+    std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(routing_->pimpl_->routing_table_.mutex_));
     for (const auto& node_info : routing_->pimpl_->routing_table_.nodes_) {
       LOG(kInfo) << "\tNodeId : " << HexSubstr(node_info.node_id.string());
     }
   }
   LOG(kInfo) << "[" << HexSubstr(node_info_plus_->node_info.node_id.string())
              << "]'s Non-RoutingTable : ";
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->client_routing_table_.mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(routing_->pimpl_->client_routing_table_.mutex_));
   for (const auto& node_info : routing_->pimpl_->client_routing_table_.nodes_) {
     LOG(kInfo) << "\tNodeId : " << HexSubstr(node_info.node_id.string());
   }
@@ -388,7 +405,7 @@ void GenericNode::PrintRoutingTable() {
 
 std::vector<NodeId> GenericNode::ReturnRoutingTable() {
   std::vector<NodeId> routing_nodes;
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->routing_table_.mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(routing_->pimpl_->routing_table_.mutex_));
   for (const auto& node_info : routing_->pimpl_->routing_table_.nodes_)
     routing_nodes.push_back(node_info.node_id);
   return routing_nodes;
@@ -410,6 +427,20 @@ void GenericNode::ClearMessages() {
   messages_.clear();
 }
 
+void GenericNode::SetMessageReceivedObserver(
+    std::function<void(const std::string&)> message_received_observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  message_received_observer_ = message_received_observer;
+}
+
+void GenericNode::StoreMessage(const std::string& message) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (message_received_observer_)
+    message_received_observer_(message);
+  else
+    messages_.push_back(message);
+}
+
 asymm::PublicKey GenericNode::public_key() {
   std::lock_guard<std::mutex> lock(mutex_);
   return node_info_plus_->node_info.public_key;
@@ -426,9 +457,9 @@ void GenericNode::SetHealth(int health) {
 }
 
 void GenericNode::PostTaskToAsioService(std::function<void()> functor) {
-  std::lock_guard<std::mutex> lock(routing_->pimpl_->running_mutex_);
+  std::lock_guard<ProfiledMutex> lock(ROUTING_LOCK(routing_->pimpl_->running_mutex_));
   if (routing_->pimpl_->running_)
-    routing_->pimpl_->asio_service_.service().post(functor);
+    routing_->pimpl_->scheduler_->Post(functor);
 }
 
 rudp::NatType GenericNode::nat_type() { return routing_->pimpl_->network_.nat_type(); }
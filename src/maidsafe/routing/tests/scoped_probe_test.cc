@@ -0,0 +1,92 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/scoped_probe.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+void Inner() {
+  ROUTING_PROBE("ScopedProbeTest.Inner");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+void Outer() {
+  ROUTING_PROBE("ScopedProbeTest.Outer");
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  Inner();
+}
+
+// Returns the microseconds recorded for the stack ending in 'leaf', or -1 if it's not present.
+int64_t StackTime(const std::string& folded_stacks, const std::string& leaf) {
+  std::istringstream lines(folded_stacks);
+  std::string stack;
+  int64_t microseconds(0);
+  while (lines >> stack >> microseconds) {
+    if (stack.size() > leaf.size() &&
+        stack.compare(stack.size() - leaf.size(), leaf.size(), leaf) == 0)
+      return microseconds;
+  }
+  return -1;
+}
+
+}  // unnamed namespace
+
+TEST(ScopedProbeTest, BEH_FoldedStacks) {
+  ResetProbes();
+  std::thread([] { Outer(); }).join();
+  std::string exclusive(FoldedProbeStacks(ProbeTime::kExclusive));
+  std::string inclusive(FoldedProbeStacks(ProbeTime::kInclusive));
+#ifdef ROUTING_SCOPED_PROBES
+  const std::string kOuter(";ScopedProbeTest.Outer"), kInner(kOuter + ";ScopedProbeTest.Inner");
+  EXPECT_EQ(0U, exclusive.find("thread-"));
+  EXPECT_LE(20000, StackTime(exclusive, kInner));
+  EXPECT_LE(10000, StackTime(exclusive, kOuter));
+  EXPECT_LE(30000, StackTime(inclusive, kOuter));
+  EXPECT_EQ(StackTime(exclusive, kInner), StackTime(inclusive, kInner));
+  // Outer's own time excludes Inner's, allowing for each being truncated to whole microseconds.
+  EXPECT_LT(StackTime(exclusive, kOuter), StackTime(inclusive, kOuter));
+  EXPECT_NEAR(StackTime(inclusive, kOuter),
+              StackTime(exclusive, kOuter) + StackTime(inclusive, kInner), 1);
+
+  ResetProbes();
+  EXPECT_TRUE(FoldedProbeStacks().empty());
+#else
+  EXPECT_TRUE(exclusive.empty());
+  EXPECT_TRUE(inclusive.empty());
+  static_cast<void>(&StackTime);
+#endif
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
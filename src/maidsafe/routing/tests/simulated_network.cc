@@ -0,0 +1,537 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/tests/simulated_network.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+#include "boost/asio/ip/address_v4.hpp"
+
+#include "maidsafe/routing/message_handler.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/random.h"
+#include "maidsafe/routing/return_codes.h"
+#include "maidsafe/routing/routing.pb.h"
+#include "maidsafe/routing/routing_impl.h"
+#include "maidsafe/routing/routing_table.h"
+#include "maidsafe/routing/tests/virtual_scheduler.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+const uint32_t kFirstSimulatedAddress(0x0A000000);  // 10.0.0.0
+const uint16_t kSimulatedPort(5483);
+const size_t kGeneratedModulusCount(4);
+const uint64_t kFnvOffsetBasis(14695981039346656037ULL), kFnvPrime(1099511628211ULL);
+const char* const kTypeNames[] = {"Unknown", "Ping", "Connect", "FindNodes", "ConnectSuccess",
+                                  "ConnectSuccessAcknowledgement", "Remove", "ClosestNodesUpdate",
+                                  "GetGroup", "NodeLevel"};
+
+std::string TypeName(const protobuf::Message& message) {
+  std::string type_name(kTypeNames[0]);
+  if (message.type() == static_cast<int32_t>(MessageType::kNodeLevel))
+    type_name = kTypeNames[sizeof(kTypeNames) / sizeof(kTypeNames[0]) - 1];
+  else if (message.type() >= static_cast<int32_t>(MessageType::kPing) &&
+           message.type() <= static_cast<int32_t>(MessageType::kGetGroup))
+    type_name = kTypeNames[message.type()];
+  return message.request() ? type_name : type_name + "Response";
+}
+
+NodeId MakeNodeId(std::mt19937_64& engine) {
+  std::string id;
+  while (id.size() != NodeId::kSize) {
+    uint64_t random(engine());
+    for (size_t i(0); i != sizeof(random) && id.size() != NodeId::kSize; ++i, random >>= 8)
+      id.push_back(static_cast<char>(random & 0xff));
+  }
+  return NodeId(id);
+}
+
+boost::asio::ip::udp::endpoint SimulatedEndpoint(size_t index) {
+  return boost::asio::ip::udp::endpoint(
+      boost::asio::ip::address_v4(kFirstSimulatedAddress + static_cast<uint32_t>(index)),
+      kSimulatedPort);
+}
+
+// Test messages' data starts with their number, padded to message_size.
+std::string TestMessageData(size_t number, size_t message_size) {
+  std::string data(std::to_string(number));
+  data.resize(std::max(message_size, data.size()), ' ');
+  return data;
+}
+
+size_t TestMessageNumber(const std::string& data) {
+  return static_cast<size_t>(std::strtoull(data.c_str(), nullptr, 10));
+}
+
+void Digest(const std::string& bytes, uint64_t& digest) {
+  for (char byte : bytes) {
+    digest ^= static_cast<unsigned char>(byte);
+    digest *= kFnvPrime;
+  }
+}
+
+}  // unnamed namespace
+
+struct SimulatedNetwork::Node {
+  explicit Node(const NodeInfo& info_in)
+      : info(info_in),
+        endpoint(),
+        join_start(0),
+        live(false),
+        left(false),
+        closest_nodes_reached(false),
+        threshold_reached(false),
+        size_check_pending(false) {}
+  NodeInfo info;
+  boost::asio::ip::udp::endpoint endpoint;
+  VirtualClock::Duration join_start;
+  // Whether the node is in live_nodes_.
+  bool live;
+  // Set once the node has left, which may be before its routing is destroyed.
+  bool left;
+  bool closest_nodes_reached, threshold_reached;
+  bool size_check_pending;
+};
+
+const size_t SimulatedNetwork::kNoNode(std::numeric_limits<size_t>::max());
+
+SimulationParameters::SimulationParameters()
+    : seed(0),
+      node_count(1000),
+      join_interval(100),
+      min_latency(10),
+      max_latency(100),
+      loss_rate(0.0),
+      settle_time(120),
+      measure_time(60),
+      message_count(1000),
+      message_size(1024),
+      join_rate(0.0),
+      leave_rate(0.0),
+      convergence_check_interval(100),
+      bootstrap_contact_count(8) {}
+
+SimulatedTraffic::SimulatedTraffic() : messages(0), bytes(0) {}
+
+SimulationResults::SimulationResults()
+    : hops(),
+      messages_sent(0),
+      messages_delivered(0),
+      closest_nodes_reached(),
+      threshold_reached(),
+      joins(0),
+      leaves(0),
+      reconvergence(),
+      unconverged(0),
+      traffic(),
+      measured_traffic(),
+      traffic_digest(kFnvOffsetBasis),
+      simulated_time(0),
+      events(0) {}
+
+SimulatedNetwork::SimulatedNetwork(const SimulationParameters& parameters)
+    : kParameters_(parameters),
+      engine_(parameters.seed),
+      clock_(),
+      links_(clock_, engine_, parameters.min_latency, parameters.max_latency,
+             parameters.loss_rate),
+      nodes_(),
+      routings_(),
+      index_of_(),
+      live_nodes_(),
+      members_(),
+      unconverged_events_(),
+      test_message_hops_(),
+      test_message_delivered_(),
+      measure_start_(VirtualClock::Duration::max()),
+      closest_nodes_reached_(),
+      threshold_reached_(),
+      reconvergence_(),
+      results_() {
+  assert(kParameters_.node_count > 1);
+  assert(kParameters_.convergence_check_interval.count() > 0);
+  assert(kParameters_.bootstrap_contact_count > 0);
+  links_.set_send_observer([this](const NodeId& /*sender_id*/, const NodeId& receiver_id,
+                                  const std::string& message) { Record(receiver_id, message); });
+}
+
+// The nodes are destroyed before the clock and links, as routings_ is declared after them.  Any
+// Timer tasks are cancelled, and their handlers run, first (see DestroyRouting).  The events the
+// nodes' destruction schedules are never run.
+SimulatedNetwork::~SimulatedNetwork() {
+  bool cancelled(false);
+  for (auto& routing : routings_) {
+    if (routing && routing->timer_.task_count() != 0) {
+      routing->timer_.CancelAllTasks();
+      cancelled = true;
+    }
+  }
+  if (cancelled)
+    clock_.RunUntil(clock_.Now());
+}
+
+SimulationResults SimulatedNetwork::Run() {
+  assert(nodes_.empty() && "Run is only to be called once");
+  typedef VirtualClock::Duration::rep Rep;
+  const VirtualClock::Duration kJoinInterval(kParameters_.join_interval);
+  const VirtualClock::Duration kMeasureTime(kParameters_.measure_time);
+  const VirtualClock::Duration kMeasureStart(
+      kJoinInterval * static_cast<Rep>(kParameters_.node_count - 1) + kParameters_.settle_time);
+  const VirtualClock::Duration kMeasureEnd(kMeasureStart + kMeasureTime);
+  const VirtualClock::Duration kCheckInterval(kParameters_.convergence_check_interval);
+  measure_start_ = kMeasureStart;
+  SeedRandom(kParameters_.seed);
+
+  for (size_t i(0); i != kParameters_.node_count; ++i) {
+    size_t index(AddSimulatedNode());
+    clock_.Schedule(kJoinInterval * static_cast<Rep>(i), [this, index] { StartJoin(index); });
+  }
+  for (size_t i(0); i != kParameters_.message_count; ++i) {
+    clock_.Schedule(kMeasureStart + kMeasureTime * static_cast<Rep>(i) /
+                                        static_cast<Rep>(kParameters_.message_count),
+                    [this] { SendTestMessage(); });
+  }
+  auto schedule_at_rate([&](double rate, const std::function<void()>& event) {
+    if (rate <= 0.0)
+      return;
+    const VirtualClock::Duration kInterval(static_cast<Rep>(
+        static_cast<double>(VirtualClock::Duration(std::chrono::seconds(1)).count()) / rate));
+    for (auto time(kMeasureStart + kInterval); time < kMeasureEnd; time += kInterval)
+      clock_.Schedule(time, event);
+  });
+  schedule_at_rate(kParameters_.join_rate, [this] { Join(); });
+  schedule_at_rate(kParameters_.leave_rate, [this] { RandomLeave(); });
+  clock_.Schedule(kMeasureStart + kCheckInterval, [this] { CheckConvergence(); });
+
+  // Long enough for the last test message to be delivered or have run out of hops.
+  const VirtualClock::Duration kDrainTime(VirtualClock::Duration(kParameters_.max_latency) *
+                                          static_cast<Rep>(Parameters::hops_to_live));
+  results_.events = clock_.RunUntil(kMeasureEnd + kDrainTime);
+  const VirtualClock::Duration kConvergenceEnd(kMeasureEnd + kParameters_.settle_time);
+  while (!unconverged_events_.empty() && clock_.Now() < kConvergenceEnd)
+    results_.events += clock_.RunUntil(std::min(clock_.Now() + kCheckInterval, kConvergenceEnd));
+  results_.unconverged = unconverged_events_.size();
+  results_.reconvergence = reconvergence_.Buckets();
+  results_.closest_nodes_reached = closest_nodes_reached_.Buckets();
+  results_.threshold_reached = threshold_reached_.Buckets();
+  results_.simulated_time = std::chrono::duration_cast<std::chrono::milliseconds>(clock_.Now());
+  return results_;
+}
+
+size_t SimulatedNetwork::AddSimulatedNode() {
+  size_t index(nodes_.size());
+  NodeInfo info;
+  do {
+    info.node_id = MakeNodeId(engine_);
+  } while (index_of_.count(info.node_id) != 0);
+  info.connection_id = info.node_id;
+  info.public_key = SimulationKeys(index).public_key;
+  nodes_.emplace_back(new Node(info));
+  nodes_.back()->endpoint = SimulatedEndpoint(index);
+  routings_.emplace_back();
+  index_of_.insert(std::make_pair(info.node_id, index));
+  return index;
+}
+
+void SimulatedNetwork::StartJoin(size_t index) {
+  Node& node(*nodes_[index]);
+  node.join_start = clock_.Now();
+  ++results_.joins;
+  members_.push_back(index);
+  routings_[index].reset(new Routing::Impl(
+      false, node.info.node_id, SimulationKeys(index),
+      std::unique_ptr<Scheduler>(new VirtualScheduler(clock_)),
+      std::unique_ptr<Transport>(new SimulatedTransport(links_, node.info.node_id,
+                                                        node.endpoint))));
+  if (members_.size() == 1)  // The first node has nothing to join, so waits for the second.
+    return;
+  if (members_.size() == 2 && live_nodes_.empty()) {
+    // The first two nodes start the network as they would outside simulation.  ZeroStateJoin's
+    // sleeps, there to wait on rudp, return at once in virtual time.
+    const size_t kFirst(members_.front());
+    Node& first(*nodes_[kFirst]);
+    int result(routings_[kFirst]->ZeroStateJoin(MakeFunctors(kFirst), first.endpoint,
+                                                node.endpoint, node.info));
+    assert(result == kSuccess);
+    result = routings_[index]->ZeroStateJoin(MakeFunctors(index), node.endpoint, first.endpoint,
+                                             first.info);
+    assert(result == kSuccess);
+    static_cast<void>(result);
+    return;
+  }
+  routings_[index]->Join(MakeFunctors(index), BootstrapEndpoints(index));
+}
+
+Functors SimulatedNetwork::MakeFunctors(size_t index) {
+  Functors functors;
+  functors.message_and_caching.message_received =
+      [this](const std::string& message, bool /*cache_lookup*/, ReplyFunctor /*reply_functor*/) {
+        MessageReceived(message);
+      };
+  functors.network_status = [this, index](int /*network_status*/) {
+    // Called with the routing table locked, so its size is read by an event of its own.
+    Node& node(*nodes_[index]);
+    if (node.size_check_pending)
+      return;
+    node.size_check_pending = true;
+    clock_.Schedule(VirtualClock::Duration(0), [this, index] { CheckRoutingTableSize(index); });
+  };
+  functors.request_public_key = [this](NodeId node_id, GivePublicKeyFunctor give_key) {
+    // As a vault would fetch the key from the network, but without the lookup's traffic.
+    size_t peer(IndexOf(node_id));
+    if (peer == kNoNode)
+      return;
+    asymm::PublicKey public_key(nodes_[peer]->info.public_key);
+    clock_.Schedule(VirtualClock::Duration(0), [give_key, public_key] { give_key(public_key); });
+  };
+  return functors;
+}
+
+void SimulatedNetwork::CheckRoutingTableSize(size_t index) {
+  Node& node(*nodes_[index]);
+  node.size_check_pending = false;
+  if (!IsAlive(index))
+    return;
+  const RoutingTable& routing_table(routings_[index]->routing_table_);
+  size_t routing_table_size(routing_table.size());
+  if (routing_table_size == 0)
+    return;
+  if (!node.live) {
+    node.live = true;
+    live_nodes_.push_back(index);
+  }
+  VirtualClock::Duration join_time(clock_.Now() - node.join_start);
+  if (!node.closest_nodes_reached && routing_table_size >= Parameters::closest_nodes_size) {
+    node.closest_nodes_reached = true;
+    closest_nodes_reached_.Record(join_time);
+  }
+  if (!node.threshold_reached && routing_table_size >= routing_table.kThresholdSize()) {
+    node.threshold_reached = true;
+    threshold_reached_.Record(join_time);
+  }
+}
+
+void SimulatedNetwork::Leave(size_t index) {
+  Node& node(*nodes_[index]);
+  ++results_.leaves;
+  members_.erase(std::find(std::begin(members_), std::end(members_), index));
+  if (node.live) {
+    live_nodes_.erase(std::find(std::begin(live_nodes_), std::end(live_nodes_), index));
+    node.live = false;
+  }
+  node.left = true;
+  // Destroying the routing closes its transport, so its peers lose their connections to it as if
+  // its process had exited.
+  DestroyRouting(index);
+}
+
+// A Timer's destructor blocks until its tasks have finished, which in virtual time they never would
+// while it blocks.  So any tasks are cancelled first, and the routing destroyed by a later event,
+// once their cancellation handlers have run.
+void SimulatedNetwork::DestroyRouting(size_t index) {
+  Timer<std::string>& timer(routings_[index]->timer_);
+  if (timer.task_count() == 0) {
+    routings_[index].reset();
+    return;
+  }
+  timer.CancelAllTasks();
+  clock_.Schedule(VirtualClock::Duration(0), [this, index] { DestroyRouting(index); });
+}
+
+void SimulatedNetwork::Join() {
+  size_t index(AddSimulatedNode());
+  StartJoin(index);
+  unconverged_events_.emplace_back(nodes_[index]->info.node_id, clock_.Now());
+}
+
+void SimulatedNetwork::RandomLeave() {
+  size_t leaving(RandomLiveNode(kNoNode));
+  if (leaving == kNoNode)
+    return;
+  Leave(leaving);
+  unconverged_events_.emplace_back(nodes_[leaving]->info.node_id, clock_.Now());
+}
+
+std::vector<boost::asio::ip::udp::endpoint> SimulatedNetwork::BootstrapEndpoints(size_t exclude) {
+  std::vector<size_t> candidates(live_nodes_);
+  std::vector<boost::asio::ip::udp::endpoint> endpoints;
+  while (!candidates.empty() && endpoints.size() != kParameters_.bootstrap_contact_count) {
+    size_t chosen(std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(engine_));
+    if (candidates[chosen] != exclude)
+      endpoints.push_back(nodes_[candidates[chosen]]->endpoint);
+    candidates[chosen] = candidates.back();
+    candidates.pop_back();
+  }
+  return endpoints;
+}
+
+void SimulatedNetwork::SendTestMessage() {
+  size_t source(RandomLiveNode(kNoNode));
+  size_t destination(RandomLiveNode(source));
+  if (source == kNoNode || destination == kNoNode)
+    return;
+  ++results_.messages_sent;
+  std::string data(TestMessageData(test_message_hops_.size(), kParameters_.message_size));
+  test_message_hops_.push_back(0);
+  test_message_delivered_.push_back(false);
+  routings_[source]->SendDirect(nodes_[destination]->info.node_id, data, false, ResponseFunctor());
+}
+
+void SimulatedNetwork::MessageReceived(const std::string& message) {
+  size_t number(TestMessageNumber(message));
+  if (number >= test_message_delivered_.size() || test_message_delivered_[number])
+    return;
+  test_message_delivered_[number] = true;
+  ++results_.messages_delivered;
+  size_t hops(test_message_hops_[number]);
+  if (results_.hops.size() <= hops)
+    results_.hops.resize(hops + 1, 0);
+  ++results_.hops[hops];
+}
+
+void SimulatedNetwork::CheckConvergence() {
+  unconverged_events_.erase(
+      std::remove_if(std::begin(unconverged_events_), std::end(unconverged_events_),
+                     [this](const ChurnEvent& event) {
+                       for (size_t member : ClosestMembers(event.node_id,
+                                                           Parameters::closest_nodes_size,
+                                                           kNoNode)) {
+                         if (!HasCorrectCloseGroup(member))
+                           return false;
+                       }
+                       reconvergence_.Record(clock_.Now() - event.time);
+                       return true;
+                     }),
+      std::end(unconverged_events_));
+  clock_.Schedule(kParameters_.convergence_check_interval, [this] { CheckConvergence(); });
+}
+
+bool SimulatedNetwork::HasCorrectCloseGroup(size_t index) const {
+  const NodeId kNodeId(nodes_[index]->info.node_id);
+  std::vector<NodeId> expected;
+  for (size_t member : ClosestMembers(kNodeId, Parameters::closest_nodes_size, index))
+    expected.push_back(nodes_[member]->info.node_id);
+  std::vector<NodeId> actual(
+      routings_[index]->routing_table_.GetClosestNodes(kNodeId, Parameters::closest_nodes_size));
+  std::sort(std::begin(expected), std::end(expected));
+  std::sort(std::begin(actual), std::end(actual));
+  return expected == actual;
+}
+
+std::vector<size_t> SimulatedNetwork::ClosestMembers(const NodeId& target, size_t count,
+                                                     size_t exclude) const {
+  std::vector<size_t> closest;
+  closest.reserve(members_.size());
+  std::copy_if(std::begin(members_), std::end(members_), std::back_inserter(closest),
+               [exclude](size_t member) { return member != exclude; });
+  count = std::min(count, closest.size());
+  std::partial_sort(std::begin(closest), std::begin(closest) + count, std::end(closest),
+                    [&](size_t lhs, size_t rhs) {
+                      return NodeId::CloserToTarget(nodes_[lhs]->info.node_id,
+                                                    nodes_[rhs]->info.node_id, target);
+                    });
+  closest.resize(count);
+  return closest;
+}
+
+bool SimulatedNetwork::IsAlive(size_t index) const {
+  return index < routings_.size() && routings_[index] && !nodes_[index]->left;
+}
+
+size_t SimulatedNetwork::IndexOf(const NodeId& node_id) const {
+  auto itr(index_of_.find(node_id));
+  return itr == std::end(index_of_) ? kNoNode : itr->second;
+}
+
+size_t SimulatedNetwork::RandomLiveNode(size_t exclude) {
+  size_t candidate_count(live_nodes_.size());
+  bool excluded(std::find(std::begin(live_nodes_), std::end(live_nodes_), exclude) !=
+                std::end(live_nodes_));
+  if (candidate_count == (excluded ? 1U : 0U))
+    return kNoNode;
+  for (;;) {
+    size_t candidate(live_nodes_[std::uniform_int_distribution<size_t>(
+        0, candidate_count - 1)(engine_)]);
+    if (candidate != exclude)
+      return candidate;
+  }
+}
+
+void SimulatedNetwork::Record(const NodeId& receiver_id, const std::string& message) {
+  Digest(receiver_id.string(), results_.traffic_digest);
+  Digest(message, results_.traffic_digest);
+
+  protobuf::Message parsed;
+  bool valid(parsed.ParseFromString(message));
+  const std::string kTypeName(valid ? TypeName(parsed) : kTypeNames[0]);
+  const uint64_t kBytes(static_cast<uint64_t>(message.size()));
+  SimulatedTraffic& traffic(results_.traffic[kTypeName]);
+  ++traffic.messages;
+  traffic.bytes += kBytes;
+  if (clock_.Now() >= measure_start_) {
+    SimulatedTraffic& measured_traffic(results_.measured_traffic[kTypeName]);
+    ++measured_traffic.messages;
+    measured_traffic.bytes += kBytes;
+  }
+
+  // Each node a test message reaches decrements its hops_to_live before passing it on.
+  if (!valid || parsed.type() != static_cast<int32_t>(MessageType::kNodeLevel) ||
+      !parsed.request() || parsed.data_size() == 0 ||
+      parsed.destination_id() != receiver_id.string())
+    return;
+  size_t number(TestMessageNumber(parsed.data(0)));
+  int hops(Parameters::hops_to_live - parsed.hops_to_live() + 1);
+  if (number < test_message_hops_.size() && hops > 0)
+    test_message_hops_[number] = static_cast<size_t>(hops);
+}
+
+asymm::Keys SimulationKeys(size_t index) {
+  static std::vector<asymm::Keys> generated_keys;
+  static std::mutex mutex;
+  asymm::Keys keys;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (generated_keys.size() != kGeneratedModulusCount)
+      generated_keys.push_back(asymm::GenerateKeyPair());
+    keys = generated_keys[index % kGeneratedModulusCount];
+  }
+  // Any odd exponent greater than one gives a valid public key.
+  CryptoPP::lword exponent(65537 + 2 * (index / kGeneratedModulusCount));
+  keys.public_key.Initialize(keys.public_key.GetModulus(),
+                             CryptoPP::Integer(CryptoPP::Integer::POSITIVE, exponent));
+  return keys;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
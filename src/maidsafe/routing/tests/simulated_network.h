@@ -0,0 +1,203 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TESTS_SIMULATED_NETWORK_H_
+#define MAIDSAFE_ROUTING_TESTS_SIMULATED_NETWORK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/routing/api_config.h"
+#include "maidsafe/routing/routing_api.h"
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/simulated_transport.h"
+#include "maidsafe/routing/tests/virtual_clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+struct SimulationParameters {
+  SimulationParameters();
+  // Seeds every random choice the simulation makes: node IDs, bootstrap peers, churn, latencies
+  // and losses.
+  uint32_t seed;
+  size_t node_count;
+  // Time between successive nodes starting to join.
+  std::chrono::milliseconds join_interval;
+  // Each message's latency is drawn uniformly from [min_latency, max_latency].
+  std::chrono::milliseconds min_latency, max_latency;
+  // Probability of each attempt at sending a message being lost.  The transport retransmits, so a
+  // loss delays the message by twice max_latency.
+  double loss_rate;
+  // Time allowed after the last node starts joining before measuring starts.
+  std::chrono::seconds settle_time;
+  // Length of the measurement phase.  The test messages are sent between random nodes at evenly
+  // spaced times throughout it.
+  std::chrono::seconds measure_time;
+  size_t message_count, message_size;
+  // New nodes joining, and random live nodes leaving, per second of the measurement phase.
+  double join_rate, leave_rate;
+  // How often the close groups around each join or leave are checked for having reconverged.
+  std::chrono::milliseconds convergence_check_interval;
+  // Maximum number of live nodes' endpoints each joining node is given to bootstrap from.
+  size_t bootstrap_contact_count;
+};
+
+// Traffic of one message type, counting each hop as a separate transmission.
+struct SimulatedTraffic {
+  SimulatedTraffic();
+  uint64_t messages, bytes;
+};
+
+struct SimulationResults {
+  SimulationResults();
+  // Hops taken by the test messages which were delivered.
+  HopCounts hops;
+  uint64_t messages_sent, messages_delivered;
+  // Virtual time from a node starting to join until its routing table first held
+  // closest_nodes_size nodes, and routing_table_size_threshold nodes.  Nodes which never got there
+  // are not included.
+  LatencyBuckets closest_nodes_reached, threshold_reached;
+  uint64_t joins, leaves;
+  // Virtual time from each join or leave until the closest_nodes_size nodes nearest its ID (the
+  // joining node included) all held their correct close groups, those being their closest nodes of
+  // all which have started joining and not left.  Events which had not reconverged by settle_time
+  // after the measurement phase are counted in 'unconverged'.
+  LatencyBuckets reconvergence;
+  uint64_t unconverged;
+  // Keyed by message type as in Statistics::messages_by_type, with responses keyed separately as
+  // e.g. "FindNodesResponse", and validation data sent as connections are made keyed as what it
+  // parses as ("ConnectSuccess", or "Unknown").
+  std::map<std::string, SimulatedTraffic> traffic;
+  // As 'traffic', but only counting transmissions from the start of the measurement phase.
+  std::map<std::string, SimulatedTraffic> measured_traffic;
+  // FNV-1a hash of each transmission's receiver ID and contents, in order, by which runs may be
+  // compared byte for byte.
+  uint64_t traffic_digest;
+  // Virtual time simulated, and the number of events run to simulate it.
+  std::chrono::milliseconds simulated_time;
+  uint64_t events;
+};
+
+// Runs a whole network of real Routing::Impl nodes in one thread and in virtual time.  Each node
+// runs on a VirtualScheduler sharing one VirtualClock, and connects to its peers over a
+// SimulatedTransport, so the join, FindNodes, Connect, ClosestNodesUpdate and Remove exchanges and
+// the forwarding of messages are routing's own.  The first two nodes are started with
+// ZeroStateJoin, and the rest Join from random live nodes' endpoints.
+//
+// Every choice the simulation makes is drawn from the seeded engine, routing's own random numbers
+// are drawn from its engine reseeded from the same seed (see SeedRandom), events run in a fixed
+// order, and routing takes the time and sleeps from its scheduler, so a run is repeatable byte for
+// byte.  Only one simulation may run at a time in a process, as routing's engine is process-wide.
+class SimulatedNetwork {
+ public:
+  explicit SimulatedNetwork(const SimulationParameters& parameters);
+  ~SimulatedNetwork();
+  // Joins node_count nodes, lets the network settle, then sends the test messages under churn.
+  // Only to be called once.
+  SimulationResults Run();
+
+ private:
+  struct Node;
+  // A join or leave whose surrounding close groups haven't yet reconverged.
+  struct ChurnEvent {
+    ChurnEvent(const NodeId& node_id_in, const VirtualClock::Duration& time_in)
+        : node_id(node_id_in), time(time_in) {}
+    NodeId node_id;
+    VirtualClock::Duration time;
+  };
+
+  static const size_t kNoNode;
+
+  SimulatedNetwork(const SimulatedNetwork&);
+  SimulatedNetwork(const SimulatedNetwork&&);
+  SimulatedNetwork& operator=(const SimulatedNetwork&);
+
+  // Node lifecycle
+  size_t AddSimulatedNode();
+  void StartJoin(size_t index);
+  Functors MakeFunctors(size_t index);
+  void CheckRoutingTableSize(size_t index);
+  void Leave(size_t index);
+  void DestroyRouting(size_t index);
+  void Join();
+  void RandomLeave();
+  std::vector<boost::asio::ip::udp::endpoint> BootstrapEndpoints(size_t exclude);
+
+  // Test messages
+  void SendTestMessage();
+  void MessageReceived(const std::string& message);
+
+  // Reconvergence, checked against members_
+  void CheckConvergence();
+  bool HasCorrectCloseGroup(size_t index) const;
+  std::vector<size_t> ClosestMembers(const NodeId& target, size_t count, size_t exclude) const;
+
+  bool IsAlive(size_t index) const;
+  size_t IndexOf(const NodeId& node_id) const;
+  size_t RandomLiveNode(size_t exclude);
+  void Record(const NodeId& receiver_id, const std::string& message);
+
+  const SimulationParameters kParameters_;
+  std::mt19937_64 engine_;
+  VirtualClock clock_;
+  SimulatedLinks links_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+  // Indexed as nodes_, each reset once its node has left.  Declared after clock_ and links_, so
+  // that the nodes are destroyed while their transports' links and clock remain.
+  std::vector<std::unique_ptr<Routing::Impl>> routings_;
+  std::map<NodeId, size_t> index_of_;
+  // Nodes with at least one peer in their routing tables (or the first node), in the order they got
+  // there, from which bootstrap peers and test message endpoints are chosen.
+  std::vector<size_t> live_nodes_;
+  // Nodes which have started joining and not left.
+  std::vector<size_t> members_;
+  std::vector<ChurnEvent> unconverged_events_;
+  // For each test message, the hops taken by its last transmission to its destination.
+  std::vector<size_t> test_message_hops_;
+  std::vector<bool> test_message_delivered_;
+  VirtualClock::Duration measure_start_;
+  LatencyHistogram closest_nodes_reached_, threshold_reached_, reconvergence_;
+  SimulationResults results_;
+};
+
+// Returns distinct, valid keys for each index.  Generating an RSA key pair per simulated node would
+// dominate a large simulation, and as nothing is signed or encrypted, only the public keys need to
+// differ: the nodes share a few generated moduli and are given distinct public exponents.
+asymm::Keys SimulationKeys(size_t index);
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TESTS_SIMULATED_NETWORK_H_
@@ -0,0 +1,127 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/simulated_network.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+SimulationParameters SmallNetwork(uint32_t seed) {
+  SimulationParameters parameters;
+  parameters.seed = seed;
+  parameters.node_count = 16;
+  parameters.settle_time = std::chrono::seconds(30);
+  parameters.measure_time = std::chrono::seconds(10);
+  parameters.message_count = 100;
+  return parameters;
+}
+
+uint64_t Total(const LatencyBuckets& buckets) {
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  return total;
+}
+
+}  // unnamed namespace
+
+TEST(SimulatedNetworkTest, BEH_SmallNetwork) {
+  SimulationParameters parameters(SmallNetwork(1));
+  SimulationResults results(SimulatedNetwork(parameters).Run());
+  EXPECT_EQ(parameters.node_count, results.joins);
+  EXPECT_EQ(0U, results.leaves);
+  // Every node is close to every other in a network this small.
+  EXPECT_EQ(parameters.node_count, Total(results.closest_nodes_reached));
+  EXPECT_EQ(0U, Total(results.threshold_reached));
+  EXPECT_EQ(parameters.message_count, results.messages_sent);
+  EXPECT_EQ(results.messages_sent, results.messages_delivered);
+  EXPECT_GE(MeanHops(results.hops), 1.0);
+  EXPECT_GT(results.events, 0U);
+  EXPECT_GE(results.simulated_time, parameters.settle_time + parameters.measure_time);
+  EXPECT_NE(0U, results.traffic["FindNodes"].messages);
+  EXPECT_NE(0U, results.traffic["Connect"].bytes);
+  // Validation data, sent by the transport as each connection is made.
+  EXPECT_NE(0U, results.traffic["ConnectSuccess"].messages);
+  // A test message is sent on once per hop.
+  EXPECT_GE(results.traffic["NodeLevel"].messages, parameters.message_count);
+  EXPECT_EQ(results.traffic["NodeLevel"].messages,
+            results.measured_traffic["NodeLevel"].messages);
+  EXPECT_LT(results.measured_traffic["Connect"].messages, results.traffic["Connect"].messages);
+  EXPECT_TRUE(results.reconvergence.empty());
+  EXPECT_EQ(0U, results.unconverged);
+}
+
+TEST(SimulatedNetworkTest, BEH_Churn) {
+  SimulationParameters parameters(SmallNetwork(4));
+  parameters.measure_time = std::chrono::seconds(30);
+  parameters.join_rate = 0.2;
+  parameters.leave_rate = 0.1;
+  SimulationResults results(SimulatedNetwork(parameters).Run());
+  // Joins and leaves are evenly spaced through the measurement phase, the first one interval in.
+  EXPECT_EQ(parameters.node_count + 5, results.joins);
+  EXPECT_EQ(2U, results.leaves);
+  EXPECT_EQ(7U, Total(results.reconvergence) + results.unconverged);
+  EXPECT_EQ(0U, results.unconverged);
+  EXPECT_EQ(results.messages_sent, results.messages_delivered);
+  EXPECT_NE(0U, results.measured_traffic["ClosestNodesUpdate"].messages);
+}
+
+TEST(SimulatedNetworkTest, BEH_Repeatable) {
+  SimulationParameters parameters(SmallNetwork(2));
+  parameters.loss_rate = 0.01;
+  parameters.join_rate = 0.5;
+  parameters.leave_rate = 0.5;
+  SimulationResults results(SimulatedNetwork(parameters).Run());
+  SimulationResults repeated_results(SimulatedNetwork(parameters).Run());
+  EXPECT_EQ(results.joins, parameters.node_count + results.leaves);
+  EXPECT_NE(0U, results.leaves);
+
+  EXPECT_EQ(results.events, repeated_results.events);
+  EXPECT_EQ(results.messages_delivered, repeated_results.messages_delivered);
+  EXPECT_EQ(results.hops, repeated_results.hops);
+  EXPECT_EQ(results.closest_nodes_reached, repeated_results.closest_nodes_reached);
+  EXPECT_EQ(results.reconvergence, repeated_results.reconvergence);
+  EXPECT_EQ(results.leaves, repeated_results.leaves);
+  ASSERT_EQ(results.traffic.size(), repeated_results.traffic.size());
+  for (const auto& traffic : results.traffic) {
+    EXPECT_EQ(traffic.second.messages, repeated_results.traffic[traffic.first].messages);
+    EXPECT_EQ(traffic.second.bytes, repeated_results.traffic[traffic.first].bytes);
+  }
+  // Every transmission, including its message ID, is the same.
+  EXPECT_EQ(results.traffic_digest, repeated_results.traffic_digest);
+
+  parameters.seed = 3;
+  EXPECT_NE(results.events, SimulatedNetwork(parameters).Run().events);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,299 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/tests/simulated_transport.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "maidsafe/rudp/parameters.h"
+#include "maidsafe/rudp/return_codes.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+SimulatedLinks::SimulatedLinks(VirtualClock& clock, std::mt19937_64& engine,
+                               const std::chrono::milliseconds& min_latency,
+                               const std::chrono::milliseconds& max_latency, double loss_rate)
+    : clock_(clock),
+      engine_(engine),
+      kMinLatency_(min_latency),
+      kMaxLatency_(max_latency),
+      kLossRate_(loss_rate),
+      send_observer_(),
+      transports_(),
+      listening_(),
+      next_serial_(0) {
+  assert(kMinLatency_ <= kMaxLatency_);
+  assert(kLossRate_ >= 0.0 && kLossRate_ < 1.0);
+}
+
+VirtualClock::Duration SimulatedLinks::TransitTime() {
+  typedef VirtualClock::Duration::rep Rep;
+  VirtualClock::Duration transit_time(0);
+  while (kLossRate_ > 0.0 &&
+         std::uniform_real_distribution<double>(0.0, 1.0)(engine_) < kLossRate_)
+    transit_time += kMaxLatency_ * 2;
+  return transit_time + VirtualClock::Duration(std::uniform_int_distribution<Rep>(
+                            kMinLatency_.count(), kMaxLatency_.count())(engine_));
+}
+
+SimulatedTransport* SimulatedLinks::Find(const NodeId& node_id) const {
+  auto itr(transports_.find(node_id));
+  return itr == std::end(transports_) ? nullptr : itr->second;
+}
+
+SimulatedTransport::Connection::Connection()
+    : state(State::kConnecting), expiry(0), last_arrival(0), serial(0), validation_data() {}
+
+SimulatedTransport::SimulatedTransport(SimulatedLinks& links, const NodeId& node_id,
+                                       const boost::asio::ip::udp::endpoint& endpoint)
+    : links_(links),
+      kNodeId_(node_id),
+      kEndpoint_(endpoint),
+      message_received_functor_(),
+      connection_lost_functor_(),
+      connections_(),
+      closed_(false) {
+  bool inserted(links_.transports_.insert(std::make_pair(kNodeId_, this)).second);
+  inserted = links_.listening_.insert(std::make_pair(kEndpoint_, this)).second && inserted;
+  assert(inserted && "Node IDs and endpoints must be unique");
+  static_cast<void>(inserted);
+}
+
+SimulatedTransport::~SimulatedTransport() { Close(); }
+
+int SimulatedTransport::Bootstrap(
+    const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
+    const rudp::MessageReceivedFunctor& message_received_functor,
+    const rudp::ConnectionLostFunctor& connection_lost_functor, const NodeId& this_node_id,
+    std::shared_ptr<asymm::PrivateKey> /*private_key*/,
+    std::shared_ptr<asymm::PublicKey> /*public_key*/, NodeId& chosen_bootstrap_peer,
+    rudp::NatType& nat_type, const boost::asio::ip::udp::endpoint& /*local_endpoint*/) {
+  assert(this_node_id == kNodeId_);
+  static_cast<void>(this_node_id);
+  message_received_functor_ = message_received_functor;
+  connection_lost_functor_ = connection_lost_functor;
+  nat_type = rudp::NatType::kUnknown;
+  // Left zero if none is found, which NetworkUtils takes as failing to bootstrap.
+  chosen_bootstrap_peer = NodeId();
+  if (closed_)
+    return rudp::kSuccess;
+  for (const auto& endpoint : bootstrap_endpoints) {
+    auto itr(links_.listening_.find(endpoint));
+    if (itr == std::end(links_.listening_) || itr->second == this)
+      continue;
+    SimulatedTransport& peer(*itr->second);
+    Connection* connection(FindConnection(peer.kNodeId_));
+    if (connection == nullptr || !IsConnected(*connection))
+      Connect(peer, State::kBootstrap);
+    chosen_bootstrap_peer = peer.kNodeId_;
+    break;
+  }
+  return rudp::kSuccess;
+}
+
+int SimulatedTransport::GetAvailableEndpoint(const NodeId& peer_id,
+                                             const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                                             rudp::EndpointPair& this_endpoint_pair,
+                                             rudp::NatType& this_nat_type) {
+  this_endpoint_pair.local = this_endpoint_pair.external = kEndpoint_;
+  this_nat_type = rudp::NatType::kUnknown;
+  if (closed_)
+    return rudp::kInvalidConnection;
+  Connection* connection(FindConnection(peer_id));
+  if (connection == nullptr) {
+    Connection& attempt(connections_[peer_id]);
+    attempt.expiry = links_.clock_.Now() + VirtualClock::Duration(
+        rudp::Parameters::rendezvous_connect_timeout.total_microseconds());
+    return rudp::kSuccess;
+  }
+  switch (connection->state) {
+    case State::kBootstrap:
+      return rudp::kBootstrapConnectionAlreadyExists;
+    case State::kUnvalidated:
+      return rudp::kUnvalidatedConnectionAlreadyExists;
+    case State::kValid:
+      return rudp::kConnectionAlreadyExists;
+    default:
+      return rudp::kConnectAttemptAlreadyRunning;
+  }
+}
+
+int SimulatedTransport::Add(const NodeId& peer_id, const rudp::EndpointPair& /*peer_endpoint_pair*/,
+                            const std::string& validation_data) {
+  if (closed_)
+    return rudp::kInvalidConnection;
+  Connection* connection(FindConnection(peer_id));
+  if (connection != nullptr) {
+    if (connection->state == State::kBootstrap) {
+      connection->state = State::kUnvalidated;
+      Send(peer_id, std::string(validation_data), nullptr);
+      return rudp::kSuccess;
+    }
+    if (connection->state == State::kUnvalidated)
+      return rudp::kUnvalidatedConnectionAlreadyExists;
+    if (connection->state == State::kValid)
+      return rudp::kConnectionAlreadyExists;
+  }
+
+  Connection& attempt(connection == nullptr ? connections_[peer_id] : *connection);
+  attempt.state = State::kAdded;
+  attempt.expiry = links_.clock_.Now() + VirtualClock::Duration(
+      rudp::Parameters::rendezvous_connect_timeout.total_microseconds());
+  attempt.validation_data = validation_data;
+  SimulatedTransport* peer(links_.Find(peer_id));
+  Connection* reverse(peer == nullptr ? nullptr : peer->FindConnection(kNodeId_));
+  if (reverse == nullptr || reverse->state != State::kAdded)
+    return rudp::kSuccess;
+
+  // Both ends have now added each other, so the connection is made once the handshake crosses.
+  SimulatedLinks& links(links_);
+  const NodeId kNodeId(kNodeId_);
+  links_.clock_.Schedule(links_.TransitTime(), [&links, kNodeId, peer_id] {
+    SimulatedTransport* transport(links.Find(kNodeId));
+    SimulatedTransport* peer(links.Find(peer_id));
+    if (transport == nullptr || peer == nullptr)
+      return;
+    Connection* connection(transport->FindConnection(peer_id));
+    Connection* reverse(peer->FindConnection(kNodeId));
+    if (connection == nullptr || reverse == nullptr || connection->state != State::kAdded ||
+        reverse->state != State::kAdded)
+      return;
+    transport->Connect(*peer, State::kUnvalidated);
+    transport->Send(peer_id, std::move(connection->validation_data), nullptr);
+    peer->Send(kNodeId, std::move(reverse->validation_data), nullptr);
+  });
+  return rudp::kSuccess;
+}
+
+int SimulatedTransport::MarkConnectionAsValid(
+    const NodeId& peer_id, boost::asio::ip::udp::endpoint& /*new_bootstrap_endpoint*/) {
+  Connection* connection(closed_ ? nullptr : FindConnection(peer_id));
+  if (connection == nullptr || !IsConnected(*connection))
+    return rudp::kInvalidConnection;
+  connection->state = State::kValid;
+  return rudp::kSuccess;
+}
+
+void SimulatedTransport::Remove(const NodeId& peer_id) {
+  auto itr(connections_.find(peer_id));
+  if (itr == std::end(connections_))
+    return;
+  bool connected(IsConnected(itr->second));
+  uint64_t serial(itr->second.serial);
+  connections_.erase(itr);
+  if (connected)
+    Disconnect(peer_id, serial);
+}
+
+void SimulatedTransport::Send(const NodeId& peer_id, std::string&& message,
+                              const rudp::MessageSentFunctor& message_sent_functor) {
+  SimulatedLinks& links(links_);
+  const NodeId kNodeId(kNodeId_);
+  Connection* connection(closed_ ? nullptr : FindConnection(peer_id));
+  if (connection == nullptr || !IsConnected(*connection)) {
+    if (message_sent_functor) {
+      links_.clock_.Schedule(VirtualClock::Duration(0), [&links, kNodeId, message_sent_functor] {
+        if (links.Find(kNodeId) != nullptr)
+          message_sent_functor(rudp::kInvalidConnection);
+      });
+    }
+    return;
+  }
+
+  if (links_.send_observer_)
+    links_.send_observer_(kNodeId_, peer_id, message);
+  const VirtualClock::Duration kNow(links_.clock_.Now());
+  connection->last_arrival = std::max(kNow + links_.TransitTime(), connection->last_arrival);
+  uint64_t serial(connection->serial);
+  // Shared, as std::function needs a copyable functor and copying the message per event is wasted.
+  auto in_flight(std::make_shared<std::string>(std::move(message)));
+  links_.clock_.Schedule(connection->last_arrival - kNow, [&links, kNodeId, peer_id, serial,
+                                                           in_flight, message_sent_functor] {
+    SimulatedTransport* receiver(links.Find(peer_id));
+    bool delivered(receiver != nullptr && receiver->IsConnectedTo(kNodeId, serial));
+    if (delivered && receiver->message_received_functor_)
+      receiver->message_received_functor_(*in_flight);
+    if (message_sent_functor && links.Find(kNodeId) != nullptr)
+      message_sent_functor(delivered ? rudp::kSuccess : rudp::kInvalidConnection);
+  });
+}
+
+void SimulatedTransport::Close() {
+  if (closed_)
+    return;
+  closed_ = true;
+  links_.transports_.erase(kNodeId_);
+  links_.listening_.erase(kEndpoint_);
+  for (const auto& connection : connections_) {
+    if (IsConnected(connection.second))
+      Disconnect(connection.first, connection.second.serial);
+  }
+  connections_.clear();
+}
+
+SimulatedTransport::Connection* SimulatedTransport::FindConnection(const NodeId& peer_id) {
+  auto itr(connections_.find(peer_id));
+  if (itr == std::end(connections_))
+    return nullptr;
+  if (!IsConnected(itr->second) && itr->second.expiry <= links_.clock_.Now()) {
+    connections_.erase(itr);
+    return nullptr;
+  }
+  return &itr->second;
+}
+
+bool SimulatedTransport::IsConnectedTo(const NodeId& peer_id, uint64_t serial) const {
+  auto itr(connections_.find(peer_id));
+  return itr != std::end(connections_) && IsConnected(itr->second) && itr->second.serial == serial;
+}
+
+void SimulatedTransport::Connect(SimulatedTransport& peer, State state) {
+  const uint64_t kSerial(links_.next_serial_++);
+  const VirtualClock::Duration kNow(links_.clock_.Now());
+  for (auto end : {std::make_pair(this, peer.kNodeId_), std::make_pair(&peer, kNodeId_)}) {
+    Connection& connection(end.first->connections_[end.second]);
+    connection.state = state;
+    connection.last_arrival = kNow;
+    connection.serial = kSerial;
+  }
+}
+
+void SimulatedTransport::Disconnect(const NodeId& peer_id, uint64_t serial) {
+  SimulatedLinks& links(links_);
+  const NodeId kNodeId(kNodeId_);
+  links_.clock_.Schedule(links_.TransitTime(), [&links, kNodeId, peer_id, serial] {
+    SimulatedTransport* peer(links.Find(peer_id));
+    if (peer == nullptr || !peer->IsConnectedTo(kNodeId, serial))
+      return;
+    peer->connections_.erase(kNodeId);
+    if (peer->connection_lost_functor_)
+      peer->connection_lost_functor_(kNodeId);
+  });
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,159 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TESTS_SIMULATED_TRANSPORT_H_
+#define MAIDSAFE_ROUTING_TESTS_SIMULATED_TRANSPORT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/udp.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/rudp/managed_connections.h"
+
+#include "maidsafe/routing/transport.h"
+#include "maidsafe/routing/tests/virtual_clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class SimulatedTransport;
+
+// The network between SimulatedTransports: which are listening where, and how long a message takes
+// to cross it.  rudp is reliable, so a lost packet delays a message rather than losing it: each
+// loss adds a retransmission timeout of twice max_latency.
+class SimulatedLinks {
+ public:
+  // Called with each message as it is sent, including validation data.
+  typedef std::function<void(const NodeId& sender_id, const NodeId& receiver_id,
+                             const std::string& message)> SendObserver;
+
+  SimulatedLinks(VirtualClock& clock, std::mt19937_64& engine,
+                 const std::chrono::milliseconds& min_latency,
+                 const std::chrono::milliseconds& max_latency, double loss_rate);
+  void set_send_observer(const SendObserver& send_observer) { send_observer_ = send_observer; }
+
+  friend class SimulatedTransport;
+
+ private:
+  SimulatedLinks(const SimulatedLinks&);
+  SimulatedLinks(const SimulatedLinks&&);
+  SimulatedLinks& operator=(const SimulatedLinks&);
+
+  VirtualClock::Duration TransitTime();
+  // Returns null if no open transport has the ID.
+  SimulatedTransport* Find(const NodeId& node_id) const;
+
+  VirtualClock& clock_;
+  std::mt19937_64& engine_;
+  const VirtualClock::Duration kMinLatency_, kMaxLatency_;
+  const double kLossRate_;
+  SendObserver send_observer_;
+  std::map<NodeId, SimulatedTransport*> transports_;
+  std::map<boost::asio::ip::udp::endpoint, SimulatedTransport*> listening_;
+  // Shared by both ends of each connection made, so that messages sent over, and the loss of, an
+  // earlier connection between the same two peers are ignored.
+  uint64_t next_serial_;
+};
+
+// In-memory stand-in for rudp::ManagedConnections, listening on 'endpoint' from construction.  Both
+// ends of a connection are made once each has Added the other (or at once, for a bootstrap
+// connection), and each end's validation data is then sent to the other.  Every callback is run as
+// an event on the links' clock, never from within the call which caused it, and none is run once
+// the transport has closed.
+class SimulatedTransport : public Transport {
+ public:
+  SimulatedTransport(SimulatedLinks& links, const NodeId& node_id,
+                     const boost::asio::ip::udp::endpoint& endpoint);
+  virtual ~SimulatedTransport();
+  // Connects to the first listening endpoint which isn't this transport's own.
+  virtual int Bootstrap(const std::vector<boost::asio::ip::udp::endpoint>& bootstrap_endpoints,
+                        const rudp::MessageReceivedFunctor& message_received_functor,
+                        const rudp::ConnectionLostFunctor& connection_lost_functor,
+                        const NodeId& this_node_id, std::shared_ptr<asymm::PrivateKey> private_key,
+                        std::shared_ptr<asymm::PublicKey> public_key,
+                        NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                        const boost::asio::ip::udp::endpoint& local_endpoint);
+  virtual int GetAvailableEndpoint(const NodeId& peer_id,
+                                   const rudp::EndpointPair& peer_endpoint_pair,
+                                   rudp::EndpointPair& this_endpoint_pair,
+                                   rudp::NatType& this_nat_type);
+  virtual int Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                  const std::string& validation_data);
+  virtual int MarkConnectionAsValid(const NodeId& peer_id,
+                                    boost::asio::ip::udp::endpoint& new_bootstrap_endpoint);
+  // Only the peer is told the connection was lost.
+  virtual void Remove(const NodeId& peer_id);
+  virtual void Send(const NodeId& peer_id, std::string&& message,
+                    const rudp::MessageSentFunctor& message_sent_functor);
+  // Stops listening and drops every connection, as when the node's process exits.
+  void Close();
+
+ private:
+  enum class State { kConnecting, kAdded, kBootstrap, kUnvalidated, kValid };
+  struct Connection {
+    Connection();
+    State state;
+    // When a kConnecting or kAdded attempt is given up.
+    VirtualClock::Duration expiry;
+    // Messages over a connection arrive in the order they were sent.
+    VirtualClock::Duration last_arrival;
+    uint64_t serial;
+    std::string validation_data;
+  };
+
+  SimulatedTransport(const SimulatedTransport&);
+  SimulatedTransport(const SimulatedTransport&&);
+  SimulatedTransport& operator=(const SimulatedTransport&);
+
+  static bool IsConnected(const Connection& connection) {
+    return connection.state >= State::kBootstrap;
+  }
+  // Returns null if there is no connection or attempt running, giving up expired attempts.
+  Connection* FindConnection(const NodeId& peer_id);
+  bool IsConnectedTo(const NodeId& peer_id, uint64_t serial) const;
+  void Connect(SimulatedTransport& peer, State state);
+  void Disconnect(const NodeId& peer_id, uint64_t serial);
+
+  SimulatedLinks& links_;
+  const NodeId kNodeId_;
+  const boost::asio::ip::udp::endpoint kEndpoint_;
+  rudp::MessageReceivedFunctor message_received_functor_;
+  rudp::ConnectionLostFunctor connection_lost_functor_;
+  std::map<NodeId, Connection> connections_;
+  bool closed_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TESTS_SIMULATED_TRANSPORT_H_
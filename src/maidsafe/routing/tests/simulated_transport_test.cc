@@ -0,0 +1,190 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/asio/ip/address_v4.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/rudp/parameters.h"
+#include "maidsafe/rudp/return_codes.h"
+
+#include "maidsafe/routing/tests/simulated_transport.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+class SimulatedTransportTest : public testing::Test {
+ protected:
+  struct Peer {
+    explicit Peer(SimulatedTransportTest& test, uint32_t address)
+        : node_id(NodeId::kRandomId),
+          endpoint(boost::asio::ip::address_v4(address), 5483),
+          transport(test.links_, node_id, endpoint),
+          received(),
+          lost() {}
+    NodeId node_id;
+    boost::asio::ip::udp::endpoint endpoint;
+    SimulatedTransport transport;
+    std::vector<std::string> received;
+    std::vector<NodeId> lost;
+  };
+
+  SimulatedTransportTest()
+      : clock_(),
+        engine_(0),
+        links_(clock_, engine_, std::chrono::milliseconds(10), std::chrono::milliseconds(20), 0.0),
+        peer_a_(*this, 0x0A000001),
+        peer_b_(*this, 0x0A000002) {}
+
+  int Bootstrap(Peer& peer, const Peer& bootstrap_peer, NodeId& chosen_bootstrap_peer) {
+    rudp::NatType nat_type;
+    return peer.transport.Bootstrap(
+        std::vector<boost::asio::ip::udp::endpoint>(1, bootstrap_peer.endpoint),
+        [&peer](const std::string& message) { peer.received.push_back(message); },
+        [&peer](const NodeId& peer_id) { peer.lost.push_back(peer_id); }, peer.node_id, nullptr,
+        nullptr, chosen_bootstrap_peer, nat_type, peer.endpoint);
+  }
+
+  int GetAvailableEndpoint(Peer& peer, const Peer& other) {
+    rudp::EndpointPair this_endpoint_pair;
+    rudp::NatType nat_type;
+    int result(peer.transport.GetAvailableEndpoint(other.node_id, rudp::EndpointPair(),
+                                                   this_endpoint_pair, nat_type));
+    EXPECT_EQ(peer.endpoint, this_endpoint_pair.external);
+    return result;
+  }
+
+  void RunFor(const std::chrono::milliseconds& duration) {
+    clock_.RunUntil(clock_.Now() + duration);
+  }
+
+  VirtualClock clock_;
+  std::mt19937_64 engine_;
+  SimulatedLinks links_;
+  Peer peer_a_, peer_b_;
+};
+
+TEST_F(SimulatedTransportTest, BEH_BootstrapAndSend) {
+  NodeId chosen_bootstrap_peer;
+  EXPECT_EQ(rudp::kSuccess, Bootstrap(peer_a_, peer_b_, chosen_bootstrap_peer));
+  EXPECT_EQ(peer_b_.node_id, chosen_bootstrap_peer);
+  // Bootstrapping from only its own endpoint finds no peer
+  EXPECT_EQ(rudp::kSuccess, Bootstrap(peer_b_, peer_b_, chosen_bootstrap_peer));
+  EXPECT_TRUE(chosen_bootstrap_peer.IsZero());
+
+  std::vector<int> results;
+  for (int i(0); i != 3; ++i) {
+    peer_a_.transport.Send(peer_b_.node_id, std::to_string(i),
+                           [&](int result) { results.push_back(result); });
+  }
+  EXPECT_TRUE(peer_b_.received.empty());
+  RunFor(std::chrono::milliseconds(9));
+  EXPECT_TRUE(peer_b_.received.empty());
+  RunFor(std::chrono::milliseconds(20));
+  // In the order sent
+  EXPECT_EQ(std::vector<std::string>({"0", "1", "2"}), peer_b_.received);
+  EXPECT_EQ(std::vector<int>(3, rudp::kSuccess), results);
+
+  // Unconnected peers can't be sent to
+  Peer peer_c(*this, 0x0A000003);
+  peer_a_.transport.Send(peer_c.node_id, "3", [&](int result) { results.push_back(result); });
+  EXPECT_EQ(3U, results.size());
+  RunFor(std::chrono::milliseconds(30));
+  EXPECT_TRUE(peer_c.received.empty());
+  ASSERT_EQ(4U, results.size());
+  EXPECT_EQ(rudp::kInvalidConnection, results.back());
+}
+
+TEST_F(SimulatedTransportTest, BEH_AddAndValidate) {
+  NodeId chosen_bootstrap_peer;
+  Bootstrap(peer_a_, peer_b_, chosen_bootstrap_peer);
+  Bootstrap(peer_b_, peer_a_, chosen_bootstrap_peer);
+  Peer peer_c(*this, 0x0A000003);
+  Bootstrap(peer_c, peer_a_, chosen_bootstrap_peer);
+  EXPECT_EQ(rudp::kBootstrapConnectionAlreadyExists, GetAvailableEndpoint(peer_a_, peer_b_));
+
+  // A new connection is made once both ends have added each other
+  EXPECT_EQ(rudp::kSuccess, GetAvailableEndpoint(peer_b_, peer_c));
+  EXPECT_EQ(rudp::kConnectAttemptAlreadyRunning, GetAvailableEndpoint(peer_b_, peer_c));
+  EXPECT_EQ(rudp::kSuccess, peer_b_.transport.Add(peer_c.node_id, rudp::EndpointPair(), "b"));
+  RunFor(std::chrono::milliseconds(100));
+  EXPECT_TRUE(peer_c.received.empty());
+  EXPECT_EQ(rudp::kSuccess, GetAvailableEndpoint(peer_c, peer_b_));
+  EXPECT_EQ(rudp::kSuccess, peer_c.transport.Add(peer_b_.node_id, rudp::EndpointPair(), "c"));
+  RunFor(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::vector<std::string>(1, "b"), peer_c.received);
+  EXPECT_EQ(std::vector<std::string>(1, "c"), peer_b_.received);
+  EXPECT_EQ(rudp::kUnvalidatedConnectionAlreadyExists, GetAvailableEndpoint(peer_b_, peer_c));
+  boost::asio::ip::udp::endpoint new_bootstrap_endpoint;
+  EXPECT_EQ(rudp::kSuccess,
+            peer_b_.transport.MarkConnectionAsValid(peer_c.node_id, new_bootstrap_endpoint));
+  EXPECT_EQ(rudp::kConnectionAlreadyExists, GetAvailableEndpoint(peer_b_, peer_c));
+
+  // Adding a bootstrap connection sends the validation data at once
+  EXPECT_EQ(rudp::kSuccess, peer_a_.transport.Add(peer_c.node_id, rudp::EndpointPair(), "a"));
+  RunFor(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::vector<std::string>({"b", "a"}), peer_c.received);
+
+  // An attempt which the peer never adds is given up
+  Peer peer_d(*this, 0x0A000004);
+  EXPECT_EQ(rudp::kSuccess, GetAvailableEndpoint(peer_a_, peer_d));
+  EXPECT_EQ(rudp::kInvalidConnection,
+            peer_a_.transport.MarkConnectionAsValid(peer_d.node_id, new_bootstrap_endpoint));
+  clock_.RunUntil(clock_.Now() + VirtualClock::Duration(
+      rudp::Parameters::rendezvous_connect_timeout.total_microseconds()));
+  EXPECT_EQ(rudp::kSuccess, GetAvailableEndpoint(peer_a_, peer_d));
+}
+
+TEST_F(SimulatedTransportTest, BEH_RemoveAndClose) {
+  NodeId chosen_bootstrap_peer;
+  Bootstrap(peer_a_, peer_b_, chosen_bootstrap_peer);
+  Bootstrap(peer_b_, peer_a_, chosen_bootstrap_peer);
+  Peer peer_c(*this, 0x0A000003);
+  Bootstrap(peer_c, peer_a_, chosen_bootstrap_peer);
+
+  // Only the peer is told, after a transit time, and messages still in flight are lost
+  int send_result(rudp::kSuccess);
+  peer_b_.transport.Send(peer_a_.node_id, "b", [&](int result) { send_result = result; });
+  peer_a_.transport.Remove(peer_b_.node_id);
+  EXPECT_TRUE(peer_b_.lost.empty());
+  RunFor(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::vector<NodeId>(1, peer_a_.node_id), peer_b_.lost);
+  EXPECT_TRUE(peer_a_.lost.empty());
+  EXPECT_TRUE(peer_a_.received.empty());
+  EXPECT_EQ(rudp::kInvalidConnection, send_result);
+
+  // Closing drops every connection and stops listening
+  peer_a_.transport.Close();
+  RunFor(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::vector<NodeId>(1, peer_a_.node_id), peer_c.lost);
+  EXPECT_EQ(rudp::kSuccess, Bootstrap(peer_b_, peer_a_, chosen_bootstrap_peer));
+  EXPECT_TRUE(chosen_bootstrap_peer.IsZero());
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,100 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <cstdint>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/statistics.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(StatisticsTest, BEH_LatencyHistogram) {
+  LatencyHistogram histogram;
+  EXPECT_TRUE(histogram.Buckets().empty());
+  EXPECT_EQ(0, LatencyPercentile(histogram.Buckets(), 50).count());
+
+  // Small values are held exactly
+  for (int i(0); i != 16; ++i)
+    histogram.Record(std::chrono::microseconds(i));
+  LatencyBuckets buckets(histogram.Buckets());
+  ASSERT_EQ(16U, buckets.size());
+  for (int i(0); i != 16; ++i) {
+    EXPECT_EQ(i, buckets.at(i).first.count());
+    EXPECT_EQ(1U, buckets.at(i).second);
+  }
+
+  // Larger values are within 1/16 of their bucket's upper bound
+  for (int i(0); i != 1000; ++i) {
+    LatencyHistogram single_value_histogram;
+    int64_t value((RandomUint32() % 100000000) + 1);
+    single_value_histogram.Record(std::chrono::microseconds(value));
+    buckets = single_value_histogram.Buckets();
+    ASSERT_EQ(1U, buckets.size());
+    EXPECT_GE(buckets.front().first.count(), value);
+    EXPECT_LE(buckets.front().first.count() - value, value / 16);
+  }
+
+  // Negative durations are counted as zero
+  LatencyHistogram negative_histogram;
+  negative_histogram.Record(std::chrono::microseconds(-5));
+  ASSERT_EQ(1U, negative_histogram.Buckets().size());
+  EXPECT_EQ(0, negative_histogram.Buckets().front().first.count());
+}
+
+TEST(StatisticsTest, BEH_LatencyPercentile) {
+  LatencyHistogram histogram;
+  for (int i(1); i <= 100; ++i)
+    histogram.Record(std::chrono::milliseconds(i));
+  LatencyBuckets buckets(histogram.Buckets());
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  EXPECT_EQ(100U, total);
+  for (int percentile(1); percentile <= 100; ++percentile) {
+    auto expected(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::milliseconds(percentile)).count());
+    auto actual(LatencyPercentile(buckets, percentile).count());
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual - expected, expected / 16);
+  }
+}
+
+TEST(StatisticsTest, BEH_MeanHops) {
+  EXPECT_EQ(0.0, MeanHops(HopCounts()));
+  EXPECT_EQ(0.0, MeanHops(HopCounts(5, 0)));
+  HopCounts hop_counts(5, 0);
+  hop_counts[2] = 3;
+  EXPECT_DOUBLE_EQ(2.0, MeanHops(hop_counts));
+  hop_counts[4] = 1;
+  EXPECT_DOUBLE_EQ(2.5, MeanHops(hop_counts));
+  hop_counts[0] = 4;
+  EXPECT_DOUBLE_EQ(1.25, MeanHops(hop_counts));
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
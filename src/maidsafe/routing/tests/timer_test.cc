@@ -243,6 +243,20 @@ TEST_F(TimerTest, BEH_CancelTask) {
   EXPECT_EQ(failed_response_count_, kGroupSize_ - 1);
 }
 
+TEST_F(TimerTest, BEH_CancelAllTasks) {
+  auto task_id(timer_.NewTaskId());
+  timer_.AddTask(std::chrono::seconds(10), variable_response_functor_, kGroupSize_, task_id);
+  timer_.AddResponse(task_id, message_);
+  timer_.AddTask(std::chrono::seconds(10), failed_response_functor_, 1, timer_.NewTaskId());
+  timer_.CancelAllTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  EXPECT_TRUE(cond_var_.wait_for(lock, std::chrono::milliseconds(200), [&] {
+    return pass_response_count_ + failed_response_count_ == kGroupSize_ + 1;
+  }));
+  EXPECT_EQ(pass_response_count_, 1);
+  EXPECT_EQ(failed_response_count_, kGroupSize_);
+}
+
 struct MessageDetails {
   MessageDetails()
       : message(RandomAlphaNumericString(30)),
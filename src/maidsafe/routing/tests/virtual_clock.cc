@@ -0,0 +1,63 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/tests/virtual_clock.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+VirtualClock::Event::Event(const Duration& time_in, uint64_t sequence_in,
+                           std::function<void()> function_in)
+    : time(time_in), sequence(sequence_in), function(std::move(function_in)) {}
+
+VirtualClock::VirtualClock() : now_(0), next_sequence_(0), events_() {}
+
+void VirtualClock::Schedule(const Duration& delay, std::function<void()> event) {
+  events_.emplace_back(now_ + std::max(delay, Duration(0)), next_sequence_++, std::move(event));
+  std::push_heap(std::begin(events_), std::end(events_), &VirtualClock::Later);
+}
+
+uint64_t VirtualClock::RunUntil(const Duration& until) {
+  uint64_t run_count(0);
+  while (!events_.empty() && events_.front().time <= until) {
+    std::pop_heap(std::begin(events_), std::end(events_), &VirtualClock::Later);
+    Event event(std::move(events_.back()));
+    events_.pop_back();
+    now_ = event.time;
+    event.function();
+    ++run_count;
+  }
+  now_ = std::max(now_, until);
+  return run_count;
+}
+
+bool VirtualClock::Later(const Event& lhs, const Event& rhs) {
+  return lhs.time != rhs.time ? lhs.time > rhs.time : lhs.sequence > rhs.sequence;
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -0,0 +1,75 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TESTS_VIRTUAL_CLOCK_H_
+#define MAIDSAFE_ROUTING_TESTS_VIRTUAL_CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Single-threaded discrete-event scheduler.  Time only advances as events are run, and events due
+// at the same time run in the order they were scheduled, so a simulation driven by this and a
+// seeded random engine is repeatable.
+class VirtualClock {
+ public:
+  typedef std::chrono::microseconds Duration;
+
+  VirtualClock();
+  // Time elapsed since the clock was created.
+  Duration Now() const { return now_; }
+  void Schedule(const Duration& delay, std::function<void()> event);
+  // Runs events due at or before 'until', including any they schedule, then advances the clock to
+  // 'until'.  Returns the number of events run.
+  uint64_t RunUntil(const Duration& until);
+  size_t pending_count() const { return events_.size(); }
+
+ private:
+  struct Event {
+    Event(const Duration& time_in, uint64_t sequence_in, std::function<void()> function_in);
+    Duration time;
+    uint64_t sequence;
+    std::function<void()> function;
+  };
+
+  VirtualClock(const VirtualClock&);
+  VirtualClock(const VirtualClock&&);
+  VirtualClock& operator=(const VirtualClock&);
+
+  static bool Later(const Event& lhs, const Event& rhs);
+
+  Duration now_;
+  uint64_t next_sequence_;
+  // A heap ordered by Later, so the next event due is at the front.
+  std::vector<Event> events_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TESTS_VIRTUAL_CLOCK_H_
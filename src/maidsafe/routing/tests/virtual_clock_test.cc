@@ -0,0 +1,90 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/tests/virtual_clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(VirtualClockTest, BEH_RunsEventsInTimeOrder) {
+  VirtualClock clock;
+  std::vector<int> order;
+  std::vector<VirtualClock::Duration> run_at;
+  auto record([&](int event) {
+    order.push_back(event);
+    run_at.push_back(clock.Now());
+  });
+  clock.Schedule(std::chrono::milliseconds(30), [&] { record(3); });
+  clock.Schedule(std::chrono::milliseconds(10), [&] { record(1); });
+  clock.Schedule(std::chrono::milliseconds(20), [&] { record(2); });
+  // Events due at the same time run in the order they were scheduled
+  clock.Schedule(std::chrono::milliseconds(20), [&] { record(4); });
+  EXPECT_EQ(4U, clock.pending_count());
+
+  EXPECT_EQ(4U, clock.RunUntil(std::chrono::milliseconds(30)));
+  EXPECT_EQ(std::vector<int>({1, 2, 4, 3}), order);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(10)), run_at[0]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(20)), run_at[1]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(20)), run_at[2]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(30)), run_at[3]);
+  EXPECT_EQ(0U, clock.pending_count());
+}
+
+TEST(VirtualClockTest, BEH_RunUntil) {
+  VirtualClock clock;
+  int run_count(0);
+  // Each event schedules the next, relative to the time it runs
+  std::function<void()> repeat([&] {
+    ++run_count;
+    clock.Schedule(std::chrono::seconds(1), repeat);
+  });
+  clock.Schedule(std::chrono::seconds(1), repeat);
+
+  EXPECT_EQ(0U, clock.RunUntil(std::chrono::milliseconds(500)));
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(500)), clock.Now());
+  EXPECT_EQ(3U, clock.RunUntil(std::chrono::seconds(3)));
+  EXPECT_EQ(3, run_count);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::seconds(3)), clock.Now());
+  EXPECT_EQ(1U, clock.pending_count());
+
+  // A zero delay runs after the events already due now
+  std::vector<int> order;
+  clock.Schedule(VirtualClock::Duration(0), [&] {
+    order.push_back(1);
+    clock.Schedule(VirtualClock::Duration(0), [&] { order.push_back(3); });
+  });
+  clock.Schedule(VirtualClock::Duration(0), [&] { order.push_back(2); });
+  EXPECT_EQ(3U, clock.RunUntil(clock.Now()));
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), order);
+  EXPECT_EQ(3, run_count);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
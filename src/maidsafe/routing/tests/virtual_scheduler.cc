@@ -0,0 +1,127 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/tests/virtual_scheduler.h"
+
+#include <vector>
+
+#include "boost/asio/error.hpp"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+namespace {
+
+class VirtualAlarm : public Scheduler::Alarm {
+ public:
+  explicit VirtualAlarm(VirtualScheduler& scheduler) : scheduler_(scheduler), state_(new State) {}
+  virtual ~VirtualAlarm() { Cancel(); }
+
+  virtual void ExpiresFromNow(const std::chrono::steady_clock::duration& duration) {
+    Cancel();
+    state_->expiry = std::chrono::duration_cast<VirtualClock::Duration>(
+                         scheduler_.Now().time_since_epoch() + duration);
+  }
+
+  virtual void AsyncWait(const Scheduler::WaitHandler& handler) {
+    state_->handlers.push_back(handler);
+    std::shared_ptr<State> state(state_);
+    uint64_t generation(state_->generation);
+    scheduler_.Schedule(
+        state_->expiry - std::chrono::duration_cast<VirtualClock::Duration>(
+                             scheduler_.Now().time_since_epoch()),
+        [state, generation] {
+          if (state->generation != generation)
+            return;
+          ++state->generation;
+          std::vector<Scheduler::WaitHandler> handlers;
+          handlers.swap(state->handlers);
+          for (const auto& handler : handlers)
+            handler(boost::system::error_code());
+        });
+  }
+
+  virtual void Cancel() {
+    // Expiry events scheduled before now no longer match, so won't run the handlers again.
+    ++state_->generation;
+    std::vector<Scheduler::WaitHandler> handlers;
+    handlers.swap(state_->handlers);
+    for (const auto& handler : handlers) {
+      scheduler_.Post([handler] {
+        handler(boost::system::error_code(boost::asio::error::operation_aborted));
+      });
+    }
+  }
+
+ private:
+  struct State {
+    State() : expiry(0), generation(0), handlers() {}
+    VirtualClock::Duration expiry;
+    uint64_t generation;
+    std::vector<Scheduler::WaitHandler> handlers;
+  };
+
+  VirtualAlarm(const VirtualAlarm&);
+  VirtualAlarm(const VirtualAlarm&&);
+  VirtualAlarm& operator=(const VirtualAlarm&);
+
+  VirtualScheduler& scheduler_;
+  std::shared_ptr<State> state_;
+};
+
+}  // unnamed namespace
+
+VirtualScheduler::VirtualScheduler(VirtualClock& clock)
+    : clock_(clock), alive_(std::make_shared<bool>(true)) {}
+
+VirtualScheduler::~VirtualScheduler() { *alive_ = false; }
+
+std::chrono::steady_clock::time_point VirtualScheduler::Now() const {
+  return std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(clock_.Now()));
+}
+
+void VirtualScheduler::Post(const std::function<void()>& functor) {
+  Schedule(VirtualClock::Duration(0), functor);
+}
+
+void VirtualScheduler::Dispatch(const std::function<void()>& functor) { Post(functor); }
+
+std::unique_ptr<Scheduler::Alarm> VirtualScheduler::MakeAlarm() {
+  return std::unique_ptr<Alarm>(new VirtualAlarm(*this));
+}
+
+void VirtualScheduler::Sleep(const std::chrono::steady_clock::duration& /*duration*/) {}
+
+void VirtualScheduler::Schedule(const VirtualClock::Duration& delay,
+                                const std::function<void()>& functor) {
+  std::shared_ptr<bool> alive(alive_);
+  clock_.Schedule(delay, [alive, functor] {
+    if (*alive)
+      functor();
+  });
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
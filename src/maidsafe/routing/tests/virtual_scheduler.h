@@ -0,0 +1,68 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_ROUTING_TESTS_VIRTUAL_SCHEDULER_H_
+#define MAIDSAFE_ROUTING_TESTS_VIRTUAL_SCHEDULER_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "maidsafe/routing/scheduler.h"
+#include "maidsafe/routing/tests/virtual_clock.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+// Runs one node's handlers and timers as events on a VirtualClock, which may be shared by all the
+// nodes of a simulation, and takes the time from it.  Events still pending when the scheduler is
+// destroyed are dropped, so it must outlive any alarms it made.
+class VirtualScheduler : public Scheduler {
+ public:
+  explicit VirtualScheduler(VirtualClock& clock);
+  virtual ~VirtualScheduler();
+  virtual std::chrono::steady_clock::time_point Now() const;
+  virtual void Post(const std::function<void()>& functor);
+  // There is no running "within" a virtual scheduler, so this always posts.
+  virtual void Dispatch(const std::function<void()>& functor);
+  virtual std::unique_ptr<Alarm> MakeAlarm();
+  // Virtual time only passes between events, so this returns at once.
+  virtual void Sleep(const std::chrono::steady_clock::duration& duration);
+  // Runs 'functor' after 'delay', unless this has been destroyed by then.
+  void Schedule(const VirtualClock::Duration& delay, const std::function<void()>& functor);
+
+ private:
+  VirtualScheduler(const VirtualScheduler&);
+  VirtualScheduler(const VirtualScheduler&&);
+  VirtualScheduler& operator=(const VirtualScheduler&);
+
+  VirtualClock& clock_;
+  // Shared with each event scheduled, which is dropped once this is false.
+  std::shared_ptr<bool> alive_;
+};
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_ROUTING_TESTS_VIRTUAL_SCHEDULER_H_
@@ -0,0 +1,118 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "boost/asio/error.hpp"
+
+#include "maidsafe/common/test.h"
+
+#include "maidsafe/routing/tests/virtual_scheduler.h"
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace test {
+
+TEST(VirtualSchedulerTest, BEH_PostAndNow) {
+  VirtualClock clock;
+  VirtualScheduler scheduler(clock);
+  std::vector<int> order;
+  scheduler.Post([&] { order.push_back(1); });
+  scheduler.Dispatch([&] { order.push_back(2); });
+  // Neither runs from within the call
+  EXPECT_TRUE(order.empty());
+  EXPECT_EQ(2U, clock.RunUntil(clock.Now()));
+  EXPECT_EQ(std::vector<int>({1, 2}), order);
+
+  clock.RunUntil(std::chrono::seconds(2));
+  EXPECT_EQ(std::chrono::steady_clock::duration(std::chrono::seconds(2)),
+            scheduler.Now().time_since_epoch());
+}
+
+TEST(VirtualSchedulerTest, BEH_Alarm) {
+  VirtualClock clock;
+  VirtualScheduler scheduler(clock);
+  std::unique_ptr<Scheduler::Alarm> alarm(scheduler.MakeAlarm());
+  std::vector<boost::system::error_code> results;
+  std::vector<VirtualClock::Duration> run_at;
+  auto handler([&](const boost::system::error_code& error_code) {
+    results.push_back(error_code);
+    run_at.push_back(clock.Now());
+  });
+
+  alarm->ExpiresFromNow(std::chrono::milliseconds(100));
+  alarm->AsyncWait(handler);
+  clock.RunUntil(std::chrono::milliseconds(99));
+  EXPECT_TRUE(results.empty());
+  clock.RunUntil(std::chrono::milliseconds(100));
+  ASSERT_EQ(1U, results.size());
+  EXPECT_FALSE(results[0]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(100)), run_at[0]);
+
+  // Re-arming aborts the pending wait, but not from within the call
+  alarm->ExpiresFromNow(std::chrono::milliseconds(100));
+  alarm->AsyncWait(handler);
+  alarm->ExpiresFromNow(std::chrono::milliseconds(50));
+  EXPECT_EQ(1U, results.size());
+  alarm->AsyncWait(handler);
+  clock.RunUntil(std::chrono::seconds(1));
+  ASSERT_EQ(3U, results.size());
+  EXPECT_EQ(boost::asio::error::operation_aborted, results[1]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(100)), run_at[1]);
+  EXPECT_FALSE(results[2]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::milliseconds(150)), run_at[2]);
+
+  // Cancelling and destroying both abort
+  alarm->ExpiresFromNow(std::chrono::milliseconds(100));
+  alarm->AsyncWait(handler);
+  alarm->Cancel();
+  alarm->ExpiresFromNow(std::chrono::milliseconds(100));
+  alarm->AsyncWait(handler);
+  alarm.reset();
+  clock.RunUntil(std::chrono::seconds(2));
+  ASSERT_EQ(5U, results.size());
+  EXPECT_EQ(boost::asio::error::operation_aborted, results[3]);
+  EXPECT_EQ(boost::asio::error::operation_aborted, results[4]);
+  EXPECT_EQ(VirtualClock::Duration(std::chrono::seconds(1)), run_at[4]);
+}
+
+TEST(VirtualSchedulerTest, BEH_DropsEventsOnceDestroyed) {
+  VirtualClock clock;
+  int run_count(0);
+  {
+    VirtualScheduler scheduler(clock);
+    scheduler.Post([&] { ++run_count; });
+    scheduler.Schedule(std::chrono::seconds(1), [&] { ++run_count; });
+    clock.RunUntil(clock.Now());
+    EXPECT_EQ(1, run_count);
+  }
+  // The event is still on the clock, but doesn't run
+  EXPECT_EQ(1U, clock.pending_count());
+  clock.RunUntil(std::chrono::seconds(2));
+  EXPECT_EQ(1, run_count);
+}
+
+}  // namespace test
+
+}  // namespace routing
+
+}  // namespace maidsafe
@@ -19,6 +19,7 @@
 #include "maidsafe/routing/tools/commands.h"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>  // NOLINT
 
 #include "boost/format.hpp"
@@ -50,7 +51,18 @@ Commands::Commands(DemoNodePtr demo_node, std::vector<maidsafe::passport::Pmid>
       finish_(false),
       wait_mutex_(),
       wait_cond_var_(),
-      mark_results_arrived_() {
+      mark_results_arrived_(),
+      kStartTime_(std::chrono::steady_clock::now()),
+      statistics_mutex_(),
+      statistics_cond_var_(),
+      stream_interval_(0),
+      snapshot_interval_(0),
+      next_stream_(),
+      next_snapshot_(),
+      snapshot_path_(),
+      snapshot_count_(0),
+      stop_reporting_(false),
+      statistics_thread_() {
   // CalculateClosests will only use all_ids_ to calculate expected respondents
   // here it is assumed that the first half of fobs will be used as vault
   // and the latter half part will be used as client, which shall not respond msg
@@ -71,6 +83,16 @@ Commands::Commands(DemoNodePtr demo_node, std::vector<maidsafe::passport::Pmid>
   mark_results_arrived_ = std::bind(&Commands::MarkResultArrived, this);
 }
 
+Commands::~Commands() {
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    stop_reporting_ = true;
+  }
+  statistics_cond_var_.notify_one();
+  if (statistics_thread_.joinable())
+    statistics_thread_.join();
+}
+
 void Commands::Validate(const NodeId& node_id, GivePublicKeyFunctor give_public_key) {
   if (node_id == NodeId())
     return;
@@ -117,6 +139,91 @@ void Commands::PrintRoutingTable() {
     std::cout << "\t" << maidsafe::HexSubstr(routing_node.string()) << std::endl;
 }
 
+void Commands::PrintStatistics() {
+  WriteHumanReadableStatistics(demo_node_->routing()->GetStatistics(), std::cout);
+}
+
+void Commands::StreamStatistics(const std::chrono::seconds& interval) {
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    stream_interval_ = interval;
+    next_stream_ = std::chrono::steady_clock::now();
+    if (!statistics_thread_.joinable() && interval.count() != 0)
+      statistics_thread_ = std::thread([this] { ReportStatistics(); });
+  }
+  statistics_cond_var_.notify_one();
+}
+
+void Commands::SnapshotStatistics(const fs::path& path, const std::chrono::seconds& interval) {
+  if (interval.count() == 0) {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return WriteStatisticsSnapshot(path);
+  }
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    snapshot_path_ = path;
+    snapshot_interval_ = interval;
+    next_snapshot_ = std::chrono::steady_clock::now();
+    if (!statistics_thread_.joinable())
+      statistics_thread_ = std::thread([this] { ReportStatistics(); });
+  }
+  statistics_cond_var_.notify_one();
+}
+
+void Commands::StopStatisticsSnapshots() {
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  snapshot_path_.clear();
+  snapshot_interval_ = std::chrono::seconds(0);
+}
+
+void Commands::ReportStatistics() {
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  while (!stop_reporting_) {
+    auto now(std::chrono::steady_clock::now());
+    auto next_report(now + std::chrono::seconds(1));
+    if (stream_interval_.count() != 0) {
+      if (now >= next_stream_) {
+        std::cout << std::endl;
+        PrintStatistics();
+        next_stream_ = now + stream_interval_;
+      }
+      next_report = std::min(next_report, next_stream_);
+    }
+    if (!snapshot_path_.empty()) {
+      if (now >= next_snapshot_) {
+        WriteStatisticsSnapshot(snapshot_path_);
+        next_snapshot_ = now + snapshot_interval_;
+      }
+      next_report = std::min(next_report, next_snapshot_);
+    }
+    statistics_cond_var_.wait_until(lock, next_report);
+  }
+}
+
+void Commands::WriteStatisticsSnapshot(const fs::path& path) {
+  std::ofstream snapshot_file(path.string().c_str(), std::ios::out | std::ios::app);
+  if (!snapshot_file) {
+    std::cout << "Failed to open " << path << " for writing statistics." << std::endl;
+    return;
+  }
+  snapshot_file << "snapshot " << snapshot_count_++ << '\n' << "node_id "
+                << demo_node_->node_id().ToStringEncoded(NodeId::EncodingType::kHex) << '\n'
+                << "uptime_ms "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - kStartTime_).count() << '\n';
+  WriteMachineReadableStatistics(demo_node_->routing()->GetStatistics(), snapshot_file);
+  snapshot_file << '\n';
+}
+
+void Commands::WriteProbeStacks(const fs::path& path, ProbeTime probe_time) {
+  std::ofstream probes_file(path.string().c_str(), std::ios::out | std::ios::trunc);
+  if (!probes_file) {
+    std::cout << "Failed to open " << path << " for writing probe stacks." << std::endl;
+    return;
+  }
+  probes_file << FoldedProbeStacks(probe_time);
+}
+
 void Commands::GetPeer(const std::string& peer) {
   size_t delim = peer.rfind(':');
   try {
@@ -314,6 +421,12 @@ void Commands::PrintUsage() {
   std::cout << "\tzerostatejoin ZeroStateJoin.\n";
   std::cout << "\tjoin Normal Join.\n";
   std::cout << "\tprt Print Local Routing Table.\n";
+  std::cout << "\tstats Print this node's counters, latencies, queue depths and peer links.\n";
+  std::cout << "\tstatsstream <interval_s> Print stats every interval_s seconds. 0 to stop.\n";
+  std::cout << "\tstatssnapshot <file> [interval_s] Append a machine-readable stats snapshot to"
+            << " file, every interval_s seconds if given. \"statssnapshot off\" to stop.\n";
+  std::cout << "\tprobes <file> [inclusive] Write probe times as folded stacks for flame graphs"
+            << " (needs ROUTING_SCOPED_PROBES). \"probes reset\" to zero them.\n";
   std::cout << "\trrt <dest_index> Request Routing Table from peer node with the specified"
             << " identity-index.\n";
   std::cout << "\tsenddirect <dest_index> <num_msg> Send a msg to a node with specified"
@@ -356,6 +469,31 @@ void Commands::ProcessCommand(const std::string& cmdline) {
     PrintUsage();
   } else if (cmd == "prt") {
     PrintRoutingTable();
+  } else if (cmd == "stats") {
+    PrintStatistics();
+  } else if (cmd == "statsstream") {
+    if (args.size() == 1 && atoi(args[0].c_str()) >= 0)
+      StreamStatistics(std::chrono::seconds(atoi(args[0].c_str())));
+    else
+      std::cout << "Error : Try correct option" << std::endl;
+  } else if (cmd == "statssnapshot") {
+    if (args.size() == 1 && args[0] == "off")
+      StopStatisticsSnapshots();
+    else if (args.size() == 1)
+      SnapshotStatistics(args[0], std::chrono::seconds(0));
+    else if (args.size() == 2 && atoi(args[1].c_str()) >= 0)
+      SnapshotStatistics(args[0], std::chrono::seconds(atoi(args[1].c_str())));
+    else
+      std::cout << "Error : Try correct option" << std::endl;
+  } else if (cmd == "probes") {
+    if (args.size() == 1 && args[0] == "reset")
+      ResetProbes();
+    else if (args.size() == 1)
+      WriteProbeStacks(args[0], ProbeTime::kExclusive);
+    else if (args.size() == 2 && args[1] == "inclusive")
+      WriteProbeStacks(args[0], ProbeTime::kInclusive);
+    else
+      std::cout << "Error : Try correct option" << std::endl;
   } else if (cmd == "rrt") {
     if (args.size() == 1) {
       SendMessages(atoi(args[0].c_str()), DestinationType::kDirect, true, 1);
@@ -453,6 +591,140 @@ NodeId Commands::CalculateClosests(const NodeId& target_id, std::vector<NodeId>&
   return closests[closests.size() - 1];
 }
 
+namespace {
+
+uint64_t SampleCount(const LatencyBuckets& buckets) {
+  uint64_t count(0);
+  for (const auto& bucket : buckets)
+    count += bucket.second;
+  return count;
+}
+
+void WriteCounts(const std::string& prefix, const std::map<std::string, uint64_t>& counts,
+                 std::ostream& stream) {
+  for (const auto& count : counts)
+    stream << prefix << count.first << ' ' << count.second << '\n';
+}
+
+void WritePercentiles(const std::string& prefix, const LatencyBuckets& buckets,
+                      std::ostream& stream) {
+  stream << prefix << "count " << SampleCount(buckets) << '\n';
+  for (int percentile : {50, 90, 99, 100}) {
+    stream << prefix << 'p' << percentile << "_us "
+           << LatencyPercentile(buckets, percentile).count() << '\n';
+  }
+}
+
+}  // unnamed namespace
+
+void WriteHumanReadableStatistics(const Statistics& statistics, std::ostream& stream) {
+  stream << "STATISTICS::::" << '\n';
+  stream << "\tBytes received: " << statistics.bytes_received
+         << "  sent: " << statistics.bytes_sent << '\n';
+  stream << "\tMessages by type:";
+  for (const auto& count : statistics.messages_by_type) {
+    if (count.second != 0)
+      stream << "  " << count.first << ": " << count.second;
+  }
+  stream << "\n\tMessages by handling:";
+  for (const auto& count : statistics.messages_by_handling) {
+    if (count.second != 0)
+      stream << "  " << count.first << ": " << count.second;
+  }
+  stream << "\n\tResponse latency (" << SampleCount(statistics.response_latency)
+         << " responses):  p50 " << LatencyPercentile(statistics.response_latency, 50).count()
+         << "us  p90 " << LatencyPercentile(statistics.response_latency, 90).count()
+         << "us  p99 " << LatencyPercentile(statistics.response_latency, 99).count()
+         << "us  timed out requests: " << statistics.timed_out_requests << '\n';
+  stream << "\tQueues:  received messages " << statistics.receive_queue_depth
+         << "  pending requests " << statistics.pending_requests << '\n';
+  stream << "\tJoin phases:";
+  for (const auto& phase : statistics.join_phases)
+    stream << "  " << phase.first << " " << phase.second.count() << "ms";
+  stream << "\n\tConnect handshake (" << SampleCount(statistics.connect_handshake)
+         << " peers):  p50 " << LatencyPercentile(statistics.connect_handshake, 50).count()
+         << "us  p99 " << LatencyPercentile(statistics.connect_handshake, 99).count() << "us\n";
+  stream << "\tHops (ideal " << statistics.ideal_hops << "):";
+  for (const auto& hops : statistics.hops_by_destination) {
+    if (hops.second.empty())
+      continue;
+    stream << "  " << hops.first << " mean " << MeanHops(hops.second);
+    auto stretch(statistics.route_stretch.find(hops.first));
+    if (stretch != std::end(statistics.route_stretch))
+      stream << " (stretch " << stretch->second << ")";
+  }
+  stream << '\n';
+  for (const auto& lock : statistics.locks) {
+    stream << "\tLock " << lock.first << ":  acquisitions " << lock.second.acquisitions
+           << "  wait p99 " << LatencyPercentile(lock.second.wait_time, 99).count()
+           << "us  hold p99 " << LatencyPercentile(lock.second.hold_time, 99).count() << "us";
+    if (!lock.second.longest_holds.empty()) {
+      stream << "  longest hold " << lock.second.longest_holds.front().first.count() << "us at "
+             << lock.second.longest_holds.front().second;
+    }
+    stream << '\n';
+  }
+  stream << "\tMemory (current/peak bytes):";
+  for (const auto& memory : statistics.memory) {
+    stream << "  " << memory.first << " " << memory.second.current_bytes << "/"
+           << memory.second.peak_bytes;
+  }
+  stream << '\n';
+  stream << "\tPeer links (" << statistics.links.size() << "):\n";
+  for (const auto& link : statistics.links) {
+    stream << "\t\t" << link.first.substr(0, 8) << "  sent " << link.second.send_successes
+           << " failed " << link.second.send_failures << "  bytes " << link.second.bytes_sent
+           << "  rtt " << link.second.round_trip_time.count() << "us  failure rate "
+           << link.second.failure_rate << "  last success ";
+    if (link.second.since_last_success.count() < 0)
+      stream << "never";
+    else
+      stream << link.second.since_last_success.count() << "ms ago";
+    stream << '\n';
+  }
+  stream << std::flush;
+}
+
+void WriteMachineReadableStatistics(const Statistics& statistics, std::ostream& stream) {
+  stream << "bytes_received " << statistics.bytes_received << '\n';
+  stream << "bytes_sent " << statistics.bytes_sent << '\n';
+  WriteCounts("messages_by_type.", statistics.messages_by_type, stream);
+  WriteCounts("messages_by_handling.", statistics.messages_by_handling, stream);
+  WritePercentiles("response_latency.", statistics.response_latency, stream);
+  stream << "timed_out_requests " << statistics.timed_out_requests << '\n';
+  stream << "receive_queue_depth " << statistics.receive_queue_depth << '\n';
+  stream << "pending_requests " << statistics.pending_requests << '\n';
+  for (const auto& phase : statistics.join_phases)
+    stream << "join_phase." << phase.first << "_ms " << phase.second.count() << '\n';
+  WritePercentiles("connect_handshake.", statistics.connect_handshake, stream);
+  stream << "ideal_hops " << statistics.ideal_hops << '\n';
+  for (const auto& hops : statistics.hops_by_destination) {
+    stream << "hops." << hops.first << ".mean " << MeanHops(hops.second) << '\n';
+    for (size_t hop_count(0); hop_count != hops.second.size(); ++hop_count)
+      stream << "hops." << hops.first << '.' << hop_count << ' ' << hops.second[hop_count] << '\n';
+  }
+  for (const auto& stretch : statistics.route_stretch)
+    stream << "route_stretch." << stretch.first << ' ' << stretch.second << '\n';
+  for (const auto& lock : statistics.locks) {
+    stream << "lock." << lock.first << ".acquisitions " << lock.second.acquisitions << '\n';
+    WritePercentiles("lock." + lock.first + ".wait.", lock.second.wait_time, stream);
+    WritePercentiles("lock." + lock.first + ".hold.", lock.second.hold_time, stream);
+  }
+  for (const auto& memory : statistics.memory) {
+    stream << "memory." << memory.first << ".current_bytes " << memory.second.current_bytes << '\n'
+           << "memory." << memory.first << ".peak_bytes " << memory.second.peak_bytes << '\n';
+  }
+  for (const auto& link : statistics.links) {
+    const std::string kPrefix("link." + link.first + '.');
+    stream << kPrefix << "send_successes " << link.second.send_successes << '\n'
+           << kPrefix << "send_failures " << link.second.send_failures << '\n'
+           << kPrefix << "bytes_sent " << link.second.bytes_sent << '\n'
+           << kPrefix << "round_trip_time_us " << link.second.round_trip_time.count() << '\n'
+           << kPrefix << "since_last_success_ms " << link.second.since_last_success.count()
+           << '\n' << kPrefix << "failure_rate " << link.second.failure_rate << '\n';
+  }
+}
+
 }  //  namespace test
 
 }  //  namespace routing
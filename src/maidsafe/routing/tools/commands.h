@@ -20,16 +20,22 @@
 #define MAIDSAFE_ROUTING_TOOLS_COMMANDS_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <mutex>
 
 #include "boost/date_time/posix_time/posix_time_types.hpp"
+#include "boost/filesystem/path.hpp"
 
 #include "maidsafe/passport/types.h"
 #include "maidsafe/routing/tests/routing_network.h"
+#include "maidsafe/routing/probes.h"
+#include "maidsafe/routing/statistics.h"
 #include "maidsafe/routing/tests/test_utils.h"
 #include "maidsafe/routing/utils.h"
 
@@ -47,8 +53,13 @@ class Commands {
  public:
   explicit Commands(DemoNodePtr demo_node, std::vector<maidsafe::passport::Pmid> all_pmids,
                     int identity_index);
+  ~Commands();
   void Run();
   void GetPeer(const std::string& peer);
+  // Appends a machine-readable snapshot of this node's statistics to 'path' every 'interval'.  A
+  // zero interval writes a single snapshot.
+  void SnapshotStatistics(const boost::filesystem::path& path,
+                          const std::chrono::seconds& interval);
 
  private:
   typedef std::vector<std::string> Arguments;
@@ -59,6 +70,13 @@ class Commands {
   bool ResultArrived() { return result_arrived_; }
 
   void PrintRoutingTable();
+  void PrintStatistics();
+  // Prints this node's statistics every 'interval'.  A zero interval stops streaming.
+  void StreamStatistics(const std::chrono::seconds& interval);
+  void StopStatisticsSnapshots();
+  void ReportStatistics();
+  void WriteStatisticsSnapshot(const boost::filesystem::path& path);
+  void WriteProbeStacks(const boost::filesystem::path& path, ProbeTime probe_time);
   void ZeroStateJoin();
   void Join();
   void Validate(const NodeId& node_id, GivePublicKeyFunctor give_public_key);
@@ -88,8 +106,21 @@ class Commands {
   std::mutex wait_mutex_;
   std::condition_variable wait_cond_var_;
   std::function<void()> mark_results_arrived_;
+  const std::chrono::steady_clock::time_point kStartTime_;
+  std::mutex statistics_mutex_;
+  std::condition_variable statistics_cond_var_;
+  std::chrono::seconds stream_interval_, snapshot_interval_;
+  std::chrono::steady_clock::time_point next_stream_, next_snapshot_;
+  boost::filesystem::path snapshot_path_;
+  uint64_t snapshot_count_;
+  bool stop_reporting_;
+  std::thread statistics_thread_;
 };
 
+void WriteHumanReadableStatistics(const Statistics& statistics, std::ostream& stream);
+// One "key value" line per statistic, in a fixed order so that snapshots can be diffed.
+void WriteMachineReadableStatistics(const Statistics& statistics, std::ostream& stream);
+
 }  //  namespace test
 
 }  //  namespace routing
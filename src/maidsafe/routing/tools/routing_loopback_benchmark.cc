@@ -0,0 +1,350 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Brings up vaults and clients on loopback (see GenericNetwork), drives SendDirect, SendGroup or
+// typed Send traffic between random nodes, and reports delivered messages per second, latency
+// percentiles and CPU time per message.  All nodes share this process, so the CPU time covers the
+// whole stack: sender, every hop, receivers and their replies.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>  // NOLINT
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/chrono/process_cpu_clocks.hpp"
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/config.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/routing/message.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/routing_network.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+typedef maidsafe::routing::test::GenericNetwork::NodePtr NodePtr;
+
+const std::string kBenchmarkVersion =
+    "MaidSafe Routing Loopback Benchmark " + maidsafe::kApplicationVersion();
+
+enum class SendMode { kDirect, kGroup, kTypedDirect, kTypedGroup };
+
+bool ParseMode(const std::string& name, SendMode& mode) {
+  if (name == "direct")
+    mode = SendMode::kDirect;
+  else if (name == "group")
+    mode = SendMode::kGroup;
+  else if (name == "typed_direct")
+    mode = SendMode::kTypedDirect;
+  else if (name == "typed_group")
+    mode = SendMode::kTypedGroup;
+  else
+    return false;
+  return true;
+}
+
+bool IsTyped(SendMode mode) {
+  return mode == SendMode::kTypedDirect || mode == SendMode::kTypedGroup;
+}
+
+bool IsGroup(SendMode mode) { return mode == SendMode::kGroup || mode == SendMode::kTypedGroup; }
+
+// Records when each test message was sent, and how long it took each copy to be delivered and each
+// response to return.  Payloads start with the message's index so that deliveries can be matched.
+class TrafficMonitor {
+ public:
+  TrafficMonitor(size_t message_count, uint64_t expected_deliveries, uint64_t expected_responses)
+      : kExpectedDeliveries_(expected_deliveries),
+        kExpectedResponses_(expected_responses),
+        send_times_(message_count),
+        delivery_latency_(),
+        response_latency_(),
+        deliveries_(0),
+        responses_(0),
+        failed_responses_(0),
+        mutex_(),
+        cond_var_(),
+        last_arrival_() {}
+
+  std::string Payload(size_t index, size_t size) const {
+    std::string payload(std::to_string(index) + ':');
+    payload.resize(std::max(size, payload.size()), 'x');
+    return payload;
+  }
+
+  void MessageSending(size_t index) { send_times_[index] = std::chrono::steady_clock::now(); }
+
+  void MessageDelivered(const std::string& payload) {
+    size_t index(0);
+    if (!ParseIndex(payload, index))
+      return;
+    delivery_latency_.Record(std::chrono::steady_clock::now() - send_times_[index]);
+    ++deliveries_;
+    Arrived();
+  }
+
+  void ResponseReceived(size_t index, const std::string& response) {
+    if (response.empty())
+      ++failed_responses_;
+    else
+      response_latency_.Record(std::chrono::steady_clock::now() - send_times_[index]);
+    ++responses_;
+    Arrived();
+  }
+
+  // Returns false if not everything had arrived before 'deadline'.
+  bool WaitForAll(const std::chrono::steady_clock::time_point& deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_var_.wait_until(lock, deadline, [this] { return AllArrived(); });
+  }
+
+  std::chrono::steady_clock::time_point last_arrival() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_arrival_;
+  }
+  uint64_t deliveries() const { return deliveries_; }
+  uint64_t responses() const { return responses_; }
+  uint64_t failed_responses() const { return failed_responses_; }
+  maidsafe::routing::LatencyBuckets DeliveryLatency() const { return delivery_latency_.Buckets(); }
+  maidsafe::routing::LatencyBuckets ResponseLatency() const { return response_latency_.Buckets(); }
+
+ private:
+  TrafficMonitor(const TrafficMonitor&);
+  TrafficMonitor(const TrafficMonitor&&);
+  TrafficMonitor& operator=(const TrafficMonitor&);
+
+  bool ParseIndex(const std::string& payload, size_t& index) const {
+    auto separator(payload.find(':'));
+    if (separator == 0 || separator == std::string::npos)
+      return false;
+    try {
+      index = static_cast<size_t>(std::stoull(payload.substr(0, separator)));
+    }
+    catch (const std::exception&) {
+      return false;
+    }
+    return index < send_times_.size();
+  }
+
+  bool AllArrived() const {
+    return deliveries_ >= kExpectedDeliveries_ && responses_ >= kExpectedResponses_;
+  }
+
+  void Arrived() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_arrival_ = std::chrono::steady_clock::now();
+    if (AllArrived())
+      cond_var_.notify_all();
+  }
+
+  const uint64_t kExpectedDeliveries_, kExpectedResponses_;
+  std::vector<std::chrono::steady_clock::time_point> send_times_;
+  maidsafe::routing::LatencyHistogram delivery_latency_, response_latency_;
+  std::atomic<uint64_t> deliveries_, responses_, failed_responses_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_var_;
+  std::chrono::steady_clock::time_point last_arrival_;
+};
+
+NodePtr RandomVaultOtherThan(const maidsafe::routing::test::GenericNetwork& network,
+                             const NodePtr& node) {
+  for (;;) {
+    NodePtr vault(network.RandomVaultNode());
+    if (vault != node)
+      return vault;
+  }
+}
+
+void Send(SendMode mode, const NodePtr& sender,
+          const maidsafe::routing::test::GenericNetwork& network, const std::string& payload,
+          size_t index, TrafficMonitor& monitor) {
+  using maidsafe::routing::GroupId;
+  using maidsafe::routing::SingleId;
+  using maidsafe::routing::SingleSource;
+  maidsafe::routing::ResponseFunctor response_functor([&monitor, index](std::string response) {
+    monitor.ResponseReceived(index, response);
+  });
+  switch (mode) {
+    case SendMode::kDirect:
+      sender->SendDirect(RandomVaultOtherThan(network, sender)->node_id(), payload, false,
+                         response_functor);
+      break;
+    case SendMode::kGroup:
+      sender->SendGroup(maidsafe::NodeId(maidsafe::NodeId::IdType::kRandomId), payload, false,
+                        response_functor);
+      break;
+    case SendMode::kTypedDirect: {
+      maidsafe::routing::SingleToSingleMessage message;
+      message.contents = payload;
+      message.sender = SingleSource(sender->node_id());
+      message.receiver = SingleId(RandomVaultOtherThan(network, sender)->node_id());
+      sender->routing()->Send(message);
+      break;
+    }
+    case SendMode::kTypedGroup: {
+      maidsafe::routing::SingleToGroupMessage message;
+      message.contents = payload;
+      message.sender = SingleSource(sender->node_id());
+      message.receiver = GroupId(maidsafe::NodeId(maidsafe::NodeId::IdType::kRandomId));
+      sender->routing()->Send(message);
+      break;
+    }
+  }
+}
+
+// Prints how many of 'out_of' things arrived, and percentiles of how long they took.
+void PrintTimes(const std::string& name, const maidsafe::routing::LatencyBuckets& buckets,
+                uint64_t arrived, uint64_t out_of) {
+  std::cout << name << ": " << arrived << " of " << out_of;
+  if (!buckets.empty()) {
+    std::cout << ", p50 " << maidsafe::routing::LatencyPercentile(buckets, 50).count() / 1000.0
+              << "ms  p90 " << maidsafe::routing::LatencyPercentile(buckets, 90).count() / 1000.0
+              << "ms  p99 " << maidsafe::routing::LatencyPercentile(buckets, 99).count() / 1000.0
+              << "ms";
+  }
+  std::cout << '\n';
+}
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+
+  std::cout << kBenchmarkVersion << std::endl;
+  int result(0);
+  try {
+    size_t vaults(maidsafe::routing::test::kServerSize);
+    size_t clients(maidsafe::routing::test::kClientSize);
+    std::string mode_name("direct");
+    size_t message_count(1000), message_size(1024);
+    double rate(100.0);
+    int64_t drain_time(std::chrono::duration_cast<std::chrono::seconds>(
+                           maidsafe::routing::Parameters::default_response_timeout).count());
+
+    po::options_description options_description("Options");
+    options_description.add_options()("help,h", "Print this help message")(
+        "vaults,v", po::value<size_t>(&vaults)->default_value(vaults), "Number of vaults")(
+        "clients,c", po::value<size_t>(&clients)->default_value(clients), "Number of clients")(
+        "mode", po::value<std::string>(&mode_name)->default_value(mode_name),
+        "How messages are sent: direct, group, typed_direct or typed_group")(
+        "messages,m", po::value<size_t>(&message_count)->default_value(message_count),
+        "Number of messages sent, each from a random node")(
+        "message_size", po::value<size_t>(&message_size)->default_value(message_size),
+        "Payload size of each message in bytes")(
+        "rate,r", po::value<double>(&rate)->default_value(rate),
+        "Messages sent per second across the network, or 0 to send as fast as possible")(
+        "drain_time", po::value<int64_t>(&drain_time)->default_value(drain_time),
+        "Seconds allowed after the last send for deliveries and responses to arrive");
+
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(options_description)
+                  .allow_unregistered()
+                  .run(),
+              variables_map);
+    po::notify(variables_map);
+
+    if (variables_map.count("help")) {
+      std::cout << options_description << std::endl;
+      return 0;
+    }
+    SendMode mode(SendMode::kDirect);
+    if (!ParseMode(mode_name, mode) || vaults < 3 || message_count == 0 || message_size == 0 ||
+        message_size > maidsafe::routing::Parameters::max_data_size || rate < 0.0 ||
+        drain_time < 0) {
+      std::cout << "Invalid options." << std::endl << options_description << std::endl;
+      return -1;
+    }
+
+    maidsafe::routing::test::GenericNode::typed_message_api_ = IsTyped(mode);
+    maidsafe::routing::test::GenericNetwork network;
+    network.SetUp();
+    network.SetUpNetwork(vaults, clients);
+    bool stable(vaults <= maidsafe::routing::Parameters::max_routing_table_size
+                    ? network.WaitForHealthToStabilise()
+                    : network.WaitForHealthToStabiliseInLargeNetwork());
+    if (!stable)
+      std::cout << "Warning: network health did not stabilise before sending" << std::endl;
+
+    uint64_t copies(IsGroup(mode) ? maidsafe::routing::Parameters::group_size : 1);
+    TrafficMonitor monitor(message_count, message_count * copies,
+                           IsTyped(mode) ? 0 : message_count * copies);
+    for (const auto& node : network.nodes_) {
+      node->SetMessageReceivedObserver(
+          [&monitor](const std::string& message) { monitor.MessageDelivered(message); });
+    }
+
+    auto interval(rate > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(1.0 / rate))
+                             : std::chrono::steady_clock::duration::zero());
+    auto start(std::chrono::steady_clock::now());
+    // std::clock measures wall time on Windows, so use the process's user plus system time.
+    auto cpu_start(boost::chrono::process_cpu_clock::now());
+    for (size_t index(0); index != message_count; ++index) {
+      std::this_thread::sleep_until(start + interval * static_cast<int64_t>(index));
+      NodePtr sender(network.nodes_.at(maidsafe::RandomUint32() % network.nodes_.size()));
+      std::string payload(monitor.Payload(index, message_size));
+      monitor.MessageSending(index);
+      Send(mode, sender, network, payload, index, monitor);
+    }
+    auto sent(std::chrono::steady_clock::now());
+    if (!monitor.WaitForAll(sent + std::chrono::seconds(drain_time)))
+      std::cout << "Warning: not everything arrived within the drain time" << std::endl;
+    auto cpu_time((boost::chrono::process_cpu_clock::now() - cpu_start).count());
+    for (const auto& node : network.nodes_)
+      node->SetMessageReceivedObserver(nullptr);
+
+    auto elapsed(std::max(monitor.last_arrival(), sent) - start);
+    double seconds(std::chrono::duration<double>(elapsed).count());
+    double cpu_seconds(static_cast<double>(cpu_time.user + cpu_time.system) / 1e9);
+    std::cout << vaults << " vaults, " << clients << " clients, " << mode_name << ", "
+              << message_count << " messages of " << message_size << " bytes in " << seconds
+              << "s\n";
+    PrintTimes("Delivered", monitor.DeliveryLatency(), monitor.deliveries(),
+               message_count * copies);
+    if (!IsTyped(mode)) {
+      PrintTimes("Responses", monitor.ResponseLatency(),
+                 monitor.responses() - monitor.failed_responses(), message_count * copies);
+    }
+    std::cout << "Delivered messages per second: " << monitor.deliveries() / seconds << '\n'
+              << "CPU per delivered message: "
+              << (monitor.deliveries() == 0 ? 0.0 : cpu_seconds * 1e6 / monitor.deliveries())
+              << "us (" << cpu_seconds << "s total)" << std::endl;
+
+    network.ClearMessages();
+    network.TearDown();
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    result = -2;
+  }
+
+  return result;
+}
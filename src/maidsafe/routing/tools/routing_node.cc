@@ -17,6 +17,10 @@
     use of the MaidSafe Software.                                                                 */
 
 #include <signal.h>
+
+#include <algorithm>
+#include <chrono>
+
 #include "boost/filesystem.hpp"
 #include "boost/program_options.hpp"
 
@@ -91,7 +95,11 @@ int main(int argc, char** argv) {
         "Entry from keys file to use as ID (starts from 0)")(
         "pmids_path", po::value<std::string>()->default_value(fs::path(
                           fs::temp_directory_path(error_code) / "pmids_list.dat").string()),
-        "Path to pmid file");
+        "Path to pmid file")(
+        "stats_file", po::value<std::string>(),
+        "Append machine-readable statistics snapshots to this file")(
+        "stats_interval", po::value<int>()->default_value(60),
+        "Seconds between statistics snapshots");
 
     po::variables_map variables_map;
     //     po::store(po::parse_command_line(argc, argv, options_description),
@@ -165,6 +173,11 @@ int main(int argc, char** argv) {
     if (!peer.empty()) {
       commands.GetPeer(peer);
     }
+    if (variables_map.count("stats_file")) {
+      commands.SnapshotStatistics(variables_map.at("stats_file").as<std::string>(),
+                                  std::chrono::seconds(std::max(
+                                      variables_map.at("stats_interval").as<int>(), 1)));
+    }
     commands.Run();
 
     std::cout << "Node stopped successfully." << std::endl;
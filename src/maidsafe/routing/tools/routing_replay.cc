@@ -0,0 +1,115 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Feeds a capture of the messages a node received (see message_capture.h) back through a
+// MessageHandler whose transport discards everything sent, either at the original pacing or as
+// fast as possible, and reports how long handling took.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/config.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/node_id.h"
+
+#include "maidsafe/routing/message_capture.h"
+#include "maidsafe/routing/tests/message_replayer.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+const std::string kReplayVersion = "MaidSafe Routing Replay " + maidsafe::kApplicationVersion();
+
+void PrintResults(const maidsafe::routing::test::ReplayResults& results) {
+  double seconds(std::chrono::duration<double>(results.elapsed).count());
+  std::cout << results.messages << " messages in " << seconds * 1000.0 << "ms";
+  if (seconds > 0.0)
+    std::cout << " (" << results.messages / seconds << " per second)";
+  std::cout << ", " << results.parse_failures << " failed to parse, " << results.sends
+            << " sent on\n";
+}
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+
+  std::cout << kReplayVersion << std::endl;
+  int result(0);
+  try {
+    std::string capture_path;
+    bool as_fast_as_possible(false);
+    size_t repeats(1);
+
+    po::options_description options_description("Options");
+    options_description.add_options()("help,h", "Print this help message")(
+        "capture,c", po::value<std::string>(&capture_path),
+        "Capture file written by a node with Parameters::message_capture_directory set")(
+        "fast,f", po::bool_switch(&as_fast_as_possible),
+        "Replay as fast as possible rather than at the original pacing")(
+        "repeats,r", po::value<size_t>(&repeats)->default_value(repeats),
+        "Number of times to replay the capture");
+
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(options_description)
+                  .allow_unregistered()
+                  .run(),
+              variables_map);
+    po::notify(variables_map);
+
+    if (variables_map.count("help")) {
+      std::cout << options_description << std::endl;
+      return 0;
+    }
+    if (capture_path.empty() || repeats == 0) {
+      std::cout << "Invalid options." << std::endl << options_description << std::endl;
+      return -1;
+    }
+
+    maidsafe::NodeId node_id;
+    auto messages(maidsafe::routing::ReadMessageCapture(capture_path, node_id));
+    std::cout << "Read " << messages.size() << " messages captured by "
+              << maidsafe::DebugId(node_id);
+    if (!messages.empty()) {
+      std::cout << " over "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       messages.back().time - messages.front().time).count() << "ms";
+    }
+    std::cout << std::endl;
+
+    maidsafe::routing::test::MessageReplayer replayer(node_id, messages);
+    std::cout << "Routing table holds " << replayer.routing_table_size()
+              << " of the nodes the messages came from" << std::endl;
+    for (size_t repeat(0); repeat != repeats; ++repeat)
+      PrintResults(replayer.Replay(messages, !as_fast_as_possible));
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    result = -2;
+  }
+
+  return result;
+}
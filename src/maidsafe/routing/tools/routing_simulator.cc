@@ -0,0 +1,193 @@
+/*  Copyright 2012 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// Runs a whole network of real routing nodes on a simulated transport and in virtual time (see
+// SimulatedNetwork), and reports how quickly nodes joined, how test messages were routed and what
+// the routing RPCs cost on the wire.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>  // NOLINT
+#include <map>
+#include <string>
+
+#include "boost/program_options.hpp"
+
+#include "maidsafe/common/config.h"
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/routing/statistics.h"
+#include "maidsafe/routing/tests/simulated_network.h"
+
+namespace po = boost::program_options;
+
+namespace {
+
+const std::string kSimulatorVersion =
+    "MaidSafe Routing Simulator " + maidsafe::kApplicationVersion();
+
+uint64_t Total(const maidsafe::routing::LatencyBuckets& buckets) {
+  uint64_t total(0);
+  for (const auto& bucket : buckets)
+    total += bucket.second;
+  return total;
+}
+
+// Prints how many of 'out_of' things got there, and percentiles of how long they took.
+void PrintTimes(const std::string& name, const maidsafe::routing::LatencyBuckets& buckets,
+                uint64_t out_of, const std::string& things) {
+  std::cout << name << ": " << Total(buckets) << " of " << out_of << ' ' << things;
+  if (!buckets.empty()) {
+    std::cout << ", p50 " << maidsafe::routing::LatencyPercentile(buckets, 50).count() / 1000
+              << "ms  p90 " << maidsafe::routing::LatencyPercentile(buckets, 90).count() / 1000
+              << "ms  p99 " << maidsafe::routing::LatencyPercentile(buckets, 99).count() / 1000
+              << "ms";
+  }
+  std::cout << '\n';
+}
+
+void PrintTraffic(const std::string& name,
+                  const std::map<std::string, maidsafe::routing::test::SimulatedTraffic>& traffic) {
+  std::cout << name << ":\n";
+  for (const auto& type_traffic : traffic) {
+    std::cout << "  " << type_traffic.first << ": " << type_traffic.second.messages
+              << " messages, " << type_traffic.second.bytes << " bytes\n";
+  }
+}
+
+void PrintResults(const maidsafe::routing::test::SimulationResults& results,
+                  const std::chrono::steady_clock::duration& wall_time) {
+  std::cout << "Simulated " << results.simulated_time.count() << "ms in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(wall_time).count()
+            << "ms (" << results.events << " events)\n"
+            << "Joins: " << results.joins << "  Leaves: " << results.leaves << '\n';
+  PrintTimes("Reached closest_nodes_size", results.closest_nodes_reached, results.joins, "nodes");
+  PrintTimes("Reached routing_table_size_threshold", results.threshold_reached, results.joins,
+             "nodes");
+
+  std::cout << "Test messages delivered: " << results.messages_delivered << " of "
+            << results.messages_sent << ", mean hops " << maidsafe::routing::MeanHops(results.hops)
+            << '\n';
+  for (size_t hops(0); hops != results.hops.size(); ++hops) {
+    if (results.hops[hops] != 0)
+      std::cout << "  " << hops << " hops: " << results.hops[hops] << '\n';
+  }
+
+  uint64_t churn_events(Total(results.reconvergence) + results.unconverged);
+  if (churn_events != 0) {
+    PrintTimes("Close groups reconverged", results.reconvergence, churn_events,
+               "joins and leaves");
+  }
+
+  PrintTraffic("Traffic (each hop counted)", results.traffic);
+  PrintTraffic("Traffic while measuring", results.measured_traffic);
+  std::cout << "Traffic digest: " << std::hex << results.traffic_digest << std::dec << '\n';
+}
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+
+  std::cout << kSimulatorVersion << std::endl;
+  int result(0);
+  try {
+    maidsafe::routing::test::SimulationParameters parameters;
+    int64_t join_interval(parameters.join_interval.count());
+    int64_t min_latency(parameters.min_latency.count());
+    int64_t max_latency(parameters.max_latency.count());
+    int64_t settle_time(parameters.settle_time.count());
+    int64_t measure_time(parameters.measure_time.count());
+    int64_t convergence_check_interval(parameters.convergence_check_interval.count());
+
+    po::options_description options_description("Options");
+    options_description.add_options()("help,h", "Print this help message")(
+        "seed", po::value<uint32_t>(&parameters.seed)->default_value(parameters.seed),
+        "Seed for every random choice; runs with equal options are repeatable byte for byte")(
+        "nodes,n", po::value<size_t>(&parameters.node_count)->default_value(parameters.node_count),
+        "Number of nodes joining the network")(
+        "join_interval", po::value<int64_t>(&join_interval)->default_value(join_interval),
+        "Milliseconds between successive nodes starting to join")(
+        "min_latency", po::value<int64_t>(&min_latency)->default_value(min_latency),
+        "Minimum per-message latency in milliseconds")(
+        "max_latency", po::value<int64_t>(&max_latency)->default_value(max_latency),
+        "Maximum per-message latency in milliseconds")(
+        "loss_rate", po::value<double>(&parameters.loss_rate)->default_value(parameters.loss_rate),
+        "Probability of each send attempt being lost, delaying the message by 2 * max_latency")(
+        "settle_time", po::value<int64_t>(&settle_time)->default_value(settle_time),
+        "Seconds allowed after the last node starts joining before measuring")(
+        "measure_time", po::value<int64_t>(&measure_time)->default_value(measure_time),
+        "Seconds of measurement")(
+        "messages,m",
+        po::value<size_t>(&parameters.message_count)->default_value(parameters.message_count),
+        "Number of test messages sent between random nodes while measuring")(
+        "message_size",
+        po::value<size_t>(&parameters.message_size)->default_value(parameters.message_size),
+        "Payload size of each test message in bytes")(
+        "join_rate", po::value<double>(&parameters.join_rate)->default_value(parameters.join_rate),
+        "New nodes joining per second while measuring")(
+        "leave_rate",
+        po::value<double>(&parameters.leave_rate)->default_value(parameters.leave_rate),
+        "Live nodes leaving per second while measuring")(
+        "convergence_check_interval",
+        po::value<int64_t>(&convergence_check_interval)
+            ->default_value(convergence_check_interval),
+        "Milliseconds between checks of close groups reconverging after joins and leaves")(
+        "bootstrap_contacts",
+        po::value<size_t>(&parameters.bootstrap_contact_count)
+            ->default_value(parameters.bootstrap_contact_count),
+        "Maximum number of live nodes' endpoints each joining node bootstraps from");
+
+    po::variables_map variables_map;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(options_description)
+                  .allow_unregistered()
+                  .run(),
+              variables_map);
+    po::notify(variables_map);
+
+    if (variables_map.count("help")) {
+      std::cout << options_description << std::endl;
+      return 0;
+    }
+    if (parameters.node_count < 2 || min_latency < 0 || min_latency > max_latency ||
+        parameters.loss_rate < 0.0 || parameters.loss_rate >= 1.0 || parameters.join_rate < 0.0 ||
+        parameters.leave_rate < 0.0 || convergence_check_interval <= 0 ||
+        parameters.bootstrap_contact_count == 0) {
+      std::cout << "Invalid options." << std::endl << options_description << std::endl;
+      return -1;
+    }
+    parameters.join_interval = std::chrono::milliseconds(join_interval);
+    parameters.min_latency = std::chrono::milliseconds(min_latency);
+    parameters.max_latency = std::chrono::milliseconds(max_latency);
+    parameters.settle_time = std::chrono::seconds(settle_time);
+    parameters.measure_time = std::chrono::seconds(measure_time);
+    parameters.convergence_check_interval = std::chrono::milliseconds(convergence_check_interval);
+
+    auto start(std::chrono::steady_clock::now());
+    maidsafe::routing::test::SimulatedNetwork network(parameters);
+    auto results(network.Run());
+    PrintResults(results, std::chrono::steady_clock::now() - start);
+  }
+  catch (const std::exception& exception) {
+    std::cout << "Error: " << exception.what() << std::endl;
+    result = -2;
+  }
+
+  return result;
+}
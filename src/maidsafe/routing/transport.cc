@@ -0,0 +1,75 @@
+/*  Copyright 2013 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/routing/transport.h"
+
+#include <utility>
+
+namespace maidsafe {
+
+namespace routing {
+
+namespace {
+
+typedef boost::asio::ip::udp::endpoint Endpoint;
+
+}  // unnamed namespace
+
+RudpTransport::RudpTransport() : rudp_() {}
+
+RudpTransport::~RudpTransport() {}
+
+int RudpTransport::Bootstrap(const std::vector<Endpoint>& bootstrap_endpoints,
+                             const rudp::MessageReceivedFunctor& message_received_functor,
+                             const rudp::ConnectionLostFunctor& connection_lost_functor,
+                             const NodeId& this_node_id,
+                             std::shared_ptr<asymm::PrivateKey> private_key,
+                             std::shared_ptr<asymm::PublicKey> public_key,
+                             NodeId& chosen_bootstrap_peer, rudp::NatType& nat_type,
+                             const Endpoint& local_endpoint) {
+  return rudp_.Bootstrap(bootstrap_endpoints, message_received_functor, connection_lost_functor,
+                         this_node_id, private_key, public_key, chosen_bootstrap_peer, nat_type,
+                         local_endpoint);
+}
+
+int RudpTransport::GetAvailableEndpoint(const NodeId& peer_id,
+                                        const rudp::EndpointPair& peer_endpoint_pair,
+                                        rudp::EndpointPair& this_endpoint_pair,
+                                        rudp::NatType& this_nat_type) {
+  return rudp_.GetAvailableEndpoint(peer_id, peer_endpoint_pair, this_endpoint_pair, this_nat_type);
+}
+
+int RudpTransport::Add(const NodeId& peer_id, const rudp::EndpointPair& peer_endpoint_pair,
+                       const std::string& validation_data) {
+  return rudp_.Add(peer_id, peer_endpoint_pair, validation_data);
+}
+
+int RudpTransport::MarkConnectionAsValid(const NodeId& peer_id, Endpoint& new_bootstrap_endpoint) {
+  return rudp_.MarkConnectionAsValid(peer_id, new_bootstrap_endpoint);
+}
+
+void RudpTransport::Remove(const NodeId& peer_id) { rudp_.Remove(peer_id); }
+
+void RudpTransport::Send(const NodeId& peer_id, std::string&& message,
+                         const rudp::MessageSentFunctor& message_sent_functor) {
+  rudp_.Send(peer_id, std::move(message), message_sent_functor);
+}
+
+}  // namespace routing
+
+}  // namespace maidsafe